@@ -0,0 +1,226 @@
+/** cached-cast.cpp
+ * Compares `maybe_cast_cached` with `maybe_cast` on a hierarchy with
+ * multiple and virtual inheritance.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "gch/optional_ref.hpp"
+#include "gch/optional_ref/cached_cast.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+  struct shape
+  {
+    virtual ~shape (void) = default;
+    int s = 1;
+  };
+
+  struct named : virtual shape
+  {
+    int n = 2;
+  };
+
+  struct colored : virtual shape
+  {
+    int c = 3;
+  };
+
+  // A diamond through a virtual base.
+  struct label : named, colored
+  {
+    int l = 4;
+  };
+
+  struct plain : shape
+  {
+    int p = 5;
+  };
+
+  struct mixin
+  {
+    virtual ~mixin (void) = default;
+    int m = 6;
+  };
+
+  // `colored` is not at the start of the object.
+  struct widget : mixin, colored
+  {
+    int w = 7;
+  };
+
+  struct downcast_site { };
+  struct crosscast_site { };
+
+  template <typename Function>
+  double
+  time_ns_per_cast (Function f, std::size_t casts, long& result)
+  {
+    auto start = std::chrono::steady_clock::now ();
+    result = f ();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now () - start;
+    return elapsed.count () / static_cast<double> (casts);
+  }
+
+  // Sums a field of every object for which the cast succeeds.
+  template <typename Cast>
+  long
+  sum_colors (const std::vector<shape *>& shapes, std::size_t rounds, Cast cast)
+  {
+    long sum = 0;
+    for (std::size_t round = 0; round < rounds; ++round)
+    {
+      for (shape *p : shapes)
+      {
+        gch::optional_ref<colored> r = cast (gch::optional_ref<shape> { p });
+        if (r)
+          sum += r->c;
+      }
+    }
+    return sum;
+  }
+
+  template <typename Cast>
+  long
+  sum_names (const std::vector<colored *>& colors, std::size_t rounds, Cast cast)
+  {
+    long sum = 0;
+    for (std::size_t round = 0; round < rounds; ++round)
+    {
+      for (colored *p : colors)
+      {
+        gch::optional_ref<named> r = cast (gch::optional_ref<colored> { p });
+        if (r)
+          sum += r->n;
+      }
+    }
+    return sum;
+  }
+
+  template <typename T, typename U, typename Cast>
+  bool
+  agrees (const std::vector<U *>& sources, Cast cast)
+  {
+    // The second pass hits the cache.
+    for (int pass = 0; pass < 2; ++pass)
+    {
+      for (U *p : sources)
+      {
+        if (cast (gch::optional_ref<U> { p }).get_pointer ()
+            != gch::maybe_cast<T> (gch::optional_ref<U> { p }).get_pointer ())
+          return false;
+      }
+    }
+    return true;
+  }
+
+}
+
+int
+main (void)
+{
+  constexpr std::size_t count  = 256;
+  constexpr std::size_t rounds = 20000;
+  constexpr std::size_t casts  = count * rounds;
+
+  std::vector<std::unique_ptr<shape>> owners;
+  std::vector<shape *> shapes;
+  std::vector<colored *> colors;
+
+  // Mix the dynamic types with a simple LCG so that the branch predictor
+  // can not learn the order.
+  std::uint32_t state = 12345;
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    state = state * 1664525U + 1013904223U;
+    switch ((state >> 16) % 3)
+    {
+      case 0:
+      {
+        label *p = new label;
+        owners.emplace_back (p);
+        colors.push_back (p);
+        break;
+      }
+      case 1:
+      {
+        widget *p = new widget;
+        owners.emplace_back (p);
+        colors.push_back (p);
+        break;
+      }
+      default:
+        owners.emplace_back (new plain);
+    }
+    shapes.push_back (owners.back ().get ());
+  }
+
+  auto plain_down = [] (gch::optional_ref<shape> r) noexcept {
+    return gch::maybe_cast<colored> (r);
+  };
+  auto cached_down = [] (gch::optional_ref<shape> r) noexcept {
+    return gch::maybe_cast_cached<colored, downcast_site> (r);
+  };
+  auto atomic_down = [] (gch::optional_ref<shape> r) noexcept {
+    return gch::maybe_cast_cached_atomic<colored, downcast_site> (r);
+  };
+
+  auto plain_cross = [] (gch::optional_ref<colored> r) noexcept {
+    return gch::maybe_cast<named> (r);
+  };
+  auto cached_cross = [] (gch::optional_ref<colored> r) noexcept {
+    return gch::maybe_cast_cached<named, crosscast_site> (r);
+  };
+  auto atomic_cross = [] (gch::optional_ref<colored> r) noexcept {
+    return gch::maybe_cast_cached_atomic<named, crosscast_site> (r);
+  };
+
+  if (! agrees<colored> (shapes, cached_down)
+      ||! agrees<colored> (shapes, atomic_down)
+      ||! agrees<named> (colors, cached_cross)
+      ||! agrees<named> (colors, atomic_cross))
+  {
+    std::fprintf (stderr, "The results of maybe_cast and maybe_cast_cached differ.\n");
+    return 1;
+  }
+
+  long results[6] = { };
+  double down_ns[3] = {
+    time_ns_per_cast ([&] { return sum_colors (shapes, rounds, plain_down); },  casts, results[0]),
+    time_ns_per_cast ([&] { return sum_colors (shapes, rounds, cached_down); }, casts, results[1]),
+    time_ns_per_cast ([&] { return sum_colors (shapes, rounds, atomic_down); }, casts, results[2]),
+  };
+  double cross_ns[3] = {
+    time_ns_per_cast ([&] { return sum_names (colors, rounds, plain_cross); },  casts, results[3]),
+    time_ns_per_cast ([&] { return sum_names (colors, rounds, cached_cross); }, casts, results[4]),
+    time_ns_per_cast ([&] { return sum_names (colors, rounds, atomic_cross); }, casts, results[5]),
+  };
+
+  if (results[0] != results[1] || results[0] != results[2]
+      || results[3] != results[4] || results[3] != results[5])
+  {
+    std::fprintf (stderr, "The sums differ.\n");
+    return 1;
+  }
+
+  std::printf ("downcast through a virtual base (shape -> colored)\n");
+  std::printf ("  maybe_cast:                %6.2f ns/cast  (result %ld)\n", down_ns[0], results[0]);
+  std::printf ("  maybe_cast_cached:         %6.2f ns/cast\n", down_ns[1]);
+  std::printf ("  maybe_cast_cached_atomic:  %6.2f ns/cast\n", down_ns[2]);
+  std::printf ("cross cast (colored -> named)\n");
+  std::printf ("  maybe_cast:                %6.2f ns/cast  (result %ld)\n", cross_ns[0], results[3]);
+  std::printf ("  maybe_cast_cached:         %6.2f ns/cast\n", cross_ns[1]);
+  std::printf ("  maybe_cast_cached_atomic:  %6.2f ns/cast\n", cross_ns[2]);
+  return 0;
+}
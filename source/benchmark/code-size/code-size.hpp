@@ -0,0 +1,60 @@
+/** code-size.hpp
+ * Common types for the code-size audit.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef OPTIONAL_REF_CODE_SIZE_HPP
+#define OPTIONAL_REF_CODE_SIZE_HPP
+
+#include "gch/optional_ref.hpp"
+
+#include <string>
+#include <vector>
+
+namespace code_size
+{
+
+  struct base
+  {
+    virtual ~base (void) = default;
+    int n = 0;
+  };
+
+  struct derived_a : base { int a = 1; };
+  struct derived_b : base { int b = 2; };
+
+  struct small
+  {
+    int x;
+
+    int
+    get (void) const noexcept
+    {
+      return x;
+    }
+  };
+
+  struct large
+  {
+    std::string s;
+    std::vector<int> v;
+  };
+
+}
+
+// Each instantiated value type and a name used to build unique function names.
+#define OPTIONAL_REF_CODE_SIZE_FOR_EACH_TYPE(X) \
+  X (int,                 int)                  \
+  X (double,              double)               \
+  X (std::string,         string)               \
+  X (code_size::small,    small)                \
+  X (code_size::large,    large)                \
+  X (code_size::base,     base)                 \
+  X (code_size::derived_a, derived_a)           \
+  X (code_size::derived_b, derived_b)
+
+#endif // OPTIONAL_REF_CODE_SIZE_HPP
@@ -0,0 +1,52 @@
+/** monadic.cpp
+ * Instantiates `maybe_invoke` and `maybe_cast` for the audit.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "code-size.hpp"
+
+int
+invoke_member (gch::optional_cref<code_size::small> r)
+{
+  return r >>= &code_size::small::get;
+}
+
+gch::optional_ref<int>
+invoke_member_object (gch::optional_ref<code_size::small> r)
+{
+  return r >>= &code_size::small::x;
+}
+
+std::size_t
+invoke_functor (gch::optional_cref<std::string> r)
+{
+  return gch::maybe_invoke (r, [](const std::string& s) { return s.size (); });
+}
+
+gch::optional_ref<int>
+invoke_ref (gch::optional_ref<code_size::large> r, std::size_t i)
+{
+  return gch::maybe_invoke (r, [](code_size::large& l, std::size_t n) -> int& { return l.v[n]; }, i);
+}
+
+gch::optional_ref<code_size::derived_a>
+cast_a (gch::optional_ref<code_size::base> r)
+{
+  return gch::maybe_cast<code_size::derived_a> (r);
+}
+
+gch::optional_ref<code_size::derived_b>
+cast_b (gch::optional_ref<code_size::base> r)
+{
+  return gch::maybe_cast<code_size::derived_b> (r);
+}
+
+gch::optional_ref<const code_size::derived_a>
+cast_const_a (gch::optional_cref<code_size::base> r)
+{
+  return gch::maybe_cast<code_size::derived_a> (r);
+}
@@ -0,0 +1,119 @@
+# Reports the bytes of text attributed to `gch::` symbols in the audited objects.
+#
+# Usage:
+#   cmake -DNM=<nm> -DOUTPUT=<file>
+#         -DEXCEPTIONS_OBJECTS=<objects> -DNO_EXCEPTIONS_OBJECTS=<objects>
+#         -P report.cmake
+#
+# Each row is one function whose signature mentions `gch::`, which includes
+# both out-of-line library functions and the audited callers into which the
+# library was inlined (weak symbols which appear in multiple objects are
+# counted once). The totals also include the text of the
+# non-library functions, into which most of the library is normally inlined.
+
+foreach (_VAR NM OUTPUT EXCEPTIONS_OBJECTS NO_EXCEPTIONS_OBJECTS)
+  if (NOT DEFINED ${_VAR})
+    message (FATAL_ERROR "${_VAR} must be defined.")
+  endif ()
+endforeach ()
+
+function (pad_left out value width fill)
+  string (LENGTH "${value}" _LENGTH)
+  if (_LENGTH LESS width)
+    math (EXPR _PADDING "${width} - ${_LENGTH}")
+    string (REPEAT "${fill}" ${_PADDING} _PREFIX)
+    set (value "${_PREFIX}${value}")
+  endif ()
+  set (${out} "${value}" PARENT_SCOPE)
+endfunction ()
+
+set (_KEYS)
+
+macro (read_text_symbols variant)
+  set (_TOTAL_${variant} 0)
+  set (_GCH_TOTAL_${variant} 0)
+  foreach (_OBJECT IN LISTS ${variant}_OBJECTS)
+    execute_process (
+      COMMAND
+        ${NM} --defined-only --print-size --radix=d -C ${_OBJECT}
+      OUTPUT_VARIABLE
+        _NM_OUTPUT
+      RESULT_VARIABLE
+        _NM_RESULT
+    )
+
+    if (NOT _NM_RESULT EQUAL 0)
+      message (FATAL_ERROR "${NM} failed on ${_OBJECT}.")
+    endif ()
+
+    string (REPLACE ";" "\\;" _NM_OUTPUT "${_NM_OUTPUT}")
+    string (REPLACE "\n" ";" _NM_LINES "${_NM_OUTPUT}")
+
+    foreach (_LINE IN LISTS _NM_LINES)
+      if (NOT _LINE MATCHES "^[0-9]+ ([0-9]+) [TtWw] (.*)$")
+        continue ()
+      endif ()
+
+      set (_SIZE "${CMAKE_MATCH_1}")
+      set (_NAME "${CMAKE_MATCH_2}")
+      string (MD5 _KEY "${_NAME}")
+
+      # Weak symbols are merged by the linker, so count them once.
+      if (DEFINED _SEEN_${variant}_${_KEY})
+        continue ()
+      endif ()
+      set (_SEEN_${variant}_${_KEY} TRUE)
+
+      math (EXPR _TOTAL_${variant} "${_TOTAL_${variant}} + ${_SIZE}")
+
+      if (_NAME MATCHES "gch::")
+        math (EXPR _GCH_TOTAL_${variant} "${_GCH_TOTAL_${variant}} + ${_SIZE}")
+        set (_SIZE_${variant}_${_KEY} ${_SIZE})
+        if (NOT DEFINED _NAME_${_KEY})
+          set (_NAME_${_KEY} "${_NAME}")
+          list (APPEND _KEYS ${_KEY})
+        endif ()
+      endif ()
+    endforeach ()
+  endforeach ()
+endmacro ()
+
+read_text_symbols (EXCEPTIONS)
+read_text_symbols (NO_EXCEPTIONS)
+
+# Sort the rows by the size with exceptions, largest first.
+set (_ROWS)
+foreach (_KEY IN LISTS _KEYS)
+  foreach (_VARIANT EXCEPTIONS NO_EXCEPTIONS)
+    if (NOT DEFINED _SIZE_${_VARIANT}_${_KEY})
+      set (_SIZE_${_VARIANT}_${_KEY} 0)
+    endif ()
+  endforeach ()
+
+  pad_left (_SORT_KEY "${_SIZE_EXCEPTIONS_${_KEY}}" 10 "0")
+  list (APPEND _ROWS "${_SORT_KEY}:${_KEY}")
+endforeach ()
+list (SORT _ROWS)
+list (REVERSE _ROWS)
+
+pad_left (_E "exceptions" 12 " ")
+pad_left (_N "no_exceptions" 15 " ")
+set (_REPORT "${_E}${_N}  symbol\n")
+
+foreach (_ROW IN LISTS _ROWS)
+  string (REGEX REPLACE "^[0-9]+:" "" _KEY "${_ROW}")
+  pad_left (_E "${_SIZE_EXCEPTIONS_${_KEY}}" 12 " ")
+  pad_left (_N "${_SIZE_NO_EXCEPTIONS_${_KEY}}" 15 " ")
+  string (APPEND _REPORT "${_E}${_N}  ${_NAME_${_KEY}}\n")
+endforeach ()
+
+pad_left (_E "${_GCH_TOTAL_EXCEPTIONS}" 12 " ")
+pad_left (_N "${_GCH_TOTAL_NO_EXCEPTIONS}" 15 " ")
+string (APPEND _REPORT "${_E}${_N}  [total gch:: text]\n")
+
+pad_left (_E "${_TOTAL_EXCEPTIONS}" 12 " ")
+pad_left (_N "${_TOTAL_NO_EXCEPTIONS}" 15 " ")
+string (APPEND _REPORT "${_E}${_N}  [total text]\n")
+
+file (WRITE "${OUTPUT}" "${_REPORT}")
+message ("${_REPORT}")
@@ -0,0 +1,50 @@
+/** value.cpp
+ * Instantiates the accessors and comparisons of `optional_ref` for the audit.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "code-size.hpp"
+
+#define OPTIONAL_REF_CODE_SIZE_VALUE(TYPE, NAME)                \
+TYPE&                                                           \
+value_##NAME (gch::optional_ref<TYPE> r)                        \
+{                                                               \
+  return r.value ();                                            \
+}                                                               \
+                                                                \
+TYPE&                                                           \
+value_or_##NAME (gch::optional_ref<TYPE> r, TYPE& d)            \
+{                                                               \
+  return r.value_or (d);                                        \
+}                                                               \
+                                                                \
+bool                                                            \
+equal_pointer_##NAME (gch::optional_ref<TYPE> lhs,              \
+                      gch::optional_ref<TYPE> rhs)              \
+{                                                               \
+  return lhs.equal_pointer (rhs);                               \
+}
+
+OPTIONAL_REF_CODE_SIZE_FOR_EACH_TYPE (OPTIONAL_REF_CODE_SIZE_VALUE)
+
+bool
+equal_int (gch::optional_ref<int> lhs, gch::optional_ref<int> rhs)
+{
+  return lhs == rhs;
+}
+
+bool
+less_string (gch::optional_cref<std::string> lhs, gch::optional_cref<std::string> rhs)
+{
+  return lhs < rhs;
+}
+
+std::size_t
+hash_large (gch::optional_ref<code_size::large> r)
+{
+  return std::hash<gch::optional_ref<code_size::large>> { } (r);
+}
@@ -0,0 +1,90 @@
+# Checks that each `monadic_<name>` function in an object compiles to the same
+# instructions as the corresponding `manual_<name>` function.
+#
+# Register allocation and scheduling may differ slightly when the result is a
+# class such as `std::optional`, so a pair also passes if the monadic function
+# has no more instructions than the manual one. Such pairs are reported along
+# with their instruction counts.
+#
+# Usage:
+#   cmake -DOBJDUMP=<objdump> -DOBJECTS=<objects> -P compare.cmake
+#
+# Addresses are removed from the disassembly and branch targets are kept as
+# offsets from the start of the function, so that identical code compares equal.
+# Padding is ignored.
+
+foreach (_VAR OBJDUMP OBJECTS)
+  if (NOT DEFINED ${_VAR})
+    message (FATAL_ERROR "${_VAR} must be defined.")
+  endif ()
+endforeach ()
+
+set (_NAMES)
+
+foreach (_OBJECT IN LISTS OBJECTS)
+  execute_process (
+    COMMAND
+      ${OBJDUMP} -d -C --no-show-raw-insn ${_OBJECT}
+    OUTPUT_VARIABLE
+      _OBJDUMP_OUTPUT
+    RESULT_VARIABLE
+      _OBJDUMP_RESULT
+  )
+
+  if (NOT _OBJDUMP_RESULT EQUAL 0)
+    message (FATAL_ERROR "${OBJDUMP} failed on ${_OBJECT}.")
+  endif ()
+
+  string (REPLACE ";" "\;" _OBJDUMP_OUTPUT "${_OBJDUMP_OUTPUT}")
+  string (REPLACE "\n" ";" _LINES "${_OBJDUMP_OUTPUT}")
+
+  set (_CURRENT)
+  foreach (_LINE IN LISTS _LINES)
+    if (_LINE MATCHES "^[0-9a-f]+ <(monadic|manual)_([A-Za-z0-9_]+)\\(")
+      set (_CURRENT "${CMAKE_MATCH_1}_${CMAKE_MATCH_2}")
+      set (_CODE_${_CURRENT})
+      set (_COUNT_${_CURRENT} 0)
+      list (APPEND _NAMES ${CMAKE_MATCH_2})
+    elseif (_LINE MATCHES "^[0-9a-f]+ <")
+      set (_CURRENT)
+    elseif (_CURRENT AND _LINE MATCHES "^ *[0-9a-f]+:\t(.*)$")
+      set (_INSTRUCTION "${CMAKE_MATCH_1}")
+      if (NOT _INSTRUCTION MATCHES "^(nop|xchg +%ax,%ax|data16|cs nop|int3)")
+        string (REGEX REPLACE "[0-9a-f]+ <.*(\\+0x[0-9a-f]+)>$" "<\\1>" _INSTRUCTION "${_INSTRUCTION}")
+        string (REGEX REPLACE "[0-9a-f]+ <.*>$" "<>" _INSTRUCTION "${_INSTRUCTION}")
+        string (REGEX REPLACE " +" " " _INSTRUCTION "${_INSTRUCTION}")
+        string (APPEND _CODE_${_CURRENT} "    ${_INSTRUCTION}\n")
+        math (EXPR _COUNT_${_CURRENT} "${_COUNT_${_CURRENT}} + 1")
+      endif ()
+    endif ()
+  endforeach ()
+endforeach ()
+
+list (REMOVE_DUPLICATES _NAMES)
+list (SORT _NAMES)
+
+set (_FAILED)
+foreach (_NAME IN LISTS _NAMES)
+  if (NOT DEFINED _CODE_monadic_${_NAME} OR NOT DEFINED _CODE_manual_${_NAME})
+    message (SEND_ERROR "${_NAME}: missing the monadic or the manual function.")
+    list (APPEND _FAILED ${_NAME})
+  elseif (_CODE_monadic_${_NAME} STREQUAL _CODE_manual_${_NAME})
+    message (STATUS "${_NAME}: identical")
+  elseif (NOT _COUNT_monadic_${_NAME} GREATER _COUNT_manual_${_NAME})
+    message (STATUS "${_NAME}: not identical, but no longer "
+                    "(${_COUNT_monadic_${_NAME}} vs. ${_COUNT_manual_${_NAME}} instructions)")
+  else ()
+    message (SEND_ERROR "${_NAME}: the code differs.\n"
+                        "  monadic:\n${_CODE_monadic_${_NAME}}"
+                        "  manual:\n${_CODE_manual_${_NAME}}")
+    list (APPEND _FAILED ${_NAME})
+  endif ()
+endforeach ()
+
+if (NOT _NAMES)
+  message (FATAL_ERROR "No functions were found.")
+endif ()
+
+if (_FAILED)
+  message (FATAL_ERROR "The code of the monadic members differs from the pointer tests.")
+endif ()
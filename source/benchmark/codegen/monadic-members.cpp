@@ -0,0 +1,166 @@
+/** monadic-members.cpp
+ * Pairs each monadic member of `optional_ref` with a hand-written pointer
+ * test. The pairs are named `monadic_<name>` and `manual_<name>`, and
+ * compare.cmake checks that the two functions of each pair compile to the
+ * same instructions (or, failing that, that the monadic one is no longer).
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "gch/optional_ref.hpp"
+
+#include <optional>
+
+namespace codegen
+{
+
+  struct node
+  {
+    node *next;
+    int   value;
+  };
+
+  extern node fallback;
+
+  struct get_next
+  {
+    gch::optional_ref<node>
+    operator() (node& n) const noexcept
+    {
+      return n.next;
+    }
+  };
+
+  struct get_value
+  {
+    int&
+    operator() (node& n) const noexcept
+    {
+      return n.value;
+    }
+  };
+
+  struct twice_value
+  {
+    int
+    operator() (node& n) const noexcept
+    {
+      return 2 * n.value;
+    }
+  };
+
+  struct get_fallback
+  {
+    node&
+    operator() (void) const noexcept
+    {
+      return fallback;
+    }
+  };
+
+  struct seven
+  {
+    int
+    operator() (void) const noexcept
+    {
+      return 7;
+    }
+  };
+
+}
+
+using codegen::node;
+
+gch::optional_ref<node>
+monadic_and_then (gch::optional_ref<node> r)
+{
+  return r.and_then (codegen::get_next { });
+}
+
+gch::optional_ref<node>
+manual_and_then (gch::optional_ref<node> r)
+{
+  node *p = r.get_pointer ();
+  return p != nullptr ? p->next : nullptr;
+}
+
+gch::optional_ref<int>
+monadic_transform_ref (gch::optional_ref<node> r)
+{
+  return r.transform (codegen::get_value { });
+}
+
+gch::optional_ref<int>
+manual_transform_ref (gch::optional_ref<node> r)
+{
+  node *p = r.get_pointer ();
+  return p != nullptr ? &p->value : nullptr;
+}
+
+std::optional<int>
+monadic_transform_object (gch::optional_ref<node> r)
+{
+  return gch::transform (r, codegen::twice_value { });
+}
+
+std::optional<int>
+manual_transform_object (gch::optional_ref<node> r)
+{
+  node *p = r.get_pointer ();
+  return p != nullptr ? std::optional<int> (2 * p->value) : std::nullopt;
+}
+
+int
+monadic_transform_lazy (gch::optional_ref<node> r)
+{
+  return r.transform (codegen::twice_value { }).value_or (0);
+}
+
+int
+manual_transform_lazy (gch::optional_ref<node> r)
+{
+  node *p = r.get_pointer ();
+  return p != nullptr ? 2 * p->value : 0;
+}
+
+gch::optional_ref<node>
+monadic_or_else (gch::optional_ref<node> r)
+{
+  return r.or_else (codegen::get_fallback { });
+}
+
+gch::optional_ref<node>
+manual_or_else (gch::optional_ref<node> r)
+{
+  node *p = r.get_pointer ();
+  return p != nullptr ? p : &codegen::fallback;
+}
+
+node&
+monadic_value_or_else_ref (gch::optional_ref<node> r)
+{
+  return r.value_or_else (codegen::get_fallback { });
+}
+
+node&
+manual_value_or_else_ref (gch::optional_ref<node> r)
+{
+  node *p = r.get_pointer ();
+  return p != nullptr ? *p : codegen::fallback;
+}
+
+int
+monadic_value_or_else_object (gch::optional_ref<int> r)
+{
+  return r.value_or_else (codegen::seven { });
+}
+
+int
+manual_value_or_else_object (gch::optional_ref<int> r)
+{
+  int *p = r.get_pointer ();
+  return p != nullptr ? *p : 7;
+}
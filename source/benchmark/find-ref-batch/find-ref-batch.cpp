@@ -0,0 +1,218 @@
+/** find-ref-batch.cpp
+ * Compares `find_ref_batch` with a loop of `find_ref` on tables which are
+ * much larger than the cache.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "gch/optional_ref.hpp"
+#include "gch/optional_ref/find_ref.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+  // An open-addressing table with linear probing. A key of zero marks an
+  // empty slot.
+  class flat_table
+  {
+  public:
+    struct slot
+    {
+      std::uint64_t key;
+      std::uint64_t value;
+    };
+
+    explicit
+    flat_table (std::size_t capacity)
+      : m_slots (capacity),
+        m_mask (capacity - 1)
+    { }
+
+    void
+    insert (std::uint64_t key, std::uint64_t value)
+    {
+      std::size_t i = home (key);
+      while (m_slots[i].key != 0 && m_slots[i].key != key)
+        i = (i + 1) & m_mask;
+      m_slots[i] = { key, value };
+    }
+
+    std::size_t
+    home (std::uint64_t key) const noexcept
+    {
+      return static_cast<std::size_t> ((key * 0x9E3779B97F4A7C15ULL) >> 20) & m_mask;
+    }
+
+    const slot *
+    slot_at (std::size_t i) const noexcept
+    {
+      return m_slots.data () + i;
+    }
+
+    gch::optional_ref<std::uint64_t>
+    probe (std::uint64_t key, std::size_t i) noexcept
+    {
+      for (; m_slots[i].key != 0; i = (i + 1) & m_mask)
+      {
+        if (m_slots[i].key == key)
+          return gch::optional_ref<std::uint64_t> (m_slots[i].value);
+      }
+      return gch::nullopt;
+    }
+
+    gch::optional_ref<std::uint64_t>
+    find_ref (std::uint64_t key) noexcept
+    {
+      return probe (key, home (key));
+    }
+
+  private:
+    std::vector<slot> m_slots;
+    std::size_t       m_mask;
+  };
+
+}
+
+namespace gch
+{
+
+  template <>
+  struct find_ref_batch_traits<flat_table>
+  {
+    using probe_type = std::size_t;
+
+    static
+    probe_type
+    start (flat_table& t, std::uint64_t key) noexcept
+    {
+      std::size_t i = t.home (key);
+      GCH_PREFETCH (t.slot_at (i));
+      return i;
+    }
+
+    static
+    void
+    advance (flat_table&, probe_type&) noexcept
+    { }
+
+    static
+    optional_ref<std::uint64_t>
+    resolve (flat_table& t, std::uint64_t key, probe_type& i) noexcept
+    {
+      return t.probe (key, i);
+    }
+  };
+
+}
+
+namespace
+{
+
+  template <typename Function>
+  double
+  time_ns_per_lookup (Function f, std::size_t lookups)
+  {
+    auto start = std::chrono::steady_clock::now ();
+    f ();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now () - start;
+    return elapsed.count () / static_cast<double> (lookups);
+  }
+
+  std::uint64_t
+  sum (const std::vector<gch::optional_ref<std::uint64_t>>& results)
+  {
+    std::uint64_t s = 0;
+    for (gch::optional_ref<std::uint64_t> r : results)
+      s += r.value_or (0);
+    return s;
+  }
+
+  template <typename Scalar, typename Batch>
+  bool
+  compare (const char *name, const std::vector<std::uint64_t>& keys, Scalar scalar, Batch batch)
+  {
+    std::vector<gch::optional_ref<std::uint64_t>> scalar_out (keys.size ());
+    std::vector<gch::optional_ref<std::uint64_t>> batch_out (keys.size ());
+
+    double scalar_ns = time_ns_per_lookup ([&] { scalar (scalar_out); }, keys.size ());
+    double batch_ns  = time_ns_per_lookup ([&] { batch (batch_out); }, keys.size ());
+
+    for (std::size_t i = 0; i < keys.size (); ++i)
+    {
+      if (scalar_out[i].get_pointer () != batch_out[i].get_pointer ())
+      {
+        std::fprintf (stderr, "%s: the results of find_ref and find_ref_batch differ.\n", name);
+        return false;
+      }
+    }
+
+    std::printf ("%-20s find_ref: %6.2f ns   find_ref_batch: %6.2f ns   (%.2fx)   [%llu]\n",
+                 name, scalar_ns, batch_ns, scalar_ns / batch_ns,
+                 static_cast<unsigned long long> (sum (batch_out)));
+    return true;
+  }
+
+}
+
+int
+main (void)
+{
+  constexpr std::size_t entries = std::size_t { 1 } << 22;
+  constexpr std::size_t lookups = std::size_t { 1 } << 22;
+
+  std::mt19937_64 rng (12345);
+
+  std::vector<std::uint64_t> inserted (entries);
+  for (std::uint64_t& k : inserted)
+    k = rng () | 1;
+
+  // Insert in a random order so that the nodes of the unordered_map are
+  // scattered over the heap.
+  std::unordered_map<std::uint64_t, std::uint64_t> map;
+  map.reserve (entries);
+  flat_table flat (entries * 2);
+  for (std::uint64_t k : inserted)
+  {
+    map.emplace (k, k >> 1);
+    flat.insert (k, k >> 1);
+  }
+
+  // Half of the keys are present.
+  std::vector<std::uint64_t> keys (lookups);
+  std::uniform_int_distribution<std::size_t> pick (0, entries - 1);
+  for (std::size_t i = 0; i < lookups; ++i)
+    keys[i] = (i % 2 == 0) ? inserted[pick (rng)] : (rng () & ~std::uint64_t { 1 });
+  std::shuffle (keys.begin (), keys.end (), rng);
+
+  bool ok = compare ("std::unordered_map", keys,
+    [&] (std::vector<gch::optional_ref<std::uint64_t>>& out) {
+      for (std::size_t i = 0; i < keys.size (); ++i)
+        out[i] = gch::find_ref (map, keys[i]);
+    },
+    [&] (std::vector<gch::optional_ref<std::uint64_t>>& out) {
+      gch::find_ref_batch (map, keys.data (), keys.size (), out.data ());
+    });
+
+  ok = compare ("open addressing", keys,
+    [&] (std::vector<gch::optional_ref<std::uint64_t>>& out) {
+      for (std::size_t i = 0; i < keys.size (); ++i)
+        out[i] = flat.find_ref (keys[i]);
+    },
+    [&] (std::vector<gch::optional_ref<std::uint64_t>>& out) {
+      gch::find_ref_batch (flat, keys.data (), keys.size (), out.data ());
+    }) && ok;
+
+  return ok ? 0 : 1;
+}
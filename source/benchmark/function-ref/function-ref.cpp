@@ -0,0 +1,150 @@
+/** function-ref.cpp
+ * Compares the dispatch latency of `optional_function_ref` with function
+ * pointers and `std::function`.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "gch/optional_ref/optional_function_ref.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+namespace
+{
+
+  using callback = gch::optional_function_ref<long (long)>;
+
+  long
+  add_one (long x)
+  {
+    return x + 1;
+  }
+
+  long
+  times_three (long x)
+  {
+    return x * 3;
+  }
+
+  struct adder
+  {
+    long
+    operator() (long x) const noexcept
+    {
+      return x + offset;
+    }
+
+    long offset;
+  };
+
+  // Invokes every callback in turn, feeding each result into the next call.
+  template <typename Function>
+  long
+  dispatch (const std::vector<Function>& callbacks, std::size_t rounds)
+  {
+    long x = 0;
+    for (std::size_t round = 0; round < rounds; ++round)
+    {
+      for (const Function& f : callbacks)
+        x = f (x) & 0xFFFF;
+    }
+    return x;
+  }
+
+  // Like `dispatch`, but skips the callbacks which are unset.
+  long
+  dispatch_nullable (const std::vector<callback>& callbacks, std::size_t rounds)
+  {
+    long x = 0;
+    for (std::size_t round = 0; round < rounds; ++round)
+    {
+      for (const callback& f : callbacks)
+        x = f.invoke_or (x, x) & 0xFFFF;
+    }
+    return x;
+  }
+
+  template <typename Function>
+  double
+  time_ns_per_call (Function f, std::size_t calls, long& result)
+  {
+    auto start = std::chrono::steady_clock::now ();
+    result = f ();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now () - start;
+    return elapsed.count () / static_cast<double> (calls);
+  }
+
+}
+
+int
+main (void)
+{
+  constexpr std::size_t count  = 64;
+  constexpr std::size_t rounds = 200000;
+  constexpr std::size_t calls  = count * rounds;
+
+  std::vector<adder> adders;
+  for (std::size_t i = 0; i < count; ++i)
+    adders.push_back (adder { static_cast<long> (i) });
+
+  // Alternate between two targets of each kind so that the calls stay indirect.
+  std::vector<long (*) (long)> pointers;
+  std::vector<std::function<long (long)>> functions;
+  std::vector<callback> refs;
+  std::vector<callback> sparse_refs;
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    pointers.push_back (i % 2 == 0 ? &add_one : &times_three);
+    if (i % 2 == 0)
+    {
+      functions.emplace_back (&add_one);
+      refs.emplace_back (&add_one);
+      sparse_refs.emplace_back (&add_one);
+    }
+    else
+    {
+      functions.emplace_back (adders[i]);
+      refs.emplace_back (adders[i]);
+      sparse_refs.emplace_back (gch::nullopt);
+    }
+  }
+
+  long pointer_result  = 0;
+  long function_result = 0;
+  long ref_result      = 0;
+  long sparse_result   = 0;
+
+  double pointer_ns = time_ns_per_call ([&] {
+    return dispatch (pointers, rounds);
+  }, calls, pointer_result);
+  double function_ns = time_ns_per_call ([&] {
+    return dispatch (functions, rounds);
+  }, calls, function_result);
+  double ref_ns = time_ns_per_call ([&] {
+    return dispatch (refs, rounds);
+  }, calls, ref_result);
+  double sparse_ns = time_ns_per_call ([&] {
+    return dispatch_nullable (sparse_refs, rounds);
+  }, calls, sparse_result);
+
+  if (function_result != ref_result)
+  {
+    std::fprintf (stderr, "The results of std::function and optional_function_ref differ.\n");
+    return 1;
+  }
+
+  std::printf ("function pointer:                  %6.2f ns/call  (result %ld)\n",
+               pointer_ns, pointer_result);
+  std::printf ("std::function:                     %6.2f ns/call\n", function_ns);
+  std::printf ("optional_function_ref:             %6.2f ns/call\n", ref_ns);
+  std::printf ("optional_function_ref (invoke_or): %6.2f ns/call  (result %ld)\n",
+               sparse_ns, sparse_result);
+  return 0;
+}
@@ -0,0 +1,147 @@
+/** identity-first.cpp
+ * Compares the identity-first comparators with the by-value comparison
+ * operators on workloads in which many references alias the same object.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "gch/optional_ref.hpp"
+#include "gch/optional_ref/identity_first.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+  using ref = gch::optional_ref<const std::string>;
+
+  // Distinct strings which share a long prefix, so that a value comparison
+  // reads most of both strings.
+  std::vector<std::string>
+  make_values (std::size_t count, std::size_t length)
+  {
+    std::vector<std::string> values;
+    values.reserve (count);
+    for (std::size_t i = 0; i < count; ++i)
+      values.push_back (std::string (length, 'x') + std::to_string (i));
+    return values;
+  }
+
+  std::vector<ref>
+  make_refs (const std::vector<std::string>& values, std::size_t count, unsigned seed)
+  {
+    std::mt19937 gen (seed);
+    std::uniform_int_distribution<std::size_t> dist (0, values.size () - 1);
+    std::vector<ref> refs;
+    refs.reserve (count);
+    for (std::size_t i = 0; i < count; ++i)
+      refs.emplace_back (values[dist (gen)]);
+    return refs;
+  }
+
+  template <typename Function>
+  double
+  time_ms (Function f)
+  {
+    auto start = std::chrono::steady_clock::now ();
+    f ();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now () - start;
+    return elapsed.count ();
+  }
+
+  // Sorts and removes duplicates.
+  template <typename Less, typename Equal>
+  std::size_t
+  dedup (std::vector<ref> refs, Less less, Equal equal)
+  {
+    std::sort (refs.begin (), refs.end (), less);
+    return static_cast<std::size_t> (
+      std::unique (refs.begin (), refs.end (), equal) - refs.begin ());
+  }
+
+  // Counts the matching pairs of two sorted sequences in a merge join.
+  template <typename Less, typename Equal>
+  std::size_t
+  join (const std::vector<ref>& lhs, const std::vector<ref>& rhs, Less less, Equal equal)
+  {
+    std::size_t matches = 0;
+    auto l = lhs.begin ();
+    auto r = rhs.begin ();
+    while (l != lhs.end () && r != rhs.end ())
+    {
+      if (equal (*l, *r))
+      {
+        ++matches;
+        ++l;
+      }
+      else if (less (*l, *r))
+        ++l;
+      else
+        ++r;
+    }
+    return matches;
+  }
+
+  void
+  report (const char *name, double by_value, double identity_first)
+  {
+    std::printf ("%-8s by value: %9.2f ms  identity first: %9.2f ms  (%.2fx)\n",
+                 name, by_value, identity_first, by_value / identity_first);
+  }
+
+}
+
+int
+main (void)
+{
+  const std::vector<std::string> values = make_values (512, 1024);
+  const std::vector<ref> refs = make_refs (values, 200000, 1);
+
+  std::less<ref>     by_value_less;
+  std::equal_to<ref> by_value_equal;
+  gch::identity_first_less  identity_less;
+  gch::identity_first_equal identity_equal;
+
+  std::size_t dedup_by_value = 0;
+  std::size_t dedup_identity = 0;
+  double dedup_by_value_ms = time_ms ([&] {
+    dedup_by_value = dedup (refs, by_value_less, by_value_equal);
+  });
+  double dedup_identity_ms = time_ms ([&] {
+    dedup_identity = dedup (refs, identity_less, identity_equal);
+  });
+
+  std::vector<ref> lhs = refs;
+  std::vector<ref> rhs = make_refs (values, refs.size (), 2);
+  std::sort (lhs.begin (), lhs.end (), by_value_less);
+  std::sort (rhs.begin (), rhs.end (), by_value_less);
+
+  std::size_t join_by_value = 0;
+  std::size_t join_identity = 0;
+  double join_by_value_ms = time_ms ([&] {
+    join_by_value = join (lhs, rhs, by_value_less, by_value_equal);
+  });
+  double join_identity_ms = time_ms ([&] {
+    join_identity = join (lhs, rhs, identity_less, identity_equal);
+  });
+
+  if (dedup_by_value != dedup_identity || join_by_value != join_identity)
+  {
+    std::fprintf (stderr, "The results of the comparators differ.\n");
+    return 1;
+  }
+
+  report ("dedup", dedup_by_value_ms, dedup_identity_ms);
+  report ("join", join_by_value_ms, join_identity_ms);
+  return 0;
+}
@@ -0,0 +1,265 @@
+/** ref-queue.cpp
+ * Compares the throughput and latency of `ref_spsc_queue` and
+ * `ref_mpmc_queue` with a `std::deque` guarded by a `std::mutex`.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "gch/optional_ref/ref_queue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+  struct message
+  {
+    long value;
+    std::atomic<int> pops;
+  };
+
+  // The baseline, with the same interface as the queues.
+  class locked_queue
+  {
+  public:
+    explicit
+    locked_queue (std::size_t capacity)
+      : m_capacity (capacity)
+    { }
+
+    bool
+    try_push (message& m)
+    {
+      std::lock_guard<std::mutex> lock (m_mutex);
+      if (m_deque.size () == m_capacity)
+        return false;
+      m_deque.emplace_back (m);
+      return true;
+    }
+
+    gch::optional_ref<message>
+    try_pop (void)
+    {
+      std::lock_guard<std::mutex> lock (m_mutex);
+      if (m_deque.empty ())
+        return gch::nullopt;
+      gch::optional_ref<message> front = m_deque.front ();
+      m_deque.pop_front ();
+      return front;
+    }
+
+    template <typename InputIt>
+    std::size_t
+    push_n (InputIt first, std::size_t n)
+    {
+      std::lock_guard<std::mutex> lock (m_mutex);
+      std::size_t count = 0;
+      for (; count < n && m_deque.size () < m_capacity; ++count, ++first)
+        m_deque.push_back (*first);
+      return count;
+    }
+
+    template <typename OutputIt>
+    std::size_t
+    pop_n (OutputIt out, std::size_t n)
+    {
+      std::lock_guard<std::mutex> lock (m_mutex);
+      std::size_t count = 0;
+      for (; count < n && ! m_deque.empty (); ++count, ++out)
+      {
+        *out = m_deque.front ();
+        m_deque.pop_front ();
+      }
+      return count;
+    }
+
+  private:
+    std::size_t                            m_capacity;
+    std::mutex                             m_mutex;
+    std::deque<gch::optional_ref<message>> m_deque;
+  };
+
+  constexpr std::size_t capacity = 1024;
+
+  // Moves every message through the queue, and returns the time per message
+  // in nanoseconds, or a negative number if a message was lost or duplicated.
+  template <typename Queue>
+  double
+  throughput (std::vector<message>& messages, unsigned producers, unsigned consumers,
+              std::size_t batch)
+  {
+    for (message& m : messages)
+      m.pops.store (0, std::memory_order_relaxed);
+
+    Queue q (capacity);
+    std::atomic<std::size_t> remaining (messages.size ());
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::steady_clock::now ();
+
+    std::size_t share = messages.size () / producers;
+    for (unsigned p = 0; p < producers; ++p)
+    {
+      threads.emplace_back ([&, p] {
+        std::vector<gch::optional_ref<message>> in;
+        for (std::size_t i = p * share; i < (p + 1) * share; ++i)
+          in.emplace_back (messages[i]);
+
+        for (std::size_t i = 0; i < in.size (); )
+        {
+          std::size_t n = batch < in.size () - i ? batch : in.size () - i;
+          std::size_t pushed = (batch == 1) ? (q.try_push (*in[i]) ? 1 : 0)
+                                            : q.push_n (in.begin () + static_cast<long> (i), n);
+          if (pushed == 0)
+            std::this_thread::yield ();
+          i += pushed;
+        }
+      });
+    }
+
+    for (unsigned c = 0; c < consumers; ++c)
+    {
+      threads.emplace_back ([&] {
+        std::vector<gch::optional_ref<message>> out (batch);
+        while (remaining.load (std::memory_order_relaxed) != 0)
+        {
+          std::size_t popped = 0;
+          if (batch == 1)
+          {
+            gch::optional_ref<message> m = q.try_pop ();
+            if (m)
+            {
+              m->pops.fetch_add (1, std::memory_order_relaxed);
+              popped = 1;
+            }
+          }
+          else
+          {
+            popped = q.pop_n (out.begin (), batch);
+            for (std::size_t i = 0; i < popped; ++i)
+              out[i]->pops.fetch_add (1, std::memory_order_relaxed);
+          }
+
+          if (popped == 0)
+            std::this_thread::yield ();
+          else
+            remaining.fetch_sub (popped, std::memory_order_relaxed);
+        }
+      });
+    }
+
+    for (std::thread& t : threads)
+      t.join ();
+
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now () - start;
+
+    for (message& m : messages)
+    {
+      if (m.pops.load (std::memory_order_relaxed) != 1)
+        return -1.0;
+    }
+    return elapsed.count () / static_cast<double> (messages.size ());
+  }
+
+  // Bounces one message between two threads, and returns the time per round
+  // trip in nanoseconds.
+  template <typename Queue>
+  double
+  latency (std::size_t round_trips)
+  {
+    Queue ping (capacity);
+    Queue pong (capacity);
+    message m { 0, { 0 } };
+
+    std::thread echo ([&] {
+      for (std::size_t i = 0; i < round_trips; ++i)
+      {
+        gch::optional_ref<message> r;
+        while (! (r = ping.try_pop ()))
+          std::this_thread::yield ();
+        r->value += 1;
+        pong.try_push (*r);
+      }
+    });
+
+    auto start = std::chrono::steady_clock::now ();
+    for (std::size_t i = 0; i < round_trips; ++i)
+    {
+      ping.try_push (m);
+      while (! pong.try_pop ())
+        std::this_thread::yield ();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now () - start;
+    echo.join ();
+
+    if (m.value != static_cast<long> (round_trips))
+      return -1.0;
+    return elapsed.count () / static_cast<double> (round_trips);
+  }
+
+  template <typename Queue>
+  bool
+  report (const char *name, std::vector<message>& messages, unsigned producers,
+          unsigned consumers)
+  {
+    double single  = throughput<Queue> (messages, producers, consumers, 1);
+    double batched = throughput<Queue> (messages, producers, consumers, 32);
+    if (single < 0 || batched < 0)
+    {
+      std::fprintf (stderr, "%s lost or duplicated a message.\n", name);
+      return false;
+    }
+    std::printf ("  %-22s %7.2f ns/msg   batch of 32: %7.2f ns/msg\n", name, single, batched);
+    return true;
+  }
+
+}
+
+int
+main (void)
+{
+  std::vector<message> messages (1 << 20);
+  for (std::size_t i = 0; i < messages.size (); ++i)
+    messages[i].value = static_cast<long> (i);
+
+  std::printf ("throughput, 1 producer and 1 consumer\n");
+  if (! report<gch::ref_spsc_queue<message>> ("ref_spsc_queue", messages, 1, 1)
+      ||! report<gch::ref_mpmc_queue<message>> ("ref_mpmc_queue", messages, 1, 1)
+      ||! report<locked_queue> ("mutex + deque", messages, 1, 1))
+  {
+    return 1;
+  }
+
+  std::printf ("throughput, 2 producers and 2 consumers\n");
+  if (! report<gch::ref_mpmc_queue<message>> ("ref_mpmc_queue", messages, 2, 2)
+      ||! report<locked_queue> ("mutex + deque", messages, 2, 2))
+  {
+    return 1;
+  }
+
+  constexpr std::size_t round_trips = 100000;
+  double spsc_ns   = latency<gch::ref_spsc_queue<message>> (round_trips);
+  double mpmc_ns   = latency<gch::ref_mpmc_queue<message>> (round_trips);
+  double locked_ns = latency<locked_queue> (round_trips);
+  if (spsc_ns < 0 || mpmc_ns < 0 || locked_ns < 0)
+  {
+    std::fprintf (stderr, "A round trip was lost.\n");
+    return 1;
+  }
+
+  std::printf ("latency, round trip between 2 threads\n");
+  std::printf ("  %-22s %7.0f ns\n", "ref_spsc_queue", spsc_ns);
+  std::printf ("  %-22s %7.0f ns\n", "ref_mpmc_queue", mpmc_ns);
+  std::printf ("  %-22s %7.0f ns\n", "mutex + deque", locked_ns);
+  return 0;
+}
@@ -0,0 +1,346 @@
+/** any_optional_ref.hpp
+ * Defines `any_optional_ref`, a nullable reference to an object of any type
+ * which remembers the type of its referent.
+ *
+ * The type is identified by a token, which is the address of a static
+ * variable instantiated for the type, so no RTTI is needed. The ref is a
+ * pointer and a token, and is trivially copyable.
+ *
+ * Tokens are unique as long as the static variables of templates are merged
+ * across the program, which is also what RTTI relies on. On platforms where
+ * shared libraries do not export them (such as Windows DLLs), an
+ * `any_optional_ref` must not be passed between libraries.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_OPTIONAL_REF_ANY_OPTIONAL_REF_HPP
+#define GCH_OPTIONAL_REF_ANY_OPTIONAL_REF_HPP
+
+#include "core.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  class any_optional_ref;
+
+} // namespace gch
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    // The tokens of `T`, `const T`, `volatile T`, and `const volatile T`,
+    // indexed by `any_optional_ref_cv_index`. The storage is not const, so
+    // the linker may not merge the tokens of different types as identical
+    // constants.
+    template <typename T>
+    struct any_optional_ref_type_id
+    {
+      static char tokens[4];
+    };
+
+    template <typename T>
+    char any_optional_ref_type_id<T>::tokens[4];
+
+    template <typename T>
+    struct any_optional_ref_cv_index
+      : std::integral_constant<std::size_t,
+                               (std::is_const<T>::value    ? 1U : 0U)
+                             | (std::is_volatile<T>::value ? 2U : 0U)>
+    { };
+
+    // Whether a reference to `T` is referred to rather than converted.
+    template <typename T>
+    struct any_optional_ref_is_referent
+      : std::integral_constant<
+          bool,
+              std::is_object<T>::value
+          &&! std::is_same<typename std::remove_cv<T>::type, nullopt_t>::value
+          &&! std::is_same<typename std::remove_cv<T>::type, any_optional_ref>::value
+          &&! is_optional_ref<typename std::remove_cv<T>::type>::value>
+    { };
+
+  }
+
+} // namespace gch
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * A nullable reference to an object of any type.
+   *
+   * The referent is read back with `get<T> ()`, which is empty unless the
+   * referent has the type `T`, up to cv-qualification which `T` adds. That
+   * is, a ref to an `int` may be read as an `int` or a `const int`, but a ref
+   * to a `const int` may not be read as an `int`. Base classes do not match.
+   *
+   * Comparisons are by identity: two refs are equal if they refer to the same
+   * object as the same type, or are both empty.
+   */
+  class any_optional_ref
+  {
+  public:
+    /**
+     * The type of the token which identifies the type of the referent.
+     */
+    using type_token = const void *;
+
+    /**
+     * Default constructor
+     *
+     * Constructs an empty ref.
+     */
+    constexpr
+    any_optional_ref (void) noexcept = default;
+
+    /**
+     * Constructor
+     *
+     * Constructs an empty ref.
+     */
+    constexpr GCH_IMPLICIT_CONVERSION
+    any_optional_ref (nullopt_t) noexcept
+    { }
+
+    /**
+     * Constructor
+     *
+     * Refers to `ref`.
+     *
+     * @tparam T the type of the referent.
+     * @param ref a reference.
+     */
+    template <typename T,
+              typename std::enable_if<
+                detail::any_optional_ref_is_referent<T>::value>::type * = nullptr>
+    explicit
+    any_optional_ref (T& ref) noexcept
+      : m_ptr (const_cast<void *> (static_cast<const volatile void *> (std::addressof (ref)))),
+        m_token (token_of<T> ())
+    { }
+
+    /**
+     * Constructor
+     *
+     * A deleted contructor for the case where `ref` is an rvalue reference.
+     */
+    template <typename T,
+              typename std::enable_if<
+                detail::any_optional_ref_is_referent<T>::value>::type * = nullptr>
+    any_optional_ref (const T&&) = delete;
+
+    /**
+     * Constructor
+     *
+     * Refers to the referent of `ref`, if any.
+     *
+     * @tparam T the value type of `ref`.
+     * @param ref an `optional_ref`.
+     */
+    template <typename T>
+    GCH_IMPLICIT_CONVERSION
+    any_optional_ref (optional_ref<T> ref) noexcept
+      : m_ptr (const_cast<void *> (static_cast<const volatile void *> (ref.get_pointer ()))),
+        m_token (ref.has_value () ? token_of<T> () : nullptr)
+    { }
+
+    /**
+     * Returns the token of a type, which `get_type_token ()` returns for a ref to
+     * an object of that type.
+     *
+     * @tparam T a type.
+     * @return the token of `T`.
+     */
+    template <typename T>
+    GCH_NODISCARD static constexpr
+    type_token
+    token_of (void) noexcept
+    {
+      static_assert (std::is_object<T>::value, "any_optional_ref refers to objects.");
+      return detail::any_optional_ref_type_id<typename std::remove_cv<T>::type>::tokens
+           + detail::any_optional_ref_cv_index<T>::value;
+    }
+
+    /**
+     * Empties the ref.
+     */
+    GCH_CPP14_CONSTEXPR
+    void
+    reset (void) noexcept
+    {
+      m_ptr   = nullptr;
+      m_token = nullptr;
+    }
+
+    /**
+     * Checks whether the ref refers to an object.
+     *
+     * @return whether `*this` contains a value.
+     */
+    GCH_NODISCARD constexpr
+    bool
+    has_value (void) const noexcept
+    {
+      return m_token != nullptr;
+    }
+
+    /**
+     * Checks whether the ref refers to an object.
+     *
+     * @return whether `*this` contains a value.
+     */
+    GCH_NODISCARD constexpr explicit
+    operator bool (void) const noexcept
+    {
+      return has_value ();
+    }
+
+    /**
+     * Checks whether the referent may be read as a `T`.
+     *
+     * @tparam T a type.
+     * @return whether `get<T> ()` is not empty.
+     */
+    template <typename T>
+    GCH_NODISCARD constexpr
+    bool
+    holds (void) const noexcept
+    {
+      return holds_impl<typename std::remove_cv<T>::type> (
+        detail::any_optional_ref_cv_index<T>::value);
+    }
+
+    /**
+     * Gets the referent as a `T`.
+     *
+     * @tparam T a type.
+     * @return a reference to the referent, or an empty `optional_ref`
+     *         if `*this` is empty or the referent is not a `T`.
+     */
+    template <typename T>
+    GCH_NODISCARD
+    optional_ref<T>
+    get (void) const noexcept
+    {
+      return holds<T> () ? optional_ref<T> (static_cast<T *> (m_ptr)) : optional_ref<T> ();
+    }
+
+    /**
+     * Returns the token of the type of the referent.
+     *
+     * @return the token of the type of the referent, or `nullptr`
+     *         if `*this` is empty.
+     */
+    GCH_NODISCARD constexpr
+    type_token
+    get_type_token (void) const noexcept
+    {
+      return m_token;
+    }
+
+    /**
+     * Checks whether two refs refer to the same object as the same type.
+     *
+     * @param lhs a ref.
+     * @param rhs a ref.
+     * @return whether the refs are equal.
+     */
+    GCH_NODISCARD friend constexpr
+    bool
+    operator== (const any_optional_ref& lhs, const any_optional_ref& rhs) noexcept
+    {
+      return lhs.m_ptr == rhs.m_ptr && lhs.m_token == rhs.m_token;
+    }
+
+    /**
+     * Checks whether two refs do not refer to the same object as the same type.
+     *
+     * @param lhs a ref.
+     * @param rhs a ref.
+     * @return whether the refs are not equal.
+     */
+    GCH_NODISCARD friend constexpr
+    bool
+    operator!= (const any_optional_ref& lhs, const any_optional_ref& rhs) noexcept
+    {
+      return ! (lhs == rhs);
+    }
+
+    /**
+     * Gets a hash of the ref.
+     *
+     * @return a hash of the address of the referent.
+     */
+    GCH_NODISCARD
+    std::size_t
+    hash (void) const noexcept
+    {
+      return std::hash<void *> { } (m_ptr);
+    }
+
+  private:
+    // Whether the stored token is that of `T` with cv-qualifiers which are
+    // a subset of `cv`.
+    template <typename T>
+    constexpr
+    bool
+    holds_impl (std::size_t cv) const noexcept
+    {
+      return m_token == detail::any_optional_ref_type_id<T>::tokens + 0
+         ||  ((cv & 1U) != 0 && m_token == detail::any_optional_ref_type_id<T>::tokens + 1)
+         ||  ((cv & 2U) != 0 && m_token == detail::any_optional_ref_type_id<T>::tokens + 2)
+         ||  (cv == 3U       && m_token == detail::any_optional_ref_type_id<T>::tokens + 3);
+    }
+
+    void       *m_ptr   = nullptr;
+    type_token  m_token = nullptr;
+  };
+
+} // namespace gch
+
+namespace std
+{
+
+  /**
+   * A specialization of `std::hash` for `gch::any_optional_ref`.
+   */
+  template <>
+  struct hash<gch::any_optional_ref>
+  {
+    /**
+     * An invocable operator.
+     *
+     * @param ref a ref.
+     * @return a hash of the argument.
+     */
+    std::size_t
+    operator() (const gch::any_optional_ref& ref) const noexcept
+    {
+      return ref.hash ();
+    }
+  };
+
+} // namespace std
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_OPTIONAL_REF_ANY_OPTIONAL_REF_HPP
@@ -0,0 +1,328 @@
+/** by_address.hpp
+ * Defines `for_each_by_address`, which visits the referents of a batch of
+ * `optional_ref`s in the order of their addresses.
+ *
+ * Visiting referents which are scattered across the heap in memory order
+ * (or at least page by page) reduces cache and TLB misses. The order is
+ * computed with an LSD radix sort of the addresses, which skips the digits
+ * shared by every address.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_OPTIONAL_REF_BY_ADDRESS_HPP
+#define GCH_OPTIONAL_REF_BY_ADDRESS_HPP
+
+#include "core.hpp"
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined (__has_include) && __has_include (<span>)
+#  include <span>
+#endif
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * The shift for grouping addresses by 4 KiB page.
+   */
+  GCH_INLINE_VARIABLE constexpr
+  unsigned
+  page_shift_4k = 12;
+
+  /**
+   * The shift for grouping addresses by 2 MiB page.
+   */
+  GCH_INLINE_VARIABLE constexpr
+  unsigned
+  page_shift_2m = 21;
+
+} // namespace gch
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    struct address_order_entry
+    {
+      std::uintptr_t key;
+      std::size_t    index;
+    };
+
+    // The key of an address. Shifting by the width of the address or more is
+    // undefined, so such a shift puts every address in the same page.
+    constexpr
+    std::uintptr_t
+    address_page (std::uintptr_t address, unsigned page_shift) noexcept
+    {
+      return page_shift < sizeof (std::uintptr_t) * CHAR_BIT ? address >> page_shift : 0;
+    }
+
+    // Sorts the `n` entries at `entries` by key, using the `n` entries at
+    // `buffer` as scratch space. The sort is stable.
+    // Returns whichever of the two arrays holds the sorted entries.
+    inline
+    address_order_entry *
+    address_radix_sort (address_order_entry *entries, address_order_entry *buffer,
+                        std::size_t n) noexcept
+    {
+      constexpr unsigned    radix_bits = 11;
+      constexpr std::size_t radix      = std::size_t { 1 } << radix_bits;
+      constexpr unsigned    key_bits   = sizeof (std::uintptr_t) * CHAR_BIT;
+      constexpr unsigned    passes     = (key_bits + radix_bits - 1) / radix_bits;
+
+      if (n < 2)
+        return entries;
+
+      for (unsigned pass = 0; pass < passes; ++pass)
+      {
+        const unsigned shift = pass * radix_bits;
+
+        std::size_t bucket[radix] = { };
+        for (std::size_t i = 0; i < n; ++i)
+          ++bucket[(entries[i].key >> shift) & (radix - 1)];
+
+        // Skip digits which are shared by every key.
+        if (bucket[(entries[0].key >> shift) & (radix - 1)] == n)
+          continue;
+
+        std::size_t offset = 0;
+        for (std::size_t digit = 0; digit < radix; ++digit)
+        {
+          std::size_t count = bucket[digit];
+          bucket[digit] = offset;
+          offset += count;
+        }
+
+        for (std::size_t i = 0; i < n; ++i)
+          buffer[bucket[(entries[i].key >> shift) & (radix - 1)]++] = entries[i];
+
+        std::swap (entries, buffer);
+      }
+      return entries;
+    }
+
+    struct address_order_range
+    {
+      const address_order_entry *
+      begin (void) const noexcept
+      {
+        return first;
+      }
+
+      const address_order_entry *
+      end (void) const noexcept
+      {
+        return last;
+      }
+
+      const address_order_entry *first;
+      const address_order_entry *last;
+    };
+
+    // Sorts the non-empty references in `[first, last)` by address. The
+    // entries and the buffer of the sort share `scratch`, which is the only
+    // allocation.
+    template <typename T>
+    address_order_range
+    sort_by_address (const optional_ref<T> *first, const optional_ref<T> *last,
+                     unsigned page_shift, std::vector<address_order_entry>& scratch)
+    {
+      const std::size_t n = static_cast<std::size_t> (last - first);
+      scratch.resize (2 * n);
+
+      std::size_t count = 0;
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        if (first[i].has_value ())
+        {
+          std::uintptr_t address = reinterpret_cast<std::uintptr_t> (first[i].get_pointer ());
+          scratch[count++] = { address_page (address, page_shift), i };
+        }
+      }
+
+      const address_order_entry *sorted
+        = address_radix_sort (scratch.data (), scratch.data () + count, count);
+      return { sorted, sorted + count };
+    }
+
+  }
+
+} // namespace gch
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * Computes the order in which to visit the referents of a batch of
+   * `optional_ref`s so that their addresses are ascending.
+   *
+   * Empty `optional_ref`s are left out. If `page_shift` is nonzero, the
+   * addresses are only ordered by page, and references into the same page
+   * keep their relative order. A `page_shift` of at least the width of an
+   * address puts every reference in the same page.
+   *
+   * @tparam T the value type of the `optional_ref`s.
+   * @param first a pointer to the first `optional_ref`.
+   * @param last a pointer past the last `optional_ref`.
+   * @param page_shift the base-2 logarithm of the page size (for example,
+   *                   `page_shift_4k`), or `0` to fully order the addresses.
+   * @return the indices of the non-empty references, relative to `first`,
+   *         in the order of their addresses.
+   */
+  template <typename T>
+  GCH_NODISCARD
+  std::vector<std::size_t>
+  address_order (const optional_ref<T> *first, const optional_ref<T> *last,
+                 unsigned page_shift = 0)
+  {
+    std::vector<detail::address_order_entry> scratch;
+    detail::address_order_range sorted = detail::sort_by_address (first, last, page_shift,
+                                                                  scratch);
+
+    std::vector<std::size_t> indices;
+    indices.reserve (static_cast<std::size_t> (sorted.end () - sorted.begin ()));
+    for (const detail::address_order_entry& e : sorted)
+      indices.push_back (e.index);
+    return indices;
+  }
+
+  /**
+   * Invokes a function on the referents of a batch of `optional_ref`s
+   * in the order of their addresses.
+   *
+   * @tparam T the value type of the `optional_ref`s.
+   * @tparam Function a type invocable with `T&`.
+   * @param first a pointer to the first `optional_ref`.
+   * @param last a pointer past the last `optional_ref`.
+   * @param f the function.
+   * @param page_shift the base-2 logarithm of the page size by which to group
+   *                   the addresses, or `0` to fully order the addresses.
+   * @return `f`.
+   *
+   * @see gch::address_order
+   */
+  template <typename T, typename Function>
+  Function
+  for_each_by_address (const optional_ref<T> *first, const optional_ref<T> *last, Function f,
+                       unsigned page_shift = 0)
+  {
+    std::vector<detail::address_order_entry> scratch;
+    for (const detail::address_order_entry& e
+           : detail::sort_by_address (first, last, page_shift, scratch))
+    {
+      f (*first[e.index]);
+    }
+    return f;
+  }
+
+  /**
+   * Invokes a function on the referents of a batch of `optional_ref`s in
+   * the order of their addresses, along with their index in the batch.
+   *
+   * The index can be used to scatter results back into the original order.
+   *
+   * @tparam T the value type of the `optional_ref`s.
+   * @tparam Function a type invocable with `T&` and `std::size_t`.
+   * @param first a pointer to the first `optional_ref`.
+   * @param last a pointer past the last `optional_ref`.
+   * @param f the function.
+   * @param page_shift the base-2 logarithm of the page size by which to group
+   *                   the addresses, or `0` to fully order the addresses.
+   * @return `f`.
+   *
+   * @see gch::address_order
+   */
+  template <typename T, typename Function>
+  Function
+  for_each_by_address_indexed (const optional_ref<T> *first, const optional_ref<T> *last,
+                               Function f, unsigned page_shift = 0)
+  {
+    std::vector<detail::address_order_entry> scratch;
+    for (const detail::address_order_entry& e
+           : detail::sort_by_address (first, last, page_shift, scratch))
+    {
+      f (*first[e.index], e.index);
+    }
+    return f;
+  }
+
+#if defined (__cpp_lib_span) && __cpp_lib_span >= 202002L
+
+  /**
+   * Computes the order in which to visit the referents of a span
+   * of `optional_ref`s so that their addresses are ascending.
+   *
+   * @see gch::address_order
+   */
+  template <typename OptionalRef, std::size_t Extent,
+            typename std::enable_if<
+              is_optional_ref<typename std::remove_const<OptionalRef>::type>::value
+            >::type * = nullptr>
+  GCH_NODISCARD
+  std::vector<std::size_t>
+  address_order (std::span<OptionalRef, Extent> refs, unsigned page_shift = 0)
+  {
+    return address_order (refs.data (), refs.data () + refs.size (), page_shift);
+  }
+
+  /**
+   * Invokes a function on the referents of a span of `optional_ref`s
+   * in the order of their addresses.
+   *
+   * @see gch::for_each_by_address
+   */
+  template <typename OptionalRef, std::size_t Extent, typename Function,
+            typename std::enable_if<
+              is_optional_ref<typename std::remove_const<OptionalRef>::type>::value
+            >::type * = nullptr>
+  Function
+  for_each_by_address (std::span<OptionalRef, Extent> refs, Function f, unsigned page_shift = 0)
+  {
+    return for_each_by_address (refs.data (), refs.data () + refs.size (), std::move (f),
+                                page_shift);
+  }
+
+  /**
+   * Invokes a function on the referents of a span of `optional_ref`s in
+   * the order of their addresses, along with their index in the span.
+   *
+   * @see gch::for_each_by_address_indexed
+   */
+  template <typename OptionalRef, std::size_t Extent, typename Function,
+            typename std::enable_if<
+              is_optional_ref<typename std::remove_const<OptionalRef>::type>::value
+            >::type * = nullptr>
+  Function
+  for_each_by_address_indexed (std::span<OptionalRef, Extent> refs, Function f,
+                               unsigned page_shift = 0)
+  {
+    return for_each_by_address_indexed (refs.data (), refs.data () + refs.size (),
+                                        std::move (f), page_shift);
+  }
+
+#endif
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_OPTIONAL_REF_BY_ADDRESS_HPP
@@ -0,0 +1,340 @@
+/** cached_cast.hpp
+ * Defines `maybe_cast_cached`, a `maybe_cast` which memoizes the results of
+ * `dynamic_cast` by the virtual table pointer of the source object.
+ *
+ * In the Itanium C++ ABI (used by GCC and Clang outside of Windows), a
+ * polymorphic subobject begins with its virtual table pointer, and each
+ * subobject of each dynamic type has its own virtual table, which holds a
+ * pointer to the type's `type_info` and so is never folded with that of
+ * another type. The pointer therefore determines the offset from the source
+ * to the result of the cast, or that the cast fails. A small cache of these
+ * offsets is kept for each `(From, To, Tag)` combination, so a call site
+ * which only sees a few dynamic types skips the RTTI walk after the first
+ * cast of each type.
+ *
+ * This does not hold for the MSVC ABI. There, a polymorphic class may begin
+ * with a virtual base table pointer instead, and identical virtual base
+ * tables of different classes may be folded by the linker. On ABIs other than
+ * Itanium, the casts are plain `dynamic_cast`s and nothing is cached.
+ *
+ * `maybe_cast_cached` keeps a cache in each thread. `maybe_cast_cached_atomic`
+ * keeps one cache which is shared by every thread.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_OPTIONAL_REF_CACHED_CAST_HPP
+#define GCH_OPTIONAL_REF_CACHED_CAST_HPP
+
+#include "core.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined (__GXX_ABI_VERSION) && ! defined (_MSC_VER)
+#  ifndef GCH_ITANIUM_ABI
+#    define GCH_ITANIUM_ABI
+#  endif
+#endif
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    // The number of dynamic types remembered by each cache.
+    GCH_INLINE_VARIABLE constexpr
+    std::size_t
+    cast_cache_ways = 4;
+
+    // The offset recorded for a failed cast.
+    GCH_INLINE_VARIABLE constexpr
+    std::ptrdiff_t
+    cast_cache_failure = PTRDIFF_MIN;
+
+    struct cast_cache_entry
+    {
+      const void     *vptr;
+      std::ptrdiff_t  offset;
+    };
+
+    // A cache for use by a single thread. Each thread has its own.
+    class cast_cache
+    {
+    public:
+      bool
+      find (const void *vptr, std::ptrdiff_t& offset) const noexcept
+      {
+        for (const cast_cache_entry& e : m_entries)
+        {
+          if (e.vptr == vptr)
+          {
+            offset = e.offset;
+            return true;
+          }
+        }
+        return false;
+      }
+
+      void
+      insert (const void *vptr, std::ptrdiff_t offset) noexcept
+      {
+        m_entries[m_next] = { vptr, offset };
+        m_next = (m_next + 1) % cast_cache_ways;
+      }
+
+    private:
+      cast_cache_entry m_entries[cast_cache_ways] { };
+      std::size_t      m_next = 0;
+    };
+
+    // A cache which may be shared by threads. Each entry is guarded by a
+    // sequence lock. Writers which find an entry locked give up instead of
+    // waiting, since the cache is only an optimization.
+    class atomic_cast_cache
+    {
+      struct entry
+      {
+        std::atomic<unsigned>       sequence;
+        std::atomic<const void *>   vptr;
+        std::atomic<std::ptrdiff_t> offset;
+      };
+
+    public:
+      bool
+      find (const void *vptr, std::ptrdiff_t& offset) const noexcept
+      {
+        for (const entry& e : m_entries)
+        {
+          unsigned sequence = e.sequence.load (std::memory_order_acquire);
+          const void *entry_vptr = e.vptr.load (std::memory_order_relaxed);
+          std::ptrdiff_t entry_offset = e.offset.load (std::memory_order_relaxed);
+          std::atomic_thread_fence (std::memory_order_acquire);
+
+          if (entry_vptr == vptr
+              &&  (sequence & 1U) == 0
+              &&  e.sequence.load (std::memory_order_relaxed) == sequence)
+          {
+            offset = entry_offset;
+            return true;
+          }
+        }
+        return false;
+      }
+
+      void
+      insert (const void *vptr, std::ptrdiff_t offset) noexcept
+      {
+        entry& e = m_entries[m_next.fetch_add (1, std::memory_order_relaxed) % cast_cache_ways];
+
+        unsigned sequence = e.sequence.load (std::memory_order_relaxed);
+        if ((sequence & 1U) != 0
+            ||! e.sequence.compare_exchange_strong (sequence, sequence + 1,
+                                                    std::memory_order_relaxed))
+        {
+          return;
+        }
+        std::atomic_thread_fence (std::memory_order_release);
+
+        e.vptr.store (vptr, std::memory_order_relaxed);
+        e.offset.store (offset, std::memory_order_relaxed);
+        e.sequence.store (sequence + 2, std::memory_order_release);
+      }
+
+    private:
+      entry                    m_entries[cast_cache_ways];
+      std::atomic<std::size_t> m_next;
+    };
+
+    // One cache for each combination. The caches are constant-initialized
+    // and trivially destructible, so there is no guard on their first use.
+    template <typename Cache, typename T, typename U, typename Tag>
+    struct cast_cache_storage
+    {
+      static
+      Cache&
+      get (void) noexcept
+      {
+        static Cache cache;
+        return cache;
+      }
+    };
+
+    template <typename T, typename U, typename Tag>
+    struct cast_cache_storage<cast_cache, T, U, Tag>
+    {
+      static
+      cast_cache&
+      get (void) noexcept
+      {
+        static thread_local cast_cache cache;
+        return cache;
+      }
+    };
+
+    template <typename T, typename Tag, typename Cache, typename U>
+    T *
+    cached_cast_pointer (U *ptr) noexcept
+    {
+      static_assert (std::is_polymorphic<U>::value,
+                     "The source of a cached cast must be polymorphic.");
+
+#ifndef GCH_ITANIUM_ABI
+      return dynamic_cast<T *> (ptr);
+#else
+      using byte = typename std::conditional<std::is_const<U>::value, const char, char>::type;
+
+      if (ptr == nullptr)
+        return nullptr;
+
+      const void *vptr;
+      std::memcpy (&vptr, static_cast<const void *> (ptr), sizeof (vptr));
+
+      Cache& cache = cast_cache_storage<Cache,
+                                        typename std::remove_cv<T>::type,
+                                        typename std::remove_cv<U>::type,
+                                        Tag>::get ();
+
+      std::ptrdiff_t offset;
+      if (cache.find (vptr, offset))
+      {
+        if (offset == cast_cache_failure)
+          return nullptr;
+        return reinterpret_cast<T *> (reinterpret_cast<byte *> (ptr) + offset);
+      }
+
+      T *result = dynamic_cast<T *> (ptr);
+      cache.insert (vptr, result == nullptr
+                          ? cast_cache_failure
+                          : reinterpret_cast<byte *> (result) - reinterpret_cast<byte *> (ptr));
+      return result;
+#endif
+    }
+
+  }
+
+} // namespace gch
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * Performs a `dynamic_cast` on the referent of an `optional_ref`, caching
+   * the result by the dynamic type of the referent.
+   *
+   * The cache is shared by every call in a thread with the same `T`, `U`, and
+   * `Tag`. Each thread has its own cache, so this may be called from any
+   * thread. Use a distinct `Tag` type to give a call site its own cache.
+   * Nothing is cached unless the target uses the Itanium C++ ABI.
+   *
+   * @tparam T the target value type of the `dynamic_cast`.
+   * @tparam Tag a type which selects the cache.
+   * @tparam U a polymorphic value type.
+   * @param opt an `optional_ref`.
+   * @return the result of the `dynamic_cast` wrapped into an `optional_ref`.
+   *
+   * @see gch::maybe_cast
+   * @see gch::maybe_cast_cached_atomic
+   */
+  template <typename T, typename Tag = void, typename U>
+  inline
+  optional_ref<T>
+  maybe_cast_cached (optional_ref<U> opt) noexcept
+  {
+    return optional_ref<T> {
+      detail::cached_cast_pointer<T, Tag, detail::cast_cache> (opt.get_pointer ())
+    };
+  }
+
+  /**
+   * Performs a `dynamic_cast` on the referent of an `optional_ref`, caching
+   * the result by the dynamic type of the referent.
+   *
+   * Note: const-qualification is not necessary for `T`.
+   *
+   * @tparam T the target value type of the `dynamic_cast`.
+   * @tparam Tag a type which selects the cache.
+   * @tparam U a polymorphic value type.
+   * @param opt an `optional_ref`.
+   * @return the result of the `dynamic_cast` wrapped into an `optional_ref`.
+   *
+   * @see gch::maybe_cast_cached
+   */
+  template <typename T, typename Tag = void, typename U>
+  inline
+  optional_ref<const T>
+  maybe_cast_cached (optional_ref<const U> opt) noexcept
+  {
+    return optional_ref<const T> {
+      detail::cached_cast_pointer<const T, Tag, detail::cast_cache> (opt.get_pointer ())
+    };
+  }
+
+  /**
+   * Performs a `dynamic_cast` on the referent of an `optional_ref`, caching
+   * the result by the dynamic type of the referent.
+   *
+   * This is the same as `maybe_cast_cached`, except that one cache is shared
+   * by every thread, so a dynamic type only misses once in the process.
+   *
+   * @tparam T the target value type of the `dynamic_cast`.
+   * @tparam Tag a type which selects the cache.
+   * @tparam U a polymorphic value type.
+   * @param opt an `optional_ref`.
+   * @return the result of the `dynamic_cast` wrapped into an `optional_ref`.
+   *
+   * @see gch::maybe_cast_cached
+   */
+  template <typename T, typename Tag = void, typename U>
+  inline
+  optional_ref<T>
+  maybe_cast_cached_atomic (optional_ref<U> opt) noexcept
+  {
+    return optional_ref<T> {
+      detail::cached_cast_pointer<T, Tag, detail::atomic_cast_cache> (opt.get_pointer ())
+    };
+  }
+
+  /**
+   * Performs a `dynamic_cast` on the referent of an `optional_ref`, caching
+   * the result by the dynamic type of the referent.
+   *
+   * Note: const-qualification is not necessary for `T`.
+   *
+   * @tparam T the target value type of the `dynamic_cast`.
+   * @tparam Tag a type which selects the cache.
+   * @tparam U a polymorphic value type.
+   * @param opt an `optional_ref`.
+   * @return the result of the `dynamic_cast` wrapped into an `optional_ref`.
+   *
+   * @see gch::maybe_cast_cached_atomic
+   */
+  template <typename T, typename Tag = void, typename U>
+  inline
+  optional_ref<const T>
+  maybe_cast_cached_atomic (optional_ref<const U> opt) noexcept
+  {
+    return optional_ref<const T> {
+      detail::cached_cast_pointer<const T, Tag, detail::atomic_cast_cache> (opt.get_pointer ())
+    };
+  }
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_OPTIONAL_REF_CACHED_CAST_HPP
@@ -0,0 +1,367 @@
+/** cast.hpp
+ * Defines `maybe_cast` for `optional_ref`.
+ *
+ * Downcasts use `dynamic_cast` unless the target type has a `classof`
+ * predicate (see `cast_traits`), in which case they are a test and a
+ * `static_cast`, and do not require RTTI.
+ *
+ * Copyright © 2019 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_OPTIONAL_REF_CAST_HPP
+#define GCH_OPTIONAL_REF_CAST_HPP
+
+#include "core.hpp"
+
+#include <type_traits>
+#include <utility>
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * A customization point for `maybe_cast` to the type `T`.
+   *
+   * Specializations may define a static member function
+   *
+   *     static bool classof (const Base& b) noexcept;
+   *
+   * which returns whether `b` is a base subobject of a `T`. `maybe_cast<T>`
+   * then checks `classof` and uses `static_cast` in place of `dynamic_cast`,
+   * so it works without RTTI. If there is no specialization, a static member
+   * function `T::classof (const Base&)` is used if it exists.
+   *
+   * @tparam T the target value type of a `maybe_cast`.
+   * @tparam Enable a parameter for use with `std::enable_if`.
+   *
+   * @see gch::kind_range_cast_traits
+   */
+  template <typename T, typename Enable = void>
+  struct cast_traits
+  { };
+
+} // namespace gch
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    template <typename U>
+    constexpr
+    auto
+    get_cast_kind (const U& u)
+      noexcept (noexcept (u.kind ()))
+      -> decltype (u.kind ())
+    {
+      return u.kind ();
+    }
+
+    template <typename U>
+    constexpr
+    auto
+    get_cast_kind (const U& u) noexcept
+      -> decltype (u.kind)
+    {
+      return u.kind;
+    }
+
+    template <typename Kind, typename Enable = void>
+    struct cast_kind_unsigned
+      : std::make_unsigned<Kind>
+    { };
+
+    template <typename Kind>
+    struct cast_kind_unsigned<Kind, typename std::enable_if<std::is_enum<Kind>::value>::type>
+      : std::make_unsigned<typename std::underlying_type<Kind>::type>
+    { };
+
+  }
+
+} // namespace gch
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * A base for specializations of `cast_traits` in hierarchies which tag
+   * each object with a kind, and give each class a contiguous range of kinds
+   * (its own and those of its derived classes).
+   *
+   * The kind is read from `b.kind ()` or, failing that, from a data member
+   * `b.kind`. The range check is a subtraction and a single comparison.
+   *
+   *     template <>
+   *     struct gch::cast_traits<shape>
+   *       : gch::kind_range_cast_traits<kind, kind::first_shape, kind::last_shape>
+   *     { };
+   *
+   * @tparam Kind an integral or enumeration type.
+   * @tparam First the first kind in the range.
+   * @tparam Last the last kind in the range.
+   */
+  template <typename Kind, Kind First, Kind Last = First>
+  struct kind_range_cast_traits
+  {
+    static_assert (std::is_integral<Kind>::value || std::is_enum<Kind>::value,
+                   "The kind must be an integral or enumeration type.");
+
+    using kind_type = Kind; /*!< The type of the kinds */
+
+    static constexpr Kind first_kind = First; /*!< The first kind in the range */
+    static constexpr Kind last_kind  = Last;  /*!< The last kind in the range  */
+
+    /**
+     * Checks whether the kind of `b` is in the range `[First, Last]`.
+     *
+     * @tparam U the type of `b`.
+     * @param b an object with a kind.
+     * @return whether the kind of `b` is in the range.
+     */
+    template <typename U>
+    GCH_NODISCARD static constexpr
+    bool
+    classof (const U& b) noexcept
+    {
+      using unsigned_type = typename detail::cast_kind_unsigned<Kind>::type;
+      return static_cast<unsigned_type> (static_cast<unsigned_type> (detail::get_cast_kind (b))
+                                       - static_cast<unsigned_type> (First))
+          <= static_cast<unsigned_type> (static_cast<unsigned_type> (Last)
+                                       - static_cast<unsigned_type> (First));
+    }
+  };
+
+} // namespace gch
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    template <typename T, typename U, typename Enable = void>
+    struct has_traits_classof
+      : std::false_type
+    { };
+
+    template <typename T, typename U>
+    struct has_traits_classof<
+      T, U, decltype (static_cast<void> (cast_traits<T>::classof (std::declval<const U&> ())))>
+      : std::true_type
+    { };
+
+    template <typename T, typename U, typename Enable = void>
+    struct has_member_classof
+      : std::false_type
+    { };
+
+    template <typename T, typename U>
+    struct has_member_classof<
+      T, U, decltype (static_cast<void> (T::classof (std::declval<const U&> ())))>
+      : std::true_type
+    { };
+
+    struct implicit_cast_tag { };
+    struct traits_classof_cast_tag { };
+    struct member_classof_cast_tag { };
+    struct dynamic_cast_tag { };
+
+    // Upcasts are implicit. Downcasts prefer `cast_traits`, then `T::classof`.
+    // Everything else, such as a cross-cast, is a `dynamic_cast`, since the
+    // `classof` paths end in a `static_cast`.
+    template <typename T, typename U,
+              typename V = typename std::remove_cv<T>::type,
+              typename W = typename std::remove_cv<U>::type>
+    using cast_tag = typename std::conditional<
+      std::is_convertible<U *, T *>::value,
+      implicit_cast_tag,
+      typename std::conditional<
+        std::is_base_of<W, V>::value && has_traits_classof<V, W>::value,
+        traits_classof_cast_tag,
+        typename std::conditional<
+          std::is_base_of<W, V>::value && has_member_classof<V, W>::value,
+          member_classof_cast_tag,
+          dynamic_cast_tag>::type>::type>::type;
+
+    template <typename T, typename U>
+    constexpr
+    T *
+    cast_pointer (U *ptr, implicit_cast_tag) noexcept
+    {
+      return ptr;
+    }
+
+    template <typename T, typename U>
+    constexpr
+    T *
+    cast_pointer (U *ptr, traits_classof_cast_tag) noexcept
+    {
+      return (ptr != nullptr && cast_traits<typename std::remove_cv<T>::type>::classof (*ptr))
+           ? static_cast<T *> (ptr)
+           : nullptr;
+    }
+
+    template <typename T, typename U>
+    constexpr
+    T *
+    cast_pointer (U *ptr, member_classof_cast_tag) noexcept
+    {
+      return (ptr != nullptr && std::remove_cv<T>::type::classof (*ptr))
+           ? static_cast<T *> (ptr)
+           : nullptr;
+    }
+
+    template <typename T, typename U>
+    inline
+    T *
+    cast_pointer (U *ptr, dynamic_cast_tag) noexcept
+    {
+      return dynamic_cast<T *> (ptr);
+    }
+
+  }
+
+} // namespace gch
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * Casts the pointer and converts the result to an `optional_ref`.
+   *
+   * Downcasts use `cast_traits<T>::classof` or `T::classof` if either
+   * exists, and `dynamic_cast` otherwise. Casts between types which are not
+   * bases of one another always use `dynamic_cast`.
+   *
+   * Note: There is no use case of `U = S *` because `S *` cannot
+   *       be a polymorphic object, so these pointer cases are fine.
+   *
+   * @tparam T the target value type of the cast.
+   * @tparam U the value type of the input pointer
+   * @param ptr a pointer
+   * @return the result of the cast wrapped into an `optional_ref`.
+   *
+   * @see gch::cast_traits
+   */
+  template <typename T, typename U>
+  inline
+  optional_ref<T>
+  maybe_cast (U *ptr) noexcept
+  {
+    return optional_ref<T> { detail::cast_pointer<T> (ptr, detail::cast_tag<T, U> { }) };
+  }
+
+  /**
+   * Casts the pointer and converts the result to an `optional_ref`.
+   *
+   * Note: const-qualification is not necessary for `T`.
+   *
+   * @tparam T the target value type of the cast.
+   * @tparam U the value type of the input pointer
+   * @param ptr a pointer
+   * @return the result of the cast wrapped into an `optional_ref`.
+   *
+   * @see gch::cast_traits
+   */
+  template <typename T, typename U>
+  inline
+  optional_ref<const T>
+  maybe_cast (const U *ptr) noexcept
+  {
+    return optional_ref<const T> {
+      detail::cast_pointer<const T> (ptr, detail::cast_tag<const T, const U> { })
+    };
+  }
+
+  /**
+   * Casts the reference and converts the result to an `optional_ref`.
+   *
+   * @tparam T the target value type of the cast.
+   * @tparam U the value type of the input pointer
+   * @param ref a polymorphic reference
+   * @return the result of the cast wrapped into an `optional_ref`.
+   */
+  template <typename T, typename U>
+  inline
+  optional_ref<T>
+  maybe_cast (U& ref) noexcept
+  {
+    return maybe_cast<T> (&ref);
+  }
+
+  /**
+   * Casts the reference and converts the result to an `optional_ref`.
+   *
+   * Note: const-qualification is not necessary for `T`.
+   *
+   * @tparam T the target value type of the cast.
+   * @tparam U the value type of the input pointer
+   * @param ref a polymorphic reference
+   * @return the result of the cast wrapped into an `optional_ref`.
+   */
+  template <typename T, typename U>
+  inline
+  optional_ref<const T>
+  maybe_cast (const U& ref) noexcept
+  {
+    return maybe_cast<T> (&ref);
+  }
+
+  /**
+   * A deleted version for rvalue-references (since
+   * `optional_ref`s cannot hold rvalue-references).
+   */
+  template <typename T, typename U>
+  void
+  maybe_cast (const U&&) = delete;
+
+  /**
+   * Forwards the pointer held by an `optional_ref` to `maybe_cast`.
+   *
+   * @tparam T the target value type of the cast.
+   * @tparam U the value type of the input pointer
+   * @param opt an `optional_ref` which refers to a polymorphic type.
+   * @return the result of a `maybe_cast` performed on the pointer stored by `opt`.
+   */
+  template <typename T, typename U>
+  inline
+  optional_ref<T>
+  maybe_cast (optional_ref<U> opt) noexcept
+  {
+    return maybe_cast<T> (opt.get_pointer ());
+  }
+
+  /**
+   * Forwards the pointer held by an `optional_ref` to `maybe_cast`.
+   *
+   * Note: const-qualification is not necessary for `T`.
+   *
+   * @tparam T the target value type of the cast.
+   * @tparam U the value type of the input pointer
+   * @param opt an `optional_ref` which refers to a const polymorphic type.
+   * @return the result of a `maybe_cast` performed on the pointer stored by `opt`.
+   */
+  template <typename T, typename U>
+  inline
+  optional_ref<const T>
+  maybe_cast (optional_ref<const U> opt) noexcept
+  {
+    return maybe_cast<T> (opt.get_pointer ());
+  }
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_OPTIONAL_REF_CAST_HPP
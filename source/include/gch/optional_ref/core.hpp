@@ -0,0 +1,1943 @@
+/** core.hpp
+ * Defines `optional_ref`, `nullopt`, and the comparison operators.
+ *
+ * Copyright © 2019 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_OPTIONAL_REF_CORE_HPP
+#define GCH_OPTIONAL_REF_CORE_HPP
+
+#include "../optional_ref_fwd.hpp"
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#ifdef GCH_EXCEPTIONS
+#  include <exception>
+#else
+#  include <cstdio>
+#  include <cstdlib>
+#endif
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * A struct that provides semantics for
+   * empty `optional_ref`s.
+   */
+  struct nullopt_t
+  {
+  private:
+    /**
+     * A tag type used to create `nullopt`.
+     */
+    struct create_tag
+    {
+      /**
+       * An explicit constructor to prevent initialization of `nullopt_t`
+       * with expressions like `nullopt_t { { } }`.
+       */
+      explicit create_tag (void) = default;
+    };
+
+  public:
+    /**
+     * A tag variable used to create `nullopt`.
+     */
+    static constexpr
+    create_tag
+    create { };
+
+    /**
+     * A tagged constructor.
+     */
+    constexpr explicit
+    nullopt_t (create_tag) noexcept
+    { }
+  };
+
+  /**
+   * The global inline variable instantiation for `nullopt_t`.
+   */
+  GCH_INLINE_VARIABLE constexpr
+  nullopt_t
+  nullopt { nullopt_t::create };
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wweak-vtables" // Ignore warnings about virtual methods.
+#endif
+
+#ifdef GCH_EXCEPTIONS
+
+  /**
+   * An exception class for cases of bad access
+   * to an `optional_ref`.
+   */
+  class bad_optional_access
+    : public std::exception
+  {
+  public:
+    /**
+     * A default constructor.
+     */
+    bad_optional_access (void) = default;
+
+    /**
+     * A copy constructor.
+     */
+    bad_optional_access (const bad_optional_access&) = default;
+
+    /**
+     * A move constructor.
+     */
+    bad_optional_access (bad_optional_access&&) noexcept = default;
+
+    /**
+     * A copy-assignment operator.
+     *
+     * @return a reference to the object.
+     */
+    bad_optional_access& operator= (const bad_optional_access&) = default;
+
+    /**
+     * A move-assignment operator.
+     *
+     * @return a reference to the object.
+     */
+    bad_optional_access& operator= (bad_optional_access&&) noexcept = default;
+
+    /**
+     * A destructor.
+     */
+    ~bad_optional_access (void) noexcept override = default;
+
+    /**
+     * Returns an error string.
+     *
+     * @return the error string.
+     */
+    GCH_NODISCARD
+    const char *
+    what (void) const noexcept override
+    {
+      return "Cannot access the reference of an empty optional_ref.";
+    }
+  };
+
+#endif
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+  /**
+   * The type of a handler called on access to the value of an empty `optional_ref`.
+   */
+  using bad_optional_access_handler = void (*) (void);
+
+} // namespace gch
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    inline
+    bad_optional_access_handler&
+    bad_optional_access_handler_storage (void) noexcept
+    {
+      static bad_optional_access_handler handler = nullptr;
+      return handler;
+    }
+
+  }
+
+} // namespace gch
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * Returns the current handler for bad accesses.
+   *
+   * @return the current handler, or `nullptr` if none is set.
+   *
+   * @see gch::set_bad_optional_access_handler
+   */
+  inline
+  bad_optional_access_handler
+  get_bad_optional_access_handler (void) noexcept
+  {
+    return detail::bad_optional_access_handler_storage ();
+  }
+
+  /**
+   * Sets a handler called on access to the value of an empty `optional_ref`.
+   *
+   * The handler is called by `optional_ref::value` before the default
+   * behavior, which is to throw `bad_optional_access` (or print a message and
+   * call `std::abort` if exceptions are disabled). If the handler returns, the
+   * default behavior follows. This is intended for routing failures to a crash
+   * reporter.
+   *
+   * Note: The handler is not synchronized, so it should be set before any
+   * concurrent use of `optional_ref`.
+   *
+   * @param handler a handler, or `nullptr` to use only the default behavior.
+   * @return the previous handler.
+   *
+   * @see std::set_terminate
+   */
+  inline
+  bad_optional_access_handler
+  set_bad_optional_access_handler (bad_optional_access_handler handler) noexcept
+  {
+    bad_optional_access_handler prev = detail::bad_optional_access_handler_storage ();
+    detail::bad_optional_access_handler_storage () = handler;
+    return prev;
+  }
+
+} // namespace gch
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    // Kept out of line so that `optional_ref::value` only contains a test and a call.
+    [[noreturn]] GCH_COLD GCH_NOINLINE inline
+    void
+    bad_optional_access_failure (void)
+    {
+      if (bad_optional_access_handler handler = get_bad_optional_access_handler ())
+        handler ();
+
+#ifdef GCH_EXCEPTIONS
+      throw bad_optional_access { };
+#else
+      std::fprintf (
+        stderr,
+        "[gch::optional_ref] Cannot access the reference of an empty optional_ref.\n");
+      std::abort ();
+#endif
+    }
+
+  }
+
+} // namespace gch
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  template <typename T, typename F>
+  class lazy_transform;
+
+  /**
+   * A reference wrapper which provides semantics similar to `std::optional`.
+   *
+   * @tparam ValueType the value type of the stored reference.
+   */
+  template <typename ValueType>
+  class optional_ref
+  {
+  public:
+    static_assert(! std::is_reference<ValueType>::value,
+      "optional_ref expects a value type as a template argument, not a reference.");
+
+    using value_type      = ValueType;         /*!< The value type of the stored reference */
+    using reference       = ValueType&;        /*!< The reference type to be wrapped       */
+    using pointer         = ValueType *;       /*!< The pointer type to the value type     */
+    using const_reference = const ValueType&;  /*!< A constant reference to `ValueType`    */
+    using const_pointer   = const ValueType *; /*!< A constant pointer to `ValueType`      */
+
+  private:
+    template <typename U>
+    using constructible_from_pointer_to =
+      std::is_constructible<pointer, decltype (&std::declval<U&> ())>;
+
+    template <typename U>
+    using pointer_to_is_convertible =
+      std::is_convertible<decltype (&std::declval<U&> ()), pointer>;
+
+  public:
+    // For the record, I don't think the explicit conversions are even possible
+    // since we are only using raw pointers, but I can't find a definitive
+    // reference to that fact, so they stay.
+
+    /**
+     * Constructor
+     *
+     * A default constructor.
+     *
+     * The `optional_ref` has no value after default
+     * construction.
+     */
+    optional_ref (void) noexcept = default;
+
+    /**
+     * Constructor
+     *
+     * A copy constructor.
+     *
+     * If `other` contains a value, then that value
+     * is copied into `*this`.
+     *
+     * Note: TriviallyCopyable.
+     */
+    optional_ref (const optional_ref& other) noexcept = default;
+
+    /**
+     * Constructor
+     *
+     * A move constructor.
+     *
+     * If `other` contains a value, then that value
+     * is copied into `*this`. It is implementation
+     * defined if `other` contains a value after this.
+     *
+     * Note: TriviallyCopyable.
+     */
+    optional_ref (optional_ref&& other) noexcept = default;
+
+    /**
+     * Assignment operator
+     *
+     * A copy-assignment operator.
+     *
+     * The resultant state of `*this` is equivalent
+     * to that of `other`.
+     *
+     * Note: TriviallyCopyable.
+     *
+     * @return `*this`
+     */
+    optional_ref&
+    operator= (const optional_ref& other) noexcept = default;
+
+    /**
+     * Assignment operator
+     *
+     * A move-assignment operator.
+     *
+     * Sets the state of `*this` to that of `other`.
+     * It is implementation defined if `other` contains
+     * a value after this.
+     *
+     * Note: TriviallyCopyable.
+     *
+     * @return `*this`
+     */
+    optional_ref&
+    operator= (optional_ref&& other) noexcept = default;
+
+    /**
+     * Destructor
+     *
+     * A trivial destructor.
+     *
+     * Note: TriviallyCopyable.
+     *
+     */
+    ~optional_ref (void) noexcept = default;
+
+    /**
+     * Constructor
+     *
+     * A constructor to implicitly convert nullopt_t so we can
+     * use syntax like `optional_ref<int> x = nullopt`.
+     */
+    constexpr GCH_IMPLICIT_CONVERSION
+    optional_ref (nullopt_t) noexcept
+    { }
+
+    /**
+     * Constructor
+     *
+     * A converting constructor for types implicitly
+     * convertible to `pointer`. This is so we don't
+     * need to dereference or inspect pointers before
+     * creation; we can just use the pointer directly.
+     *
+     * @tparam Ptr a type implicitly convertible to `pointer`.
+     * @param ptr a pointer.
+     */
+    template <typename Ptr,
+              typename std::enable_if<std::is_constructible<pointer, Ptr>::value
+                                  &&  std::is_convertible<Ptr, pointer>::value>::type * = nullptr>
+    constexpr GCH_IMPLICIT_CONVERSION
+    optional_ref (Ptr&& ptr) noexcept
+      : m_ptr (std::forward<Ptr> (ptr))
+    { }
+
+    /**
+     * Constructor
+     *
+     * A converting constructor for types explicitly
+     * convertible to `pointer`. This is so we don't
+     * need to dereference or inspect pointers before
+     * creation; we can just use the pointer directly.
+     *
+     * @tparam Ptr a type explicitly convertible to `pointer`.
+     * @param ptr a pointer.
+     */
+    template <typename Ptr,
+              typename std::enable_if<std::is_constructible<pointer, Ptr>::value
+                                  &&! std::is_convertible<Ptr, pointer>::value>::type * = nullptr>
+    constexpr explicit
+    optional_ref (Ptr&& ptr) noexcept
+      : m_ptr (std::forward<Ptr> (ptr))
+    { }
+
+    /**
+     * Constructor
+     *
+     * A constructor for the case where `pointer`
+     * is constructible from `U *`.
+     *
+     * @tparam U a referenced value type.
+     * @param ref a reference where `pointer` is constructible from its pointer.
+     */
+    template <typename U,
+              typename std::enable_if<constructible_from_pointer_to<U>::value>::type * = nullptr>
+    constexpr explicit
+    optional_ref (U& ref) noexcept
+      : optional_ref (&ref)
+    { }
+
+    /**
+     * Constructor
+     *
+     * A deleted contructor for the case where `ref` is an rvalue reference.
+     */
+    template <typename U,
+              typename std::enable_if<constructible_from_pointer_to<U>::value>::type * = nullptr>
+    optional_ref (const U&&) = delete;
+
+    /**
+     * Constructor
+     *
+     * A copy constructor from another optional_ref for the case
+     * where `U *` is implicitly convertible to type `pointer`.
+     *
+     * @tparam U a referenced value type.
+     * @param other an optional_ref whose pointer is implicitly
+     *              convertible to type `pointer`.
+     */
+    template <typename U,
+              typename std::enable_if<std::is_constructible<pointer, U *>::value &&
+                                      std::is_convertible<U *, pointer>::value>::type * = nullptr>
+    constexpr GCH_IMPLICIT_CONVERSION
+    optional_ref (optional_ref<U> other) noexcept
+      : m_ptr (other.get_pointer ())
+    { }
+
+    /**
+     * Constructor
+     *
+     * A copy constructor from another optional_ref for the case
+     * where `pointer` is explicitly constructible from `U *`.
+     *
+     * @tparam U a referenced value type.
+     * @param other an optional_ref which contains a pointer from
+     *              which `pointer` may be explicitly constructed.
+     */
+    template <typename U,
+              typename std::enable_if<std::is_constructible<pointer, U *>::value
+                                  &&! std::is_convertible<U *, pointer>::value>::type * = nullptr>
+    constexpr explicit
+    optional_ref (optional_ref<U> other) noexcept
+      : m_ptr (other.get_pointer ())
+    { }
+
+    /**
+     * Returns a pointer representation of the reference.
+     *
+     * The pointer is the internal representation of the reference.
+     * This function never fails.
+     *
+     * @return a pointer representation of the reference.
+     */
+    GCH_NODISCARD constexpr
+    pointer
+    get_pointer (void) const noexcept
+    {
+      return m_ptr;
+    }
+
+    /**
+     * Returns the reference.
+     *
+     * Dereferences `nullptr` if `*this` has no value.
+     *
+     * @return the stored reference.
+     */
+    GCH_NODISCARD constexpr
+    reference
+    operator* (void) const noexcept
+    {
+      return *get_pointer ();
+    }
+
+    /**
+     * Returns a pointer to the value.
+     *
+     * Never fails. The return is forwarded from `get_component_pointer`.
+     *
+     * @return a pointer to the value.
+     */
+    GCH_NODISCARD constexpr
+    pointer
+    operator-> (void) const noexcept
+    {
+      return get_pointer ();
+    }
+
+    /**
+     * Checks if the `*this` contains a value.
+     *
+     * Internally, this is just a check against `nullptr`.
+     *
+     * @return whether this `*this` contains a value.
+     */
+    GCH_NODISCARD constexpr
+    bool
+    has_value (void) const noexcept
+    {
+      return m_ptr != nullptr;
+    }
+
+    /**
+     * Checks if the `*this` contains a value.
+     *
+     * The return is forwarded from `has_value ()`.
+     *
+     * @return whether this `*this` contains a value.
+     */
+    GCH_NODISCARD constexpr explicit
+    operator bool (void) const noexcept
+    {
+      return has_value ();
+    }
+
+    /**
+     * Returns the contained reference, while checking whether it exists.
+     *
+     * @throws bad_optional_access when `*this` does not contain a value.
+     *
+     * @see gch::set_bad_optional_access_handler
+     *
+     * @return the contained reference.
+     */
+    GCH_NODISCARD GCH_CPP14_CONSTEXPR
+    reference
+    value (void) const
+    {
+      if (! has_value ())
+        detail::bad_optional_access_failure ();
+      return *m_ptr;
+    }
+
+    /**
+     * Returns the value, or a default.
+     *
+     * Returns the value, or a specified default if `*this` does
+     * not contain a value.
+     *
+     * @tparam U a reference type convertible to `reference`.
+     * @param default_value the value returned if `*this`
+     *                      does not contain a value.
+     * @return the stored reference, or `default_value`
+     *         if `*this` does not contain a value.
+     */
+    template <typename U>
+    GCH_NODISCARD constexpr
+    reference
+    value_or (U& default_value) const noexcept
+    {
+      return has_value () ? *m_ptr : static_cast<reference> (default_value);
+    }
+
+    /**
+     * Returns the value, or a default.
+     *
+     * Returns the value, or a specified default if `*this`
+     * does not contain a value. In this case, the default
+     * is an rvalue reference of type `value_type`. Note that
+     * we're using temporary lifetime extension here, so
+     * don't use the return beyond the scope of the enclosing
+     * expression to this function call.
+     *
+     * @param default_value the value returned if `*this`
+     *                      does not contain a value.
+     * @return the stored reference, or `default_value`
+     *         if `*this` does not contain a value.
+     */
+    GCH_NODISCARD constexpr
+    const_reference
+    value_or (const value_type&& default_value) const noexcept
+    {
+      return has_value () ? *m_ptr : default_value;
+    }
+
+    /**
+     * A deleted version for convertible rvalue references.
+     *
+     * We can't return the converted temporary because
+     * its lifetime isn't extended.
+     */
+    template <typename U,
+              typename std::enable_if<constructible_from_pointer_to<U>::value>::type * = nullptr>
+    GCH_NODISCARD constexpr
+    const_reference
+    value_or (const U&& default_value) const noexcept = delete;
+
+    /**
+     * Returns the value, or the result of a function.
+     *
+     * The function is only invoked if `*this` does not contain a value,
+     * so the default is not constructed eagerly.
+     *
+     * @tparam F a type invocable with no arguments, returning an lvalue
+     *           reference whose address is convertible to `pointer`.
+     * @param f a function returning the default.
+     * @return the stored reference, or the result of `f`.
+     */
+    template <typename F,
+              typename R = decltype (std::declval<F> () ()),
+              typename std::enable_if<
+                    std::is_lvalue_reference<R>::value
+                &&  std::is_convertible<typename std::remove_reference<R>::type *,
+                                        pointer>::value>::type * = nullptr>
+    GCH_NODISCARD constexpr
+    reference
+    value_or_else (F&& f) const
+      noexcept (noexcept (std::declval<F> () ()))
+    {
+      return has_value () ? *m_ptr : static_cast<reference> (std::forward<F> (f) ());
+    }
+
+    /**
+     * Returns a copy of the value, or the result of a function.
+     *
+     * This is used when `f` returns a temporary. The result is returned by
+     * value because a reference to the temporary would dangle. The function
+     * is only invoked if `*this` does not contain a value.
+     *
+     * Note: The referent is copied even if `*this` contains a value. For
+     * types which are expensive to copy, have `f` return an lvalue (such as
+     * a static default) so that the overload returning a reference is used.
+     *
+     * @tparam F a type invocable with no arguments, returning a
+     *           non-lvalue convertible to `value_type`.
+     * @param f a function returning the default.
+     * @return a copy of the referenced value, or the result of `f`.
+     */
+    template <typename F,
+              typename R = decltype (std::declval<F> () ()),
+              typename U = typename std::remove_cv<value_type>::type,
+              typename std::enable_if<
+                  ! std::is_lvalue_reference<R>::value
+                &&  std::is_convertible<R, U>::value
+                &&  std::is_copy_constructible<U>::value>::type * = nullptr>
+    GCH_NODISCARD constexpr
+    U
+    value_or_else (F&& f) const
+      noexcept (noexcept (std::declval<F> () ())
+            &&  std::is_nothrow_copy_constructible<U>::value
+            &&  std::is_nothrow_constructible<U, R>::value)
+    {
+      return has_value () ? U (*m_ptr) : U (std::forward<F> (f) ());
+    }
+
+    /**
+     * Invokes a function returning an optional type on the referenced value.
+     *
+     * If `*this` does not contain a value, `f` is not invoked and a
+     * default-constructed (empty) result is returned.
+     *
+     * @tparam F a type invocable with `reference`, returning a
+     *           default-constructible type (usually an optional).
+     * @param f a function.
+     * @return the result of `f`, or an empty result.
+     */
+    template <typename F,
+              typename U = typename std::remove_cv<typename std::remove_reference<
+                decltype (std::declval<F> () (std::declval<reference> ()))>::type>::type,
+              typename std::enable_if<std::is_default_constructible<U>::value>::type * = nullptr>
+    GCH_NODISCARD constexpr
+    U
+    and_then (F&& f) const
+      noexcept (noexcept (U (std::declval<F> () (std::declval<reference> ())))
+            &&  std::is_nothrow_default_constructible<U>::value)
+    {
+      return has_value () ? U (std::forward<F> (f) (*m_ptr)) : U ();
+    }
+
+    /**
+     * Invokes a function returning an lvalue reference on the referenced
+     * value, and wraps the result in an `optional_ref`.
+     *
+     * If `*this` does not contain a value, `f` is not invoked and
+     * an empty `optional_ref` is returned.
+     *
+     * @tparam F a type invocable with `reference`, returning an lvalue reference.
+     * @param f a function.
+     * @return an `optional_ref` to the result of `f`, or an empty `optional_ref`.
+     */
+    template <typename F,
+              typename R = decltype (std::declval<F> () (std::declval<reference> ())),
+              typename std::enable_if<std::is_lvalue_reference<R>::value>::type * = nullptr>
+    GCH_NODISCARD constexpr
+    optional_ref<typename std::remove_reference<R>::type>
+    transform (F&& f) const
+      noexcept (noexcept (std::declval<F> () (std::declval<reference> ())))
+    {
+      using ret_type = optional_ref<typename std::remove_reference<R>::type>;
+      return has_value () ? ret_type (std::forward<F> (f) (*m_ptr)) : ret_type ();
+    }
+
+    /**
+     * Wraps a function returning an object in a `lazy_transform` with the
+     * referenced value.
+     *
+     * The function is invoked when the value of the result is accessed, and
+     * not at all if `*this` does not contain a value. To wrap the result in
+     * a `std::optional` eagerly, use the free function `gch::transform` from
+     * monadic.hpp.
+     *
+     * @tparam F a type invocable as a const lvalue with `reference`,
+     *           returning an object.
+     * @param f a function.
+     * @return a `lazy_transform` of `*this` by `f`.
+     */
+    template <typename F,
+              typename G = typename std::decay<F>::type,
+              typename R = decltype (std::declval<const G&> () (std::declval<reference> ())),
+              typename std::enable_if<
+                    ! std::is_lvalue_reference<R>::value
+                &&  ! std::is_void<R>::value>::type * = nullptr>
+    GCH_NODISCARD constexpr
+    lazy_transform<value_type, G>
+    transform (F&& f) const
+      noexcept (std::is_nothrow_constructible<G, F>::value)
+    {
+      return lazy_transform<value_type, G> (*this, std::forward<F> (f));
+    }
+
+    /**
+     * Returns `*this` if it contains a value, or else the result of a function.
+     *
+     * @tparam F a type invocable with no arguments, returning an lvalue
+     *           reference or another type from which `optional_ref` is
+     *           constructible.
+     * @param f a function returning the alternative.
+     * @return `*this`, or the result of `f`.
+     */
+    template <typename F,
+              typename std::enable_if<
+                std::is_constructible<optional_ref,
+                                      decltype (std::declval<F> () ())>::value>::type * = nullptr>
+    GCH_NODISCARD constexpr
+    optional_ref
+    or_else (F&& f) const
+      noexcept (noexcept (std::declval<F> () ()))
+    {
+      return has_value () ? *this : optional_ref (std::forward<F> (f) ());
+    }
+
+    /**
+     * Swap the contained reference with that of `other`.
+     *
+     * @param other a reference to another `optional_ref`.
+     */
+    GCH_CPP14_CONSTEXPR
+    void
+    swap (optional_ref& other) noexcept
+    {
+      // manually implemented so we can lower the constexpr version requirements to c++14
+      pointer tmp = m_ptr;
+      m_ptr       = other.m_ptr;
+      other.m_ptr = tmp;
+    }
+
+    /**
+     * Reset the contained reference.
+     *
+     * Internally, sets the pointer to `nullptr`.
+     */
+    GCH_CPP14_CONSTEXPR
+    void
+    reset (void) noexcept
+    {
+      m_ptr = nullptr;
+    }
+
+    /**
+     * Sets the contained reference.
+     *
+     * Internally, sets the pointer to the argument pointer.
+     *
+     * @tparam Ptr a type explicitly convertible to `pointer`.
+     * @param ptr a pointer.
+     * @return the contained reference.
+     */
+    template <typename Ptr,
+              typename std::enable_if<std::is_constructible<pointer, Ptr>::value>::type * = nullptr>
+    GCH_CPP14_CONSTEXPR
+    reference
+    emplace (Ptr&& ptr) noexcept
+    {
+      return *(m_ptr = pointer (std::forward<Ptr> (ptr)));
+    }
+
+    /**
+     * Sets the contained reference.
+     *
+     * Internally, sets the a pointer to the address of the referenced value.
+     *
+     * @tparam U a pointer convertible to `pointer`.
+     * @param ref an lvalue reference.
+     * @return the contained reference.
+     */
+    template <typename U,
+              typename std::enable_if<constructible_from_pointer_to<U>::value>::type * = nullptr>
+    GCH_CPP14_CONSTEXPR
+    reference
+    emplace (U& ref) noexcept
+    {
+      return emplace (&ref);
+    }
+
+    /**
+     * A deleted version for convertible rvalue references.
+     *
+     * We don't want to allow rvalue references because the internal pointer
+     * does not sustain the object lifetime.
+     */
+    template <typename U,
+              typename std::enable_if<constructible_from_pointer_to<U>::value>::type * = nullptr>
+    reference
+    emplace (const U&&) = delete;
+
+    /**
+     * Sets the contained pointer.
+     *
+     * Sets the pointer to the pointer contained by another optional_ref,
+     * where `pointer` is constructible from `U *`.
+     *
+     * @tparam U a referenced value type.
+     * @param other a optional_ref which contains a pointer from
+     *              which `pointer` may be constructed.
+     * @return the contained reference.
+     */
+    template <typename U,
+              typename std::enable_if<constructible_from_pointer_to<U>::value>::type * = nullptr>
+    GCH_CPP14_CONSTEXPR
+    reference
+    emplace (optional_ref<U> other) noexcept
+    {
+      return emplace (other.get_pointer ());
+    }
+
+    /**
+     * Compares reference addresses.
+     *
+     * Does a pointer comparison between the argument and
+     * the stored reference.
+     *
+     * @tparam U a reference type whose address is comparable to `pointer`.
+     * @param ref an lvalue reference.
+     * @return whether `*this` contains `ref`.
+     */
+    template <typename U,
+              typename CommonPointer = typename std::common_type<
+                pointer,
+                decltype (&std::declval<U&> ())
+              >::type>
+    GCH_NODISCARD constexpr
+    bool
+    refers_to (U& ref) const noexcept
+    {
+      return CommonPointer (&ref) == CommonPointer (m_ptr);
+    }
+
+    /**
+     * A deleted version for rvalue references.
+     *
+     * Using `refers_to` with an rvalue reference is obviously
+     * a mistake, so we might as well delete it.
+     */
+    template <typename U>
+    bool
+    refers_to (const U&&) const noexcept = delete;
+
+    /**
+     * Compares the stored pointer with nullptr.
+     *
+     * Returns true iff the has_value () is false.
+     *
+     * @return if the `optional_ref` is empty.
+     */
+    GCH_NODISCARD constexpr
+    bool
+    equal_pointer (std::nullptr_t) const noexcept
+    {
+      return ! has_value ();
+    }
+
+    /**
+     * Compares the stored pointer with another pointer.
+     *
+     * The equality comparison takes place after conversion to a common pointer type
+     *
+     * @tparam Ptr the type of a pointer to be compared.
+     * @tparam CommonPointer the common type between the stored pointer and the input.
+     * @param ptr a pointer to be compared.
+     * @return the result of the equality comparison after conversion to CommonPointer.
+     */
+    template <typename Ptr,
+              typename CommonPointer = typename std::common_type<pointer, Ptr>::type>
+    GCH_NODISCARD constexpr
+    bool
+    equal_pointer (Ptr&& ptr) const noexcept
+    {
+      return CommonPointer (ptr) == CommonPointer (m_ptr);
+    }
+
+    /**
+     * Compares the stored pointer with that of another `optional_ref`.
+     *
+     * @tparam U the `value_type` of another `optional_ref`.
+     * @tparam CommonPointer the common type between the stored pointers.
+     * @param other another `optional_ref`.
+     * @return whether the stored pointers are equal.
+     */
+    template <typename U,
+              typename CommonPointer = typename std::common_type<pointer, U *>::type>
+    GCH_NODISCARD constexpr
+    bool
+    equal_pointer (optional_ref<U> other) const noexcept
+    {
+      return CommonPointer (other.get_pointer ()) == CommonPointer (m_ptr);
+    }
+
+  private:
+    /**
+     * A pointer to the value.
+     *
+     * We use a pointer representation instead of an actual
+     * reference so we can have rebind semantics.
+     */
+    pointer m_ptr { nullptr };
+  };
+
+  static_assert (std::is_trivially_copyable<optional_ref<int>>::value,
+                 "optional_ref should be trivially copyable");
+
+  /**
+   * The result of `optional_ref::transform` for a function returning an object.
+   *
+   * This is a lazy optional. It holds the `optional_ref` and the function,
+   * and invokes the function each time the value is accessed. It is empty
+   * when the `optional_ref` is, so it needs no storage for the result and is
+   * usable from C++11.
+   *
+   * @tparam T the value type of the transformed `optional_ref`.
+   * @tparam F the type of the function.
+   */
+  template <typename T, typename F>
+  class lazy_transform
+  {
+  public:
+    /**
+     * The type of the result of the function.
+     */
+    using value_type = typename std::remove_cv<typename std::remove_reference<
+      decltype (std::declval<const F&> () (std::declval<T&> ()))>::type>::type;
+
+    /**
+     * Constructor
+     *
+     * @tparam G a type from which `F` is constructible.
+     * @param ref the transformed `optional_ref`.
+     * @param f the function.
+     */
+    template <typename G,
+              typename std::enable_if<std::is_constructible<F, G>::value>::type * = nullptr>
+    constexpr
+    lazy_transform (optional_ref<T> ref, G&& f)
+      noexcept (std::is_nothrow_constructible<F, G>::value)
+      : m_ref (ref),
+        m_f (std::forward<G> (f))
+    { }
+
+    /**
+     * Checks if `*this` contains a value.
+     *
+     * @return whether the transformed `optional_ref` contains a value.
+     */
+    GCH_NODISCARD constexpr
+    bool
+    has_value (void) const noexcept
+    {
+      return m_ref.has_value ();
+    }
+
+    /**
+     * Checks if `*this` contains a value.
+     *
+     * The return is forwarded from `has_value ()`.
+     *
+     * @return whether `*this` contains a value.
+     */
+    GCH_NODISCARD constexpr explicit
+    operator bool (void) const noexcept
+    {
+      return has_value ();
+    }
+
+    /**
+     * Invokes the function on the referenced value.
+     *
+     * The behavior is undefined if `*this` does not contain a value.
+     *
+     * @return the result of the function.
+     */
+    GCH_NODISCARD constexpr
+    value_type
+    operator* (void) const
+      noexcept (noexcept (value_type (std::declval<const F&> () (std::declval<T&> ()))))
+    {
+      return m_f (*m_ref);
+    }
+
+    /**
+     * Invokes the function on the referenced value, while checking whether it exists.
+     *
+     * @throws bad_optional_access when `*this` does not contain a value.
+     *
+     * @see gch::set_bad_optional_access_handler
+     *
+     * @return the result of the function.
+     */
+    GCH_NODISCARD GCH_CPP14_CONSTEXPR
+    value_type
+    value (void) const
+    {
+      if (! has_value ())
+        detail::bad_optional_access_failure ();
+      return m_f (*m_ref);
+    }
+
+    /**
+     * Invokes the function on the referenced value, or returns a default.
+     *
+     * @tparam U a type convertible to `value_type`.
+     * @param default_value the value returned if `*this` does not contain a value.
+     * @return the result of the function, or `default_value`.
+     */
+    template <typename U,
+              typename std::enable_if<std::is_convertible<U, value_type>::value>::type * = nullptr>
+    GCH_NODISCARD constexpr
+    value_type
+    value_or (U&& default_value) const
+    {
+      return has_value () ? value_type (m_f (*m_ref))
+                          : value_type (std::forward<U> (default_value));
+    }
+
+  private:
+    optional_ref<T> m_ref;
+    F               m_f;
+  };
+
+
+  template <typename OptionalRef>
+  struct is_optional_ref
+    : std::false_type
+  { };
+
+  template <typename T>
+  struct is_optional_ref<optional_ref<T>>
+    : std::true_type
+  { };
+
+#ifdef GCH_LIB_THREE_WAY_COMPARISON
+
+  namespace concepts
+  {
+
+    /**
+     * A utility concept for identifying `optional_ref`s.
+     *
+     * This might be useful in template parameters like
+     *
+     * ```c++
+     * template <OptionalRef Opt>
+     * void
+     * f (Opt o);
+     * ```
+     *
+     * @tparam T the `value_type` of an `optional_ref`.
+     */
+    template <typename T>
+    concept OptionalRef = is_optional_ref<T>::value;
+
+  }
+
+#endif
+
+  // TODO: make comparisons more SFINAE-friendly
+
+  /**
+   * An equality comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @param lhs an `optional_ref`.
+   * @param rhs an `optional_ref`.
+   * @return the result of the equality comparison.
+   *
+   * @see std::optional::operator==
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator== (optional_ref<T> lhs, optional_ref<U> rhs)
+    noexcept (noexcept (*lhs == *rhs))
+  {
+    return (lhs.has_value () == rhs.has_value ()) && (! lhs.has_value () || (*lhs == *rhs));
+  }
+
+  /**
+   * An inequality comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @param lhs an `optional_ref`.
+   * @param rhs an `optional_ref`.
+   * @return the result of the inequality comparison.
+   *
+   * @see std::optional::operator!=
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator!= (optional_ref<T> lhs, optional_ref<U> rhs)
+    noexcept (noexcept (*lhs != *rhs))
+  {
+    return (lhs.has_value () != rhs.has_value ()) || (lhs.has_value () && (*lhs != *rhs));
+  }
+
+  /**
+   * An less-than comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @param lhs an `optional_ref`.
+   * @param rhs an `optional_ref`.
+   * @return the result of the less-than comparison.
+   *
+   * @see std::optional::operator<
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator< (optional_ref<T> lhs, optional_ref<U> rhs)
+    noexcept (noexcept (*lhs < *rhs))
+  {
+    return rhs.has_value () && (! lhs.has_value () || (*lhs < *rhs));
+  }
+
+  /**
+   * A greater-than-equal comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @param lhs an `optional_ref`.
+   * @param rhs an `optional_ref`.
+   * @return the result of the greater-than-equal comparison.
+   *
+   * @see std::optional::operator>=
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator>= (optional_ref<T> lhs, optional_ref<U> rhs)
+    noexcept (noexcept (*lhs >= *rhs))
+  {
+    return ! rhs.has_value () || (lhs.has_value () && (*lhs >= *rhs));
+  }
+
+  /**
+   * A greater-than comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @param lhs an `optional_ref`.
+   * @param rhs an `optional_ref`.
+   * @return the result of the greater-than comparison.
+   *
+   * @see std::optional::operator>
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator> (optional_ref<T> lhs, optional_ref<U> rhs)
+    noexcept (noexcept (*lhs > *rhs))
+  {
+    return lhs.has_value () && (! rhs.has_value () || (*lhs > *rhs));
+  }
+
+  /**
+   * A less-than-equal comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @param lhs an `optional_ref`.
+   * @param rhs an `optional_ref`.
+   * @return the result of the less-than-equal comparison.
+   *
+   * @see std::optional::operator<=
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator<= (optional_ref<T> lhs, optional_ref<U> rhs)
+    noexcept (noexcept (*lhs <= *rhs))
+  {
+    return ! lhs.has_value () || (rhs.has_value () && (*lhs <= *rhs));
+  }
+
+#ifdef GCH_LIB_THREE_WAY_COMPARISON
+
+  /**
+   * A three-way comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @param lhs an `optional_ref`.
+   * @param rhs an `optional_ref`.
+   * @return the result of the three-way comparison.
+   *
+   * @see std::optional::operator<=>
+   */
+  template <typename T, std::three_way_comparable_with<T> U>
+  GCH_NODISCARD constexpr
+  std::compare_three_way_result_t<T, U>
+  operator<=> (optional_ref<T> lhs, optional_ref<U> rhs)
+    noexcept (noexcept (std::compare_three_way { } (*lhs, *rhs)))
+  {
+    return (lhs.has_value () && rhs.has_value ()) ? std::compare_three_way { } (*lhs, *rhs)
+                                                  : (lhs.has_value () <=> rhs.has_value ());
+  }
+
+#endif
+
+  /**
+   * An equality comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @param lhs an `optional_ref`.
+   * @return the result of the equality comparison.
+   *
+   * @see std::optional::operator==
+   */
+  template <typename T>
+  GCH_NODISCARD constexpr
+  bool
+  operator== (optional_ref<T> lhs, nullopt_t) noexcept
+  {
+    return ! lhs.has_value ();
+  }
+
+  /**
+   * An equality comparison function.
+   *
+   * @tparam T the value type of `rhs`.
+   * @param rhs an `optional_ref`.
+   * @return the result of the equality comparison.
+   *
+   * @see std::optional::operator==
+   */
+  template <typename T>
+  GCH_NODISCARD constexpr
+  bool
+  operator== (nullopt_t, optional_ref<T> rhs) noexcept
+  {
+    return ! rhs.has_value ();
+  }
+
+#ifdef GCH_LIB_THREE_WAY_COMPARISON
+
+  /**
+   * A three-way comparison function.
+   *
+   * @tparam T the value type of `rhs`.
+   * @param lhs an `optional_ref`.
+   * @return the result of the three-way comparison.
+   *
+   * @see std::optional::operator<=>
+   */
+  template <typename T>
+  GCH_NODISCARD constexpr
+  std::strong_ordering
+  operator<=> (optional_ref<T> lhs, nullopt_t) noexcept
+  {
+    return lhs.has_value () <=> false;
+  }
+
+  template <typename T>
+  GCH_NODISCARD constexpr
+  std::strong_ordering
+  operator<=> (nullopt_t, optional_ref<T> rhs) noexcept
+  {
+    return false <=> rhs.has_value ();
+  }
+
+#else
+
+  /**
+   * An inequality comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @param lhs an `optional_ref`.
+   * @return the result of the inequality comparison.
+   *
+   * @see std::optional::operator!=
+   */
+  template <typename T>
+  GCH_NODISCARD constexpr
+  bool
+  operator!= (optional_ref<T> lhs, nullopt_t) noexcept
+  {
+    return lhs.has_value ();
+  }
+
+  /**
+   * An inequality comparison function.
+   *
+   * @tparam T the value type of `rhs`.
+   * @param rhs an `optional_ref`.
+   * @return the result of the inequality comparison.
+   *
+   * @see std::optional::operator!=
+   */
+  template <typename T>
+  GCH_NODISCARD constexpr
+  bool
+  operator!= (nullopt_t, optional_ref<T> rhs) noexcept
+  {
+    return rhs.has_value ();
+  }
+
+  /**
+   * A less-than comparison function.
+   *
+   * Compared by value.
+   *
+   * @tparam T the value type of `lhs`.
+   * @return the result of the less-than comparison.
+   *
+   * @see std::optional::operator<
+   */
+  template <typename T>
+  GCH_NODISCARD GCH_CPP20_CONSTEVAL
+  bool
+  operator< (optional_ref<T>, nullopt_t) noexcept
+  {
+    return false;
+  }
+
+  /**
+   * A less-than comparison function.
+   *
+   * Compared by value.
+   *
+   * @tparam T the value type of `rhs`.
+   * @return the result of the less-than comparison.
+   *
+   * @see std::optional::operator<
+   */
+  template <typename T>
+  GCH_NODISCARD constexpr
+  bool
+  operator< (nullopt_t, optional_ref<T> rhs) noexcept
+  {
+    return rhs.has_value ();
+  }
+
+  /**
+   * A greater-than-equal comparison function.
+   *
+   * Compared by value.
+   *
+   * @tparam T the value type of `lhs`.
+   * @return the result of the greater-than-equal comparison.
+   *
+   * @see std::optional::operator>=
+   */
+  template <typename T>
+  GCH_NODISCARD GCH_CPP20_CONSTEVAL
+  bool
+  operator>= (optional_ref<T>, nullopt_t) noexcept
+  {
+    return true;
+  }
+
+  /**
+   * A greater-than-equal comparison function.
+   *
+   * Compared by value.
+   *
+   * @tparam T the value type of `rhs`.
+   * @param rhs an `optional_ref`.
+   * @return the result of the greater-than-equal comparison.
+   *
+   * @see std::optional::operator>=
+   */
+  template <typename T>
+  GCH_NODISCARD constexpr
+  bool
+  operator>= (nullopt_t, optional_ref<T> rhs) noexcept
+  {
+    return ! rhs.has_value ();
+  }
+
+  /**
+   * A greater-than comparison function.
+   *
+   * Compared by value.
+   *
+   * @tparam T the value type of `lhs`.
+   * @param lhs an `optional_ref`.
+   * @return the result of the greater-than comparison.
+   *
+   * @see std::optional::operator>
+   */
+  template <typename T>
+  GCH_NODISCARD constexpr
+  bool
+  operator> (optional_ref<T> lhs, nullopt_t) noexcept
+  {
+    return lhs.has_value ();
+  }
+
+  /**
+   * A greater-than comparison function.
+   *
+   * Compared by value.
+   *
+   * @tparam T the value type of `rhs`.
+   * @return the result of the greater-than comparison.
+   *
+   * @see std::optional::operator>
+   */
+  template <typename T>
+  GCH_NODISCARD GCH_CPP20_CONSTEVAL
+  bool
+  operator> (nullopt_t, optional_ref<T>) noexcept
+  {
+    return false;
+  }
+
+  /**
+   * A less-than-equal comparison function.
+   *
+   * Compared by value.
+   *
+   * @tparam T the value type of `lhs`.
+   * @param lhs an `optional_ref`.
+   * @return the result of the less-than-equal comparison.
+   *
+   * @see std::optional::operator<=
+   */
+  template <typename T>
+  GCH_NODISCARD constexpr
+  bool
+  operator<= (optional_ref<T> lhs, nullopt_t) noexcept
+  {
+    return ! lhs.has_value ();
+  }
+
+  /**
+   * A less-than-equal comparison function.
+   *
+   * Compared by value.
+   *
+   * @tparam T the value type of `rhs`.
+   * @return the result of the less-than-equal comparison.
+   *
+   * @see std::optional::operator<=
+   */
+  template <typename T>
+  GCH_NODISCARD GCH_CPP20_CONSTEVAL
+  bool
+  operator<= (nullopt_t, optional_ref<T>) noexcept
+  {
+    return true;
+  }
+
+#endif
+
+  /**
+   * An equality comparison function.
+   *
+   * Compared by value. Use `equal_pointer` to compare pointers.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of a reference which is comparable to T.
+   * @param lhs an `optional_ref`.
+   * @param rhs a comparable reference.
+   * @return the result of the equality comparison.
+   *
+   * @see std::optional::operator==
+   */
+  template <typename T, typename U,
+            typename std::enable_if<! is_optional_ref<U>::value>::type * = nullptr>
+  GCH_NODISCARD constexpr
+  bool
+  operator== (optional_ref<T> lhs, const U& rhs)
+    noexcept (noexcept (*lhs == rhs))
+  {
+    return lhs.has_value () && (*lhs == rhs);
+  }
+
+  /**
+   * An equality comparison function.
+   *
+   * Compared by value.
+   *
+   * @tparam T the value type of `rhs`.
+   * @tparam U the value type of a reference which is comparable to T.
+   * @param lhs a comparable reference.
+   * @param rhs an `optional_ref`.
+   * @return the result of the equality comparison.
+   *
+   * @see std::optional::operator==
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator== (const U& lhs, optional_ref<T> rhs)
+    noexcept (noexcept (lhs == *rhs))
+  {
+    return rhs.has_value () && (lhs == *rhs);
+  }
+
+  /**
+   * An inequality comparison function.
+   *
+   * Compared by value. Use `equal_pointer` to compare pointers.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of a reference which is comparable to T.
+   * @param lhs an `optional_ref`.
+   * @param rhs a comparable reference.
+   * @return the result of the inequality comparison.
+   *
+   * @see std::optional::operator!=
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator!= (optional_ref<T> lhs, const U& rhs)
+    noexcept (noexcept (*lhs != rhs))
+  {
+    return ! lhs.has_value () || (*lhs != rhs);
+  }
+
+  /**
+   * An inequality comparison function.
+   *
+   * Compared by value. Use `equal_pointer` to compare pointers.
+   *
+   * @tparam T the value type of `rhs`.
+   * @tparam U the value type of a reference which is comparable to T.
+   * @param lhs a comparable reference.
+   * @param rhs an `optional_ref`.
+   * @return the result of the inequality comparison.
+   *
+   * @see std::optional::operator!=
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator!= (const U& lhs, optional_ref<T> rhs)
+    noexcept (noexcept (lhs != *rhs))
+  {
+    return ! rhs.has_value () || (lhs != *rhs);
+  }
+
+  /**
+   * A less-than comparison function.
+   *
+   * Compared by value.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of a reference which is comparable to T.
+   * @param lhs an `optional_ref`.
+   * @param rhs a comparable reference.
+   * @return the result of the less-than comparison.
+   *
+   * @see std::optional::operator<
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator< (optional_ref<T> lhs, const U& rhs)
+    noexcept (noexcept (*lhs < rhs))
+  {
+    return ! lhs.has_value () || (*lhs < rhs);
+  }
+
+  /**
+   * A less-than comparison function.
+   *
+   * Compared by value.
+   *
+   * @tparam T the value type of `rhs`.
+   * @tparam U the value type of a reference which is comparable to T.
+   * @param lhs a comparable reference.
+   * @param rhs an `optional_ref`.
+   * @return the result of the less-than comparison.
+   *
+   * @see std::optional::operator<
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator< (const U& lhs, optional_ref<T> rhs)
+  noexcept (noexcept (lhs < *rhs))
+  {
+    return rhs.has_value () && (lhs < *rhs);
+  }
+
+  /**
+   * A greater-than-equal comparison function.
+   *
+   * Compared by value.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of a reference which is comparable to T.
+   * @param lhs an `optional_ref`.
+   * @param rhs a comparable reference.
+   * @return the result of the greater-than-equal comparison.
+   *
+   * @see std::optional::operator>=
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator>= (optional_ref<T> lhs, const U& rhs)
+    noexcept (noexcept (*lhs >= rhs))
+  {
+    return lhs.has_value () && (*lhs >= rhs);
+  }
+
+  /**
+   * A greater-than-equal comparison function.
+   *
+   * Compared by value.
+   *
+   * @tparam T the value type of `rhs`.
+   * @tparam U the value type of a reference which is comparable to T.
+   * @param lhs a comparable reference.
+   * @param rhs an `optional_ref`.
+   * @return the result of the greater-than-equal comparison.
+   *
+   * @see std::optional::operator>=
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator>= (const U& lhs, optional_ref<T> rhs)
+    noexcept (noexcept (lhs >= *rhs))
+  {
+    return ! rhs.has_value () || (lhs >= *rhs);
+  }
+
+  /**
+   * A greater-than comparison function.
+   *
+   * Compared by value.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of a reference which is comparable to T.
+   * @param lhs an `optional_ref`.
+   * @param rhs a comparable reference.
+   * @return the result of the greater-than comparison.
+   *
+   * @see std::optional::operator>
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator> (optional_ref<T> lhs, const U& rhs)
+    noexcept (noexcept (*lhs > rhs))
+  {
+    return lhs.has_value () && (*lhs > rhs);
+  }
+
+  /**
+   * A greater-than comparison function.
+   *
+   * Compared by value.
+   *
+   * @tparam T the value type of `rhs`.
+   * @tparam U the value type of a reference which is comparable to T.
+   * @param lhs a comparable reference.
+   * @param rhs an `optional_ref`.
+   * @return the result of the greater-than comparison.
+   *
+   * @see std::optional::operator>
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator> (const U& lhs, optional_ref<T> rhs)
+    noexcept (noexcept (lhs > *rhs))
+  {
+    return ! rhs.has_value () || (lhs > *rhs);
+  }
+
+  /**
+   * A less-than-equal comparison function.
+   *
+   * Compared by value.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of a reference which is comparable to T.
+   * @param lhs an `optional_ref`.
+   * @param rhs a comparable reference.
+   * @return the result of the less-than-equal comparison.
+   *
+   * @see std::optional::operator<=
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator<= (optional_ref<T> lhs, const U& rhs)
+    noexcept (noexcept (*lhs <= rhs))
+  {
+    return ! lhs.has_value () || (*lhs <= rhs);
+  }
+
+  /**
+   * A less-than-equal comparison function.
+   *
+   * Compared by value.
+   *
+   * @tparam T the value type of `rhs`.
+   * @tparam U the value type of a reference which is comparable to T.
+   * @param lhs a comparable reference.
+   * @param rhs an `optional_ref`.
+   * @return the result of the less-than-equal comparison.
+   *
+   * @see std::optional::operator<=
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator<= (const U& lhs, optional_ref<T> rhs)
+    noexcept (noexcept (lhs <= *rhs))
+  {
+    return rhs.has_value () && (lhs <= *rhs);
+  }
+
+#ifdef GCH_LIB_THREE_WAY_COMPARISON
+
+  /**
+   * A three-way comparison function.
+   *
+   * Compared by value.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of a reference which is comparable to T.
+   * @param lhs an `optional_ref`.
+   * @param rhs a comparable reference.
+   * @return the result of the three-way comparison.
+   *
+   * @see std::optional::operator<=>
+   */
+  template <typename T, typename U>
+  requires (! is_optional_ref<U>::value && std::three_way_comparable_with<T, U>)
+  GCH_NODISCARD constexpr
+  std::compare_three_way_result_t<T, U>
+  operator<=> (optional_ref<T> lhs, const U& rhs)
+    noexcept (noexcept (std::compare_three_way { } (*lhs, rhs)))
+  {
+    return lhs.has_value () ? std::compare_three_way { } (*lhs, rhs)
+                            : std::strong_ordering::less;
+  }
+
+#endif
+
+  /**
+   * A swap function.
+   *
+   * Swaps the two `optional_ref`s of the same type.
+   *
+   * @tparam T the value type pointed to by the `optional_ref`s
+   * @param lhs an `optional_ref`.
+   * @param rhs an `optional_ref`.
+   */
+  template <typename T>
+  inline GCH_CPP14_CONSTEXPR
+  void
+  swap (optional_ref<T>& lhs, optional_ref<T>& rhs) noexcept
+  {
+    lhs.swap (rhs);
+  }
+
+  /**
+   * Compares the stored pointers of two `optional_ref`s.
+   *
+   * @tparam T the value type of the left-hand side `optional_ref`.
+   * @tparam U the value type of the right-hand side `optional_ref`.
+   * @param lhs an `optional_ref`.
+   * @param rhs an `optional_ref`.
+   * @return the result of the comparison of the stored pointers.
+   */
+  template <typename T, typename U>
+  constexpr
+  bool
+  equal_pointer (optional_ref<T> lhs, optional_ref<U> rhs) noexcept
+  {
+    return lhs.equal_pointer (rhs);
+  }
+
+#ifdef GCH_FOLD_EXPRESSIONS
+
+  /**
+   * Compares the stored pointers of multiple `optional_ref`s.
+   *
+   * @tparam T the value type of an `optional_ref`.
+   * @tparam Us a type pack containing pointer types or the value types of `optional_ref`s.
+   * @param lhs an `optional_ref`.
+   * @param rhs a parameter pack containing multiple `optional_ref`s.
+   * @return whether all stored pointers are equal.
+   */
+  template <typename T, typename ...Us>
+  constexpr
+  bool
+  equal_pointer (optional_ref<T> lhs, Us&&... rhs) noexcept
+  {
+    return (equal_pointer (lhs, std::forward<Us> (rhs)) && ...);
+  }
+
+#else
+
+  template <typename T, typename U, typename ...Rest>
+  constexpr
+  bool
+  equal_pointer (optional_ref<T> lhs, optional_ref<U> rhs, Rest&&... rest) noexcept
+  {
+    return equal_pointer (lhs, rhs) && equal_pointer (lhs, std::forward<Rest> (rest)...);
+  }
+
+#endif
+
+  /**
+   * An optional_ref creation function.
+   *
+   * Creates an `optional_ref` with the specified argument.
+   *
+   * @tparam U a value type.
+   * @param ref a reference.
+   * @return an `optional_ref<U>` created from the argument.
+   *
+   * @see std::make_optional
+   */
+  template <typename U>
+  GCH_NODISCARD constexpr
+  optional_ref<U>
+  make_optional_ref (U& ref) noexcept
+  {
+    return optional_ref<U> { ref };
+  }
+
+  /**
+   * An optional_ref creation function.
+   *
+   * Creates an `optional_ref` with the specified argument.
+   *
+   * @tparam U a value type.
+   * @param ptr a pointer.
+   * @return an `optional_ref<U>` created from the argument.
+   *
+   * @see std::make_optional
+   */
+  template <typename U>
+  GCH_NODISCARD constexpr
+  optional_ref<U>
+  make_optional_ref (U *ptr) noexcept
+  {
+    return optional_ref<U> { ptr };
+  }
+
+#ifdef GCH_CTAD_SUPPORT
+
+  template <typename U>
+  optional_ref (U&) -> optional_ref<U>;
+
+  template <typename U>
+  optional_ref (U *) -> optional_ref<U>;
+
+#endif
+
+  /**
+   * Creates a const version of an `optional_ref`.
+   *
+   * This can be useful for template code.
+   *
+   * @tparam T the value type of an `optional_ref`.
+   * @param opt an `optional_ref` which holds a non-const reference.
+   * @return a const version of the `optional_ref`.
+   */
+  template <typename T>
+  constexpr
+  optional_ref<const T>
+  as_const (optional_ref<T> opt) noexcept
+  {
+    return opt;
+  }
+
+  /**
+   * Creates a mutable version of an `optional_ref`.
+   *
+   * This function performs a `const_cast` on the underlying pointer
+   * held by the `optional_ref` and returns a non-const `optional_ref`.
+   *
+   * @tparam T the value type of an `optional_ref`.
+   * @param opt an `optional_ref` which holds a const reference.
+   * @return a non-const version of the `optional_ref`.
+   */
+  template <typename T>
+  constexpr
+  optional_ref<typename std::remove_const<T>::type>
+  as_mutable (optional_ref<T> opt) noexcept
+  {
+    return const_cast<typename std::remove_const<T>::type *> (opt.get_pointer ());
+  }
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_OPTIONAL_REF_CORE_HPP
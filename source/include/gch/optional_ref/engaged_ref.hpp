@@ -0,0 +1,377 @@
+/** engaged_ref.hpp
+ * Defines `engaged_ref`, a reference which is known to refer to an object.
+ *
+ * An `engaged_ref` may only be obtained from an `optional_ref` which has a
+ * value, so passing one to a function proves to the callee (and to the
+ * optimizer, across translation units) that no null check is needed.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_OPTIONAL_REF_ENGAGED_REF_HPP
+#define GCH_OPTIONAL_REF_ENGAGED_REF_HPP
+
+#include "core.hpp"
+#include "monadic.hpp"
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  template <typename T>
+  class engaged_ref;
+
+} // namespace gch
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    template <typename T>
+    GCH_CPP14_CONSTEXPR
+    T *
+    checked_engaged_pointer (optional_ref<T> opt)
+    {
+      if (! opt.has_value ())
+        bad_optional_access_failure ();
+      return opt.get_pointer ();
+    }
+
+  }
+
+} // namespace gch
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * A reference which is known to refer to an object.
+   *
+   * Unlike `optional_ref`, an `engaged_ref` has no empty state, so none of its
+   * accessors check for one. It converts implicitly to `optional_ref`.
+   *
+   * @tparam T the value type of the reference.
+   */
+  template <typename T>
+  class engaged_ref
+  {
+  public:
+    static_assert (! std::is_reference<T>::value,
+      "engaged_ref expects a value type as a template argument, not a reference.");
+
+    using value_type = T;   /*!< The value type of the stored reference */
+    using reference  = T&;  /*!< The reference type to be wrapped       */
+    using pointer    = T *; /*!< The pointer type to the value type     */
+
+    engaged_ref            (void)                   = delete;
+    engaged_ref            (const engaged_ref&)     = default;
+    engaged_ref            (engaged_ref&&) noexcept = default;
+    engaged_ref& operator= (const engaged_ref&)     = default;
+    engaged_ref& operator= (engaged_ref&&) noexcept = default;
+    ~engaged_ref           (void)                   = default;
+
+    /**
+     * Constructor
+     *
+     * Refers to `ref`.
+     *
+     * @param ref a reference.
+     */
+    constexpr explicit
+    engaged_ref (T& ref) noexcept
+      : m_ptr (std::addressof (ref))
+    { }
+
+    /**
+     * Constructor
+     *
+     * A deleted contructor for the case where `ref` is an rvalue reference.
+     */
+    engaged_ref (const T&&) = delete;
+
+    /**
+     * Constructor
+     *
+     * A checked conversion from an `optional_ref`.
+     *
+     * @throws bad_optional_access when `opt` does not contain a value.
+     *
+     * @see gch::set_bad_optional_access_handler
+     *
+     * @param opt an `optional_ref`.
+     */
+    GCH_CPP14_CONSTEXPR explicit
+    engaged_ref (optional_ref<T> opt)
+      : m_ptr (detail::checked_engaged_pointer (opt))
+    { }
+
+    /**
+     * Constructor
+     *
+     * A converting constructor for the case where `U *` is implicitly
+     * convertible to `pointer`.
+     *
+     * @tparam U a referenced value type.
+     * @param other an `engaged_ref`.
+     */
+    template <typename U,
+              typename std::enable_if<std::is_convertible<U *, pointer>::value>::type * = nullptr>
+    constexpr GCH_IMPLICIT_CONVERSION
+    engaged_ref (engaged_ref<U> other) noexcept
+      : m_ptr (other.get_pointer ())
+    { }
+
+    /**
+     * Converts to an `optional_ref` which has a value.
+     *
+     * @tparam U a value type where `T *` is implicitly convertible to `U *`.
+     * @return an `optional_ref` to the referent.
+     */
+    template <typename U,
+              typename std::enable_if<std::is_convertible<pointer, U *>::value>::type * = nullptr>
+    constexpr GCH_IMPLICIT_CONVERSION
+    operator optional_ref<U> (void) const noexcept
+    {
+      return optional_ref<U> (m_ptr);
+    }
+
+    /**
+     * Gets a pointer to the referent. The pointer is never null.
+     *
+     * @return a pointer to the referent.
+     */
+    GCH_NODISCARD GCH_RETURNS_NONNULL constexpr
+    pointer
+    get_pointer (void) const noexcept
+    {
+      return m_ptr;
+    }
+
+    /**
+     * Gets the referent.
+     *
+     * @return the referent.
+     */
+    GCH_NODISCARD constexpr
+    reference
+    get (void) const noexcept
+    {
+      return *m_ptr;
+    }
+
+    /**
+     * Gets the referent.
+     *
+     * This is the same as `get ()`. It exists so that `engaged_ref` may be
+     * used in code written for `optional_ref`.
+     *
+     * @return the referent.
+     */
+    GCH_NODISCARD constexpr
+    reference
+    value (void) const noexcept
+    {
+      return *m_ptr;
+    }
+
+    /**
+     * Always returns `true`.
+     *
+     * This exists so that `engaged_ref` may be used in code written
+     * for `optional_ref`.
+     *
+     * @return `true`.
+     */
+    GCH_NODISCARD static constexpr
+    bool
+    has_value (void) noexcept
+    {
+      return true;
+    }
+
+    /**
+     * Always returns `true`.
+     *
+     * @return `true`.
+     */
+    GCH_NODISCARD constexpr explicit
+    operator bool (void) const noexcept
+    {
+      return true;
+    }
+
+    /**
+     * Gets the referent.
+     *
+     * @return the referent.
+     */
+    GCH_NODISCARD constexpr
+    reference
+    operator* (void) const noexcept
+    {
+      return *m_ptr;
+    }
+
+    /**
+     * Gets a pointer to the referent. The pointer is never null.
+     *
+     * @return a pointer to the referent.
+     */
+    GCH_NODISCARD GCH_RETURNS_NONNULL constexpr
+    pointer
+    operator-> (void) const noexcept
+    {
+      return m_ptr;
+    }
+
+    /**
+     * Checks whether `*this` refers to `r`.
+     *
+     * @param r a reference.
+     * @return whether `*this` refers to `r`.
+     */
+    GCH_NODISCARD constexpr
+    bool
+    refers_to (const volatile T& r) const noexcept
+    {
+      return m_ptr == std::addressof (r);
+    }
+
+  private:
+    pointer m_ptr;
+  };
+
+  /**
+   * The result of `engaged`, which is either an `engaged_ref` or nothing.
+   *
+   * This is meant to be used in the condition of an if-statement:
+   *
+   *     if (auto r = gch::engaged (opt))
+   *       use (*r); // `*r` is an `engaged_ref`.
+   *
+   * @tparam T the value type of the reference.
+   */
+  template <typename T>
+  class maybe_engaged_ref
+  {
+  public:
+    /**
+     * Constructor
+     *
+     * @param opt an `optional_ref`.
+     */
+    constexpr explicit
+    maybe_engaged_ref (optional_ref<T> opt) noexcept
+      : m_ptr (opt.get_pointer ())
+    { }
+
+    /**
+     * Checks whether there is an `engaged_ref`.
+     *
+     * @return whether there is an `engaged_ref`.
+     */
+    GCH_NODISCARD constexpr explicit
+    operator bool (void) const noexcept
+    {
+      return m_ptr != nullptr;
+    }
+
+    /**
+     * Gets the `engaged_ref`. This is undefined if there is none.
+     *
+     * @return the `engaged_ref`.
+     */
+    GCH_NODISCARD constexpr
+    engaged_ref<T>
+    operator* (void) const noexcept
+    {
+      return engaged_ref<T> (*m_ptr);
+    }
+
+    /**
+     * Gets a pointer to the referent. This is undefined if there is no
+     * `engaged_ref`.
+     *
+     * @return a pointer to the referent.
+     */
+    GCH_NODISCARD constexpr
+    T *
+    operator-> (void) const noexcept
+    {
+      return m_ptr;
+    }
+
+  private:
+    T *m_ptr;
+  };
+
+  /**
+   * Tests whether an `optional_ref` has a value, and produces an
+   * `engaged_ref` if it does.
+   *
+   * @tparam T the value type of the `optional_ref`.
+   * @param opt an `optional_ref`.
+   * @return a `maybe_engaged_ref` which holds an `engaged_ref` to
+   *         the referent of `opt` if it has one.
+   */
+  template <typename T>
+  GCH_NODISCARD constexpr
+  maybe_engaged_ref<T>
+  engaged (optional_ref<T> opt) noexcept
+  {
+    return maybe_engaged_ref<T> (opt);
+  }
+
+  /**
+   * Invokes a functor on the referent of an `engaged_ref`.
+   *
+   * There is no null branch. The return type is mapped like that of
+   * `maybe_invoke` for `optional_ref`, except that an lvalue reference
+   * `U&` maps to `engaged_ref<U>`, and any object type is returned as-is.
+   *
+   * @tparam T the value type of the `engaged_ref`.
+   * @tparam Functor a functor.
+   * @tparam Args argument types passed to the function.
+   * @param ref an `engaged_ref`.
+   * @param f a functor to be invoked.
+   * @param args arguments passed to the function.
+   * @return [see above]
+   *
+   * @see gch::maybe_invoke
+   */
+  template <typename T, typename Functor, typename ...Args>
+  constexpr
+  typename detail::maybe_invoke_wrap<
+    detail::invoke_referent_result_t<T, Functor, Args...>, engaged_ref, false>::type
+  maybe_invoke (engaged_ref<T> ref, Functor&& f, Args&&... args)
+    noexcept (noexcept (detail::invoke_referent (*ref,
+                                                 std::forward<Functor> (f),
+                                                 std::forward<Args> (args)...)))
+  {
+    using ret_type = typename detail::maybe_invoke_wrap<
+      detail::invoke_referent_result_t<T, Functor, Args...>, engaged_ref, false>::type;
+    return ret_type (detail::invoke_referent (*ref,
+                                              std::forward<Functor> (f),
+                                              std::forward<Args> (args)...));
+  }
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_OPTIONAL_REF_ENGAGED_REF_HPP
@@ -0,0 +1,568 @@
+/** find_ref.hpp
+ * Defines `find_ref`, `at_ref`, `get_if_ref`, and `any_ref`, which look up
+ * an element of a container and return an `optional_ref` to it instead of
+ * an iterator, a pointer, or an exception.
+ *
+ *     if (auto v = gch::find_ref (m, k))
+ *       use (*v);
+ *
+ * Also defines `find_ref_batch`, which looks up many keys in a hash table
+ * at once and overlaps their cache misses.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_OPTIONAL_REF_FIND_REF_HPP
+#define GCH_OPTIONAL_REF_FIND_REF_HPP
+
+#include "core.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#if __cplusplus >= 201703L || (defined (_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#  if defined (__has_include) && __has_include (<any>)
+#    include <any>
+#  endif
+#  if defined (__has_include) && __has_include (<variant>)
+#    include <variant>
+#  endif
+#endif
+
+#if __cplusplus >= 202002L || (defined (_MSVC_LANG) && _MSVC_LANG >= 202002L)
+#  if defined (__has_include) && __has_include (<span>)
+#    include <span>
+#  endif
+#endif
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    template <typename Container, typename Enable = void>
+    struct has_mapped_type
+      : std::false_type
+    { };
+
+    template <typename Container>
+    struct has_mapped_type<
+      Container,
+      typename std::enable_if<
+        std::is_same<typename Container::mapped_type,
+                     typename Container::mapped_type>::value>::type>
+      : std::true_type
+    { };
+
+    template <typename Reference>
+    using ref_to_t = optional_ref<typename std::remove_reference<Reference>::type>;
+
+    template <typename Container, typename Enable = void>
+    struct has_bucket_interface
+      : std::false_type
+    { };
+
+    template <typename Container>
+    struct has_bucket_interface<
+      Container,
+      typename std::enable_if<
+            std::is_convertible<
+              decltype (std::declval<const Container&> ().bucket (
+                std::declval<const typename Container::key_type&> ())),
+              std::size_t>::value
+        &&  std::is_same<typename Container::const_local_iterator,
+                         typename Container::const_local_iterator>::value>::type>
+      : std::true_type
+    { };
+
+    template <typename T, typename Enable = void>
+    struct has_is_transparent
+      : std::false_type
+    { };
+
+    template <typename T>
+    struct has_is_transparent<
+      T,
+      typename std::enable_if<
+        std::is_same<typename T::is_transparent, typename T::is_transparent>::value>::type>
+      : std::true_type
+    { };
+
+    template <typename Container, bool IsMap = has_mapped_type<Container>::value>
+    struct bucket_element_access
+    {
+      using referent_type = const typename Container::value_type;
+
+      static constexpr
+      const typename Container::value_type&
+      key (const typename Container::value_type& element) noexcept
+      {
+        return element;
+      }
+
+      static constexpr
+      const typename Container::value_type&
+      value (const typename Container::value_type& element) noexcept
+      {
+        return element;
+      }
+    };
+
+    template <typename Container>
+    struct bucket_element_access<Container, true>
+    {
+      using referent_type = typename Container::mapped_type;
+
+      static constexpr
+      const typename Container::key_type&
+      key (const typename Container::value_type& element) noexcept
+      {
+        return element.first;
+      }
+
+      static constexpr
+      const typename Container::mapped_type&
+      value (const typename Container::value_type& element) noexcept
+      {
+        return element.second;
+      }
+    };
+
+  }
+
+} // namespace gch
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * Finds the value mapped to a key in an associative container.
+   *
+   * This calls `c.find (key)`, so a container with a transparent comparator
+   * or hash (such as `std::map<std::string, T, std::less<>>`) is searched
+   * with `key` as-is, without constructing a temporary key.
+   *
+   * @tparam Assoc a map type, which has a `mapped_type`.
+   * @tparam Key the type of the key.
+   * @param c a map.
+   * @param key a key.
+   * @return a reference to the mapped value, or an empty `optional_ref`
+   *         if there is no element with the key.
+   */
+  template <typename Assoc, typename Key,
+            typename std::enable_if<detail::has_mapped_type<Assoc>::value>::type * = nullptr>
+  GCH_NODISCARD GCH_CPP14_CONSTEXPR
+  auto
+  find_ref (Assoc& c, const Key& key)
+    -> detail::ref_to_t<decltype ((c.find (key)->second))>
+  {
+    using ret_type = detail::ref_to_t<decltype ((c.find (key)->second))>;
+    auto it = c.find (key);
+    return it != c.end () ? ret_type (it->second) : ret_type ();
+  }
+
+  /**
+   * Finds an element with a key in an associative container without mapped
+   * values (such as a set).
+   *
+   * @tparam Assoc a set type.
+   * @tparam Key the type of the key.
+   * @param c a set.
+   * @param key a key.
+   * @return a reference to the element, or an empty `optional_ref`
+   *         if there is no element with the key.
+   */
+  template <typename Assoc, typename Key,
+            typename std::enable_if<! detail::has_mapped_type<Assoc>::value>::type * = nullptr>
+  GCH_NODISCARD GCH_CPP14_CONSTEXPR
+  auto
+  find_ref (Assoc& c, const Key& key)
+    -> detail::ref_to_t<decltype (*c.find (key))>
+  {
+    using ret_type = detail::ref_to_t<decltype (*c.find (key))>;
+    auto it = c.find (key);
+    return it != c.end () ? ret_type (*it) : ret_type ();
+  }
+
+  /**
+   * A deleted overload for temporary containers, whose elements would not
+   * outlive the result.
+   */
+  template <typename Assoc, typename Key>
+  void
+  find_ref (const Assoc&&, const Key&) = delete;
+
+  /**
+   * Gets the element at an index of a sequence container, with a bounds check.
+   *
+   * @tparam Seq a container with `size ()` and an `operator[]` which returns
+   *             an lvalue reference.
+   * @param c a container.
+   * @param index an index.
+   * @return a reference to the element, or an empty `optional_ref`
+   *         if `index` is out of bounds.
+   */
+  template <typename Seq,
+            typename Reference = decltype (std::declval<Seq&> ()[std::size_t { }]),
+            typename std::enable_if<
+                  std::is_lvalue_reference<Reference>::value
+              &&  std::is_convertible<decltype (std::declval<Seq&> ().size ()),
+                                      std::size_t>::value>::type * = nullptr>
+  GCH_NODISCARD constexpr
+  detail::ref_to_t<Reference>
+  at_ref (Seq& c, std::size_t index)
+    noexcept (noexcept (c.size ()) && noexcept (c[index]))
+  {
+    return index < c.size () ? detail::ref_to_t<Reference> (c[index])
+                             : detail::ref_to_t<Reference> ();
+  }
+
+  /**
+   * Gets the element at an index of an array, with a bounds check.
+   *
+   * @tparam T the type of the elements.
+   * @tparam N the size of the array.
+   * @param a an array.
+   * @param index an index.
+   * @return a reference to the element, or an empty `optional_ref`
+   *         if `index` is out of bounds.
+   */
+  template <typename T, std::size_t N>
+  GCH_NODISCARD constexpr
+  optional_ref<T>
+  at_ref (T (&a)[N], std::size_t index) noexcept
+  {
+    return index < N ? optional_ref<T> (a[index]) : optional_ref<T> ();
+  }
+
+  /**
+   * A deleted overload for temporary containers, whose elements would not
+   * outlive the result.
+   */
+  template <typename Seq>
+  void
+  at_ref (const Seq&&, std::size_t) = delete;
+
+  /**
+   * A customization point for `find_ref_batch`, which splits a lookup in a
+   * hash table into stages so that the stages of many lookups may be
+   * interleaved.
+   *
+   * Specializations must have
+   *
+   *   - a default-constructible type `probe_type`, which holds the state of
+   *     a lookup between stages;
+   *   - `static probe_type start (M& m, const Key& key)`, which hashes the
+   *     key and prefetches the first memory which the lookup will read;
+   *   - `static void advance (M& m, probe_type& probe)`, which reads that
+   *     memory and prefetches the next; and
+   *   - `static optional_ref<V> resolve (M& m, const Key& key, probe_type& probe)`,
+   *     which finishes the lookup,
+   *
+   * where `M` is `Map` or `const Map`. For an open-addressing table, `start`
+   * usually prefetches the slots for the hash, `advance` does nothing, and
+   * `resolve` probes the slots.
+   *
+   * The provided specialization supports containers with a bucket interface,
+   * such as `std::unordered_map` and `std::unordered_set`. Their bucket
+   * arrays are not accessible, so they can not be prefetched. Instead, `start`
+   * only computes the bucket, and `advance` only reads the bucket, so that
+   * the reads of a group are issued back to back and overlap, and prefetches
+   * the first element of the bucket. A key of a type other than `key_type`
+   * requires a transparent `hasher` and `key_equal`, so that it is never
+   * converted to a temporary `key_type`.
+   *
+   * @tparam Map the type of the table, without `const`.
+   */
+  template <typename Map, typename Enable = void>
+  struct find_ref_batch_traits;
+
+  template <typename Map>
+  struct find_ref_batch_traits<
+    Map, typename std::enable_if<detail::has_bucket_interface<Map>::value>::type>
+  {
+    struct probe_type
+    {
+      typename Map::size_type            bucket;
+      typename Map::const_local_iterator first;
+    };
+
+    template <typename M, typename Key,
+              typename std::enable_if<
+                std::is_same<Key, typename Map::key_type>::value>::type * = nullptr>
+    static
+    probe_type
+    start (M& m, const Key& key)
+    {
+      return { m.bucket (key), typename Map::const_local_iterator () };
+    }
+
+    template <typename M, typename Key,
+              typename std::enable_if<
+                ! std::is_same<Key, typename Map::key_type>::value>::type * = nullptr>
+    static
+    probe_type
+    start (M& m, const Key& key)
+    {
+      static_assert (detail::has_is_transparent<typename Map::hasher>::value
+                     &&  detail::has_is_transparent<typename Map::key_equal>::value,
+                     "A key which is not a key_type requires a transparent hasher and key_equal.");
+
+      // `bucket` only takes a `key_type`, so hash the key directly. libstdc++,
+      // libc++, and the MSVC STL all reduce the hash modulo the bucket count.
+      return {
+        static_cast<typename Map::size_type> (m.hash_function () (key) % m.bucket_count ()),
+        typename Map::const_local_iterator ()
+      };
+    }
+
+    template <typename M>
+    static
+    void
+    advance (M& m, probe_type& probe)
+    {
+      probe.first = m.cbegin (probe.bucket);
+      if (probe.first != m.cend (probe.bucket))
+        GCH_PREFETCH (std::addressof (*probe.first));
+    }
+
+    template <typename M, typename Key>
+    static
+    optional_ref<typename std::conditional<
+      std::is_const<M>::value,
+      const typename detail::bucket_element_access<Map>::referent_type,
+      typename detail::bucket_element_access<Map>::referent_type>::type>
+    resolve (M& m, const Key& key, probe_type& probe)
+    {
+      using access     = detail::bucket_element_access<Map>;
+      using value_type = typename std::conditional<std::is_const<M>::value,
+                                                   const typename access::referent_type,
+                                                   typename access::referent_type>::type;
+      using ret_type   = optional_ref<value_type>;
+
+      for (auto it = probe.first; it != m.cend (probe.bucket); ++it)
+      {
+        // The iterator is a const_local_iterator even when `m` is not const.
+        if (m.key_eq () (access::key (*it), key))
+          return ret_type (const_cast<value_type&> (access::value (*it)));
+      }
+      return ret_type ();
+    }
+  };
+
+  /**
+   * Finds the values for a batch of keys in a hash table.
+   *
+   * The keys are processed in groups. Each stage of a lookup (see
+   * `find_ref_batch_traits`) is run for every key of a group before the next
+   * stage, so the cache misses of the lookups in the group overlap instead
+   * of happening one after another. This pays off when the table is much
+   * larger than the cache; for a small table, a loop of `find_ref` is as fast.
+   *
+   * @tparam GroupSize the number of lookups in flight.
+   * @tparam Map the type of the table.
+   * @tparam Key the type of the keys.
+   * @tparam Value the value type of the results.
+   * @param m a table.
+   * @param keys an array of keys.
+   * @param count the number of keys.
+   * @param out an array of `count` refs which receives the results. A result
+   *            is empty if its key is not in the table.
+   */
+  template <std::size_t GroupSize = 16, typename Map, typename Key, typename Value>
+  void
+  find_ref_batch (Map& m, const Key *keys, std::size_t count, optional_ref<Value> *out)
+  {
+    static_assert (GroupSize > 0, "The group size must be positive.");
+
+    using traits = find_ref_batch_traits<typename std::remove_const<Map>::type>;
+
+    typename traits::probe_type probes[GroupSize];
+    for (std::size_t first = 0; first < count; first += GroupSize)
+    {
+      std::size_t n = count - first < GroupSize ? count - first : GroupSize;
+      for (std::size_t i = 0; i < n; ++i)
+        probes[i] = traits::start (m, keys[first + i]);
+      for (std::size_t i = 0; i < n; ++i)
+        traits::advance (m, probes[i]);
+      for (std::size_t i = 0; i < n; ++i)
+        out[first + i] = traits::resolve (m, keys[first + i], probes[i]);
+    }
+  }
+
+#if defined (__cpp_lib_span) && __cpp_lib_span >= 202002L
+
+  /**
+   * Finds the values for a batch of keys in a hash table.
+   *
+   * @see find_ref_batch (Map&, const Key *, std::size_t, optional_ref<Value> *)
+   *
+   * @tparam GroupSize the number of lookups in flight.
+   * @tparam Map the type of the table.
+   * @tparam Key the type of the keys.
+   * @tparam Value the value type of the results.
+   * @param m a table.
+   * @param keys the keys.
+   * @param out the refs which receive the results. It must be at least as
+   *            long as `keys`.
+   */
+  template <std::size_t GroupSize = 16, typename Map, typename Key, std::size_t KeyExtent,
+            typename Value, std::size_t OutExtent>
+  void
+  find_ref_batch (Map& m, std::span<const Key, KeyExtent> keys,
+                  std::span<optional_ref<Value>, OutExtent> out)
+  {
+    find_ref_batch<GroupSize> (m, keys.data (), keys.size (), out.data ());
+  }
+
+#endif
+
+#if defined (__cpp_lib_variant) && __cpp_lib_variant >= 201606L
+
+  /**
+   * Gets the alternative of a `std::variant` with a type, if it is active.
+   *
+   * @tparam Alt the type of the alternative.
+   * @tparam Ts the types of the alternatives of the variant.
+   * @param v a variant.
+   * @return a reference to the alternative, or an empty `optional_ref`
+   *         if another alternative is active.
+   */
+  template <typename Alt, typename ...Ts>
+  GCH_NODISCARD constexpr
+  optional_ref<Alt>
+  get_if_ref (std::variant<Ts...>& v) noexcept
+  {
+    return optional_ref<Alt> (std::get_if<Alt> (&v));
+  }
+
+  /**
+   * Gets the alternative of a `std::variant` with a type, if it is active.
+   *
+   * @tparam Alt the type of the alternative.
+   * @tparam Ts the types of the alternatives of the variant.
+   * @param v a variant.
+   * @return a reference to the alternative, or an empty `optional_ref`
+   *         if another alternative is active.
+   */
+  template <typename Alt, typename ...Ts>
+  GCH_NODISCARD constexpr
+  optional_ref<const Alt>
+  get_if_ref (const std::variant<Ts...>& v) noexcept
+  {
+    return optional_ref<const Alt> (std::get_if<Alt> (&v));
+  }
+
+  /**
+   * Gets the alternative of a `std::variant` at an index, if it is active.
+   *
+   * @tparam I the index of the alternative.
+   * @tparam Ts the types of the alternatives of the variant.
+   * @param v a variant.
+   * @return a reference to the alternative, or an empty `optional_ref`
+   *         if another alternative is active.
+   */
+  template <std::size_t I, typename ...Ts>
+  GCH_NODISCARD constexpr
+  optional_ref<std::variant_alternative_t<I, std::variant<Ts...>>>
+  get_if_ref (std::variant<Ts...>& v) noexcept
+  {
+    return optional_ref<std::variant_alternative_t<I, std::variant<Ts...>>> (
+      std::get_if<I> (&v));
+  }
+
+  /**
+   * Gets the alternative of a `std::variant` at an index, if it is active.
+   *
+   * @tparam I the index of the alternative.
+   * @tparam Ts the types of the alternatives of the variant.
+   * @param v a variant.
+   * @return a reference to the alternative, or an empty `optional_ref`
+   *         if another alternative is active.
+   */
+  template <std::size_t I, typename ...Ts>
+  GCH_NODISCARD constexpr
+  optional_ref<const std::variant_alternative_t<I, std::variant<Ts...>>>
+  get_if_ref (const std::variant<Ts...>& v) noexcept
+  {
+    return optional_ref<const std::variant_alternative_t<I, std::variant<Ts...>>> (
+      std::get_if<I> (&v));
+  }
+
+  /**
+   * A deleted overload for temporary variants.
+   */
+  template <typename Alt, typename ...Ts>
+  void
+  get_if_ref (const std::variant<Ts...>&&) = delete;
+
+  /**
+   * A deleted overload for temporary variants.
+   */
+  template <std::size_t I, typename ...Ts>
+  void
+  get_if_ref (const std::variant<Ts...>&&) = delete;
+
+#endif
+
+#if defined (__cpp_lib_any) && __cpp_lib_any >= 201606L
+
+  /**
+   * Gets the object held by a `std::any`, if it has the type `T`.
+   *
+   * @tparam T the type of the object.
+   * @param a an `any`.
+   * @return a reference to the object, or an empty `optional_ref`
+   *         if `a` is empty or holds another type.
+   */
+  template <typename T>
+  GCH_NODISCARD inline
+  optional_ref<T>
+  any_ref (std::any& a) noexcept
+  {
+    return optional_ref<T> (std::any_cast<T> (&a));
+  }
+
+  /**
+   * Gets the object held by a `std::any`, if it has the type `T`.
+   *
+   * @tparam T the type of the object.
+   * @param a an `any`.
+   * @return a reference to the object, or an empty `optional_ref`
+   *         if `a` is empty or holds another type.
+   */
+  template <typename T>
+  GCH_NODISCARD inline
+  optional_ref<const T>
+  any_ref (const std::any& a) noexcept
+  {
+    return optional_ref<const T> (std::any_cast<T> (&a));
+  }
+
+  /**
+   * A deleted overload for temporary `any`s.
+   */
+  template <typename T>
+  void
+  any_ref (const std::any&&) = delete;
+
+#endif
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_OPTIONAL_REF_FIND_REF_HPP
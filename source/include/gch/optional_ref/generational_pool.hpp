@@ -0,0 +1,556 @@
+/** generational_pool.hpp
+ * Defines `generational_pool` and `checked_optional_ref`.
+ *
+ * A `checked_optional_ref` refers to an object in a `generational_pool` and
+ * stores the generation of the slot at the time the object was created. Once
+ * the object is erased, the generation of the slot changes and the reference
+ * stops having a value, so dangling accesses are detected with one extra
+ * comparison instead of being undefined behavior.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_OPTIONAL_REF_GENERATIONAL_POOL_HPP
+#define GCH_OPTIONAL_REF_GENERATIONAL_POOL_HPP
+
+#include "core.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#ifdef GCH_EXCEPTIONS
+#  include <exception>
+#else
+#  include <cstdio>
+#  include <cstdlib>
+#endif
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  template <typename T>
+  class generational_pool;
+
+  template <typename T>
+  class checked_optional_ref;
+
+#ifdef GCH_EXCEPTIONS
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wweak-vtables" // Ignore warnings about virtual methods.
+#endif
+
+  /**
+   * An exception class for accesses through a `checked_optional_ref`
+   * whose referent has been erased from its pool.
+   */
+  class dangling_optional_ref_access
+    : public bad_optional_access
+  {
+  public:
+    /**
+     * Returns an error string.
+     *
+     * @return the error string.
+     */
+    GCH_NODISCARD
+    const char *
+    what (void) const noexcept override
+    {
+      return "Cannot access the referent of a checked_optional_ref after it was erased.";
+    }
+  };
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif
+
+} // namespace gch
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    template <typename T>
+    struct generational_slot
+    {
+      // Odd while the slot holds an object. A slot whose generation would wrap
+      // around is retired instead of being reused.
+      std::uint32_t generation = 0;
+      generational_slot *next_free = nullptr;
+      alignas (T) unsigned char data[sizeof (T)];
+
+      GCH_NODISCARD
+      bool
+      is_occupied (void) const noexcept
+      {
+        return (generation & 1U) != 0;
+      }
+
+      GCH_NODISCARD
+      T *
+      get_pointer (void) noexcept
+      {
+        return reinterpret_cast<T *> (data);
+      }
+    };
+
+    // Kept out of line so that `checked_optional_ref::value` only contains a test and a call.
+    [[noreturn]] GCH_COLD GCH_NOINLINE inline
+    void
+    checked_optional_ref_failure (bool is_dangling)
+    {
+      if (! is_dangling)
+        bad_optional_access_failure ();
+
+      if (bad_optional_access_handler handler = get_bad_optional_access_handler ())
+        handler ();
+
+#ifdef GCH_EXCEPTIONS
+      throw dangling_optional_ref_access { };
+#else
+      std::fprintf (
+        stderr,
+        "[gch::optional_ref] Cannot access the referent of a checked_optional_ref after it was "
+        "erased.\n");
+      std::abort ();
+#endif
+    }
+
+  }
+
+} // namespace gch
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * An optional reference to an object in a `generational_pool`.
+   *
+   * The reference has no value if it was never bound, or if its referent
+   * has been erased from the pool (even if the slot has since been reused).
+   * Accessing the value costs one comparison more than `optional_ref`.
+   * It converts to an unchecked `optional_ref` for use in hot loops.
+   *
+   * Note: The checks are not synchronized. Erasing a referent concurrently
+   *       with an access through a `checked_optional_ref` is a data race.
+   *
+   * @tparam ValueType the value type of the referent.
+   */
+  template <typename ValueType>
+  class checked_optional_ref
+  {
+    using slot_type = detail::generational_slot<typename std::remove_const<ValueType>::type>;
+
+    template <typename U>
+    friend class checked_optional_ref;
+
+    template <typename U>
+    friend class generational_pool;
+
+  public:
+    using value_type = ValueType;   /*!< The value type of the referent */
+    using reference  = ValueType&;  /*!< The reference type             */
+    using pointer    = ValueType *; /*!< The pointer type               */
+
+    /**
+     * Constructor
+     *
+     * The `checked_optional_ref` has no value after default
+     * construction.
+     */
+    checked_optional_ref (void) noexcept = default;
+
+    /**
+     * Constructor
+     *
+     * Constructs a `checked_optional_ref` with no value.
+     */
+    constexpr /* implicit */
+    checked_optional_ref (nullopt_t) noexcept
+    { }
+
+    /**
+     * Constructor
+     *
+     * A converting constructor for adding const-qualification.
+     *
+     * @tparam U the value type of `other`.
+     * @param other a `checked_optional_ref` to a non-const referent.
+     */
+    template <typename U,
+              typename std::enable_if<std::is_same<const U, ValueType>::value
+                                  &&! std::is_same<U, ValueType>::value>::type * = nullptr>
+    constexpr /* implicit */
+    checked_optional_ref (const checked_optional_ref<U>& other) noexcept
+      : m_slot       (other.m_slot),
+        m_generation (other.m_generation)
+    { }
+
+    /**
+     * Checks if the `*this` contains a value.
+     *
+     * This is a check against `nullptr` and a comparison of the
+     * generation of the slot.
+     *
+     * @return whether this `*this` contains a value.
+     */
+    GCH_NODISCARD
+    bool
+    has_value (void) const noexcept
+    {
+      return m_slot != nullptr && m_slot->generation == m_generation;
+    }
+
+    /**
+     * Checks if the `*this` contains a value.
+     *
+     * The return is forwarded from `has_value ()`.
+     *
+     * @return whether this `*this` contains a value.
+     */
+    GCH_NODISCARD explicit
+    operator bool (void) const noexcept
+    {
+      return has_value ();
+    }
+
+    /**
+     * Checks if the `*this` was bound to a referent which has since been erased.
+     *
+     * @return whether `*this` is dangling.
+     */
+    GCH_NODISCARD
+    bool
+    is_dangling (void) const noexcept
+    {
+      return m_slot != nullptr && m_slot->generation != m_generation;
+    }
+
+    /**
+     * Returns a pointer to the referent, or `nullptr` if there is no value.
+     *
+     * @return a pointer to the referent.
+     */
+    GCH_NODISCARD
+    pointer
+    get_pointer (void) const noexcept
+    {
+      return has_value () ? m_slot->get_pointer () : nullptr;
+    }
+
+    /**
+     * Returns the referent.
+     *
+     * The behavior is undefined if `*this` has no value.
+     *
+     * @return the referent.
+     */
+    GCH_NODISCARD
+    reference
+    operator* (void) const noexcept
+    {
+      return *m_slot->get_pointer ();
+    }
+
+    /**
+     * Returns a pointer to the referent.
+     *
+     * The behavior is undefined if `*this` has no value.
+     *
+     * @return a pointer to the referent.
+     */
+    GCH_NODISCARD
+    pointer
+    operator-> (void) const noexcept
+    {
+      return m_slot->get_pointer ();
+    }
+
+    /**
+     * Returns the referent, while checking whether it exists.
+     *
+     * @throws bad_optional_access when `*this` was never bound.
+     * @throws dangling_optional_ref_access when the referent has been erased.
+     *
+     * @see gch::set_bad_optional_access_handler
+     *
+     * @return the referent.
+     */
+    GCH_NODISCARD
+    reference
+    value (void) const
+    {
+      if (! has_value ())
+        detail::checked_optional_ref_failure (m_slot != nullptr);
+      return *m_slot->get_pointer ();
+    }
+
+    /**
+     * Returns the referent, or a default.
+     *
+     * @tparam U a reference type convertible to `reference`.
+     * @param default_value the value returned if `*this` does not contain a value.
+     * @return the referent, or `default_value` if `*this` does not contain a value.
+     */
+    template <typename U>
+    GCH_NODISCARD
+    reference
+    value_or (U& default_value) const noexcept
+    {
+      return has_value () ? *m_slot->get_pointer () : static_cast<reference> (default_value);
+    }
+
+    /**
+     * Removes the reference.
+     */
+    void
+    reset (void) noexcept
+    {
+      m_slot       = nullptr;
+      m_generation = 0;
+    }
+
+    /**
+     * Converts to an unchecked `optional_ref`.
+     *
+     * The result has no value if `*this` has no value. It is not
+     * invalidated when the referent is erased.
+     *
+     * @return an `optional_ref` to the referent.
+     */
+    GCH_NODISCARD /* implicit */
+    operator optional_ref<value_type> (void) const noexcept
+    {
+      return optional_ref<value_type> { get_pointer () };
+    }
+
+    /**
+     * Compares with another `checked_optional_ref`.
+     *
+     * Two `checked_optional_ref`s are equal if they refer to the
+     * same slot in the same generation.
+     *
+     * @param lhs a `checked_optional_ref`.
+     * @param rhs a `checked_optional_ref`.
+     * @return whether `lhs` and `rhs` are equal.
+     */
+    GCH_NODISCARD friend
+    bool
+    operator== (const checked_optional_ref& lhs, const checked_optional_ref& rhs) noexcept
+    {
+      return lhs.m_slot == rhs.m_slot && lhs.m_generation == rhs.m_generation;
+    }
+
+    /**
+     * Compares with another `checked_optional_ref`.
+     *
+     * @param lhs a `checked_optional_ref`.
+     * @param rhs a `checked_optional_ref`.
+     * @return whether `lhs` and `rhs` are not equal.
+     */
+    GCH_NODISCARD friend
+    bool
+    operator!= (const checked_optional_ref& lhs, const checked_optional_ref& rhs) noexcept
+    {
+      return ! (lhs == rhs);
+    }
+
+  private:
+    checked_optional_ref (slot_type *slot, std::uint32_t generation) noexcept
+      : m_slot       (slot),
+        m_generation (generation)
+    { }
+
+    slot_type     *m_slot       = nullptr;
+    std::uint32_t  m_generation = 0;
+  };
+
+  /**
+   * A pool of objects which hands out `checked_optional_ref`s.
+   *
+   * Objects never move once created, and erased slots are reused. Every slot
+   * holds a generation counter which is incremented whenever an object is
+   * created or erased, so references to an erased object can be detected.
+   * A slot is retired after about two billion reuses rather than wrapping
+   * the counter.
+   *
+   * Note: The pool is not synchronized and uses no atomic operations.
+   *
+   * @tparam T the type of the objects.
+   */
+  template <typename T>
+  class generational_pool
+  {
+    static_assert (! std::is_const<T>::value && ! std::is_reference<T>::value,
+                   "generational_pool expects a non-const object type.");
+
+    using slot_type = detail::generational_slot<T>;
+
+  public:
+    using value_type      = T;                             /*!< The type of the objects      */
+    using size_type       = std::size_t;                   /*!< An unsigned integral type    */
+    using handle          = checked_optional_ref<T>;       /*!< A reference to an object     */
+    using const_handle    = checked_optional_ref<const T>; /*!< A reference to a const object */
+
+    /**
+     * Constructor
+     *
+     * Constructs an empty pool.
+     */
+    generational_pool (void) = default;
+
+    generational_pool (const generational_pool&)            = delete;
+    generational_pool (generational_pool&&)                 = delete;
+    generational_pool& operator= (const generational_pool&) = delete;
+    generational_pool& operator= (generational_pool&&)      = delete;
+
+    /**
+     * Destructor
+     *
+     * Destroys every object which has not been erased. Any
+     * remaining `checked_optional_ref`s must not be used after this.
+     */
+    ~generational_pool (void)
+    {
+      clear ();
+    }
+
+    /**
+     * Creates an object in the pool.
+     *
+     * @tparam Args the types of the constructor arguments.
+     * @param args the constructor arguments.
+     * @return a reference to the new object.
+     */
+    template <typename ...Args>
+    handle
+    emplace (Args&&... args)
+    {
+      if (m_free == nullptr)
+      {
+        m_slots.emplace_back ();
+        m_free = &m_slots.back ();
+      }
+
+      slot_type *slot = m_free;
+      ::new (static_cast<void *> (slot->get_pointer ())) T (std::forward<Args> (args)...);
+
+      m_free = slot->next_free;
+      slot->next_free = nullptr;
+      ++slot->generation;
+      ++m_size;
+      return handle { slot, slot->generation };
+    }
+
+    /**
+     * Erases the referent of a handle.
+     *
+     * Every `checked_optional_ref` to the object stops having a value.
+     *
+     * @param h a reference to an object in this pool.
+     * @return whether an object was erased (`false` if `h` had no value).
+     */
+    bool
+    erase (const_handle h) noexcept
+    {
+      if (! h.has_value ())
+        return false;
+
+      slot_type *slot = h.m_slot;
+      slot->get_pointer ()->~T ();
+      --m_size;
+
+      if (slot->generation == UINT32_MAX)
+        slot->generation = 0;
+      else
+      {
+        ++slot->generation;
+        slot->next_free = m_free;
+        m_free = slot;
+      }
+      return true;
+    }
+
+    /**
+     * Erases every object in the pool.
+     *
+     * Every `checked_optional_ref` into the pool stops having a value.
+     * The slots are kept for reuse.
+     */
+    void
+    clear (void) noexcept
+    {
+      for (slot_type& slot : m_slots)
+      {
+        if (slot.is_occupied ())
+          erase (const_handle { &slot, slot.generation });
+      }
+    }
+
+    /**
+     * Returns the number of objects in the pool.
+     *
+     * @return the number of objects.
+     */
+    GCH_NODISCARD
+    size_type
+    size (void) const noexcept
+    {
+      return m_size;
+    }
+
+    /**
+     * Checks whether the pool has no objects.
+     *
+     * @return whether the pool is empty.
+     */
+    GCH_NODISCARD
+    bool
+    empty (void) const noexcept
+    {
+      return m_size == 0;
+    }
+
+    /**
+     * Returns the number of slots which have been allocated.
+     *
+     * @return the number of slots.
+     */
+    GCH_NODISCARD
+    size_type
+    capacity (void) const noexcept
+    {
+      return m_slots.size ();
+    }
+
+  private:
+    std::deque<slot_type>  m_slots;
+    slot_type             *m_free = nullptr;
+    size_type              m_size = 0;
+  };
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_OPTIONAL_REF_GENERATIONAL_POOL_HPP
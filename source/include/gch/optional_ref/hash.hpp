@@ -0,0 +1,55 @@
+/** hash.hpp
+ * Defines the specialization of `std::hash` for `optional_ref`.
+ *
+ * Copyright © 2019 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_OPTIONAL_REF_HASH_HPP
+#define GCH_OPTIONAL_REF_HASH_HPP
+
+#include "core.hpp"
+
+#include <cstddef>
+#include <functional>
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace std
+{
+
+  /**
+   * A specialization of `std::hash` for `gch::optional_ref`.
+   *
+   * @tparam T the value type of `gch::optional_ref`.
+   */
+  template <typename T>
+  struct hash<gch::optional_ref<T>>
+  {
+    /**
+     * An invocable operator.
+     *
+     * We just use the same hash as the underlying pointer.
+     *
+     * @param opt_ref a reference to a value of type `gch::optional_ref`.
+     * @return a hash of the argument.
+     */
+    std::size_t
+    operator() (const gch::optional_ref<T>& opt_ref) const noexcept
+    {
+      return std::hash<typename gch::optional_ref<T>::pointer> { } (opt_ref.get_pointer ());
+    }
+  };
+
+} // namespace std
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_OPTIONAL_REF_HASH_HPP
@@ -0,0 +1,216 @@
+/** identity_first.hpp
+ * Defines comparators for `optional_ref` which compare the stored pointers
+ * before comparing the referents.
+ *
+ * The comparison operators of `optional_ref` always compare by value. When
+ * the referents are expensive to compare and many references alias the same
+ * object (as in deduplication or joins), these comparators skip the value
+ * comparison whenever both references hold the same pointer.
+ *
+ * Note: These are not equivalent to the comparison operators for types in
+ *       which a value does not compare equal to itself (such as floating
+ *       point NaN). Two references to the same NaN compare equal here, and
+ *       equivalent in a three-way comparison, while `operator==` reports that
+ *       they are not equal and `operator<=>` reports that they are unordered.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_OPTIONAL_REF_IDENTITY_FIRST_HPP
+#define GCH_OPTIONAL_REF_IDENTITY_FIRST_HPP
+
+#include "core.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * An equality comparator which checks `equal_pointer` before
+   * comparing by value.
+   *
+   * This may be used as the `KeyEqual` of an unordered container
+   * along with `identity_first_hash`.
+   */
+  struct identity_first_equal
+  {
+    using is_transparent = void; /*!< Enables heterogeneous lookup */
+
+    /**
+     * Compares two `optional_ref`s.
+     *
+     * @tparam T the value type of `lhs`.
+     * @tparam U the value type of `rhs`.
+     * @param lhs an `optional_ref`.
+     * @param rhs an `optional_ref`.
+     * @return whether `lhs` and `rhs` hold the same pointer, or otherwise
+     *         the result of `lhs == rhs`.
+     */
+    template <typename T, typename U>
+    GCH_NODISCARD constexpr
+    bool
+    operator() (optional_ref<T> lhs, optional_ref<U> rhs) const
+      noexcept (noexcept (lhs == rhs))
+    {
+      return lhs.equal_pointer (rhs) || lhs == rhs;
+    }
+  };
+
+  /**
+   * A less-than comparator which checks `equal_pointer` before
+   * comparing by value.
+   *
+   * This may be used as the `Compare` of an ordered container.
+   */
+  struct identity_first_less
+  {
+    using is_transparent = void; /*!< Enables heterogeneous lookup */
+
+    /**
+     * Compares two `optional_ref`s.
+     *
+     * @tparam T the value type of `lhs`.
+     * @tparam U the value type of `rhs`.
+     * @param lhs an `optional_ref`.
+     * @param rhs an `optional_ref`.
+     * @return `false` if `lhs` and `rhs` hold the same pointer, or otherwise
+     *         the result of `lhs < rhs`.
+     */
+    template <typename T, typename U>
+    GCH_NODISCARD constexpr
+    bool
+    operator() (optional_ref<T> lhs, optional_ref<U> rhs) const
+      noexcept (noexcept (lhs < rhs))
+    {
+      return ! lhs.equal_pointer (rhs) && lhs < rhs;
+    }
+  };
+
+#ifdef GCH_LIB_THREE_WAY_COMPARISON
+
+  /**
+   * A three-way comparator which checks `equal_pointer` before
+   * comparing by value.
+   */
+  struct identity_first_three_way
+  {
+    using is_transparent = void; /*!< Enables heterogeneous lookup */
+
+    /**
+     * Compares two `optional_ref`s.
+     *
+     * @tparam T the value type of `lhs`.
+     * @tparam U the value type of `rhs`.
+     * @param lhs an `optional_ref`.
+     * @param rhs an `optional_ref`.
+     * @return `equivalent` if `lhs` and `rhs` hold the same pointer, or
+     *         otherwise the result of `lhs <=> rhs`.
+     */
+    template <typename T, std::three_way_comparable_with<T> U>
+    GCH_NODISCARD constexpr
+    std::compare_three_way_result_t<T, U>
+    operator() (optional_ref<T> lhs, optional_ref<U> rhs) const
+      noexcept (noexcept (lhs <=> rhs))
+    {
+      using result_type = std::compare_three_way_result_t<T, U>;
+      return lhs.equal_pointer (rhs) ? result_type::equivalent : (lhs <=> rhs);
+    }
+  };
+
+#endif
+
+} // namespace gch
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    struct identity_first_std_hash
+    {
+      template <typename T>
+      std::size_t
+      operator() (const T& value) const
+        noexcept (noexcept (std::hash<typename std::remove_cv<T>::type> { } (value)))
+      {
+        return std::hash<typename std::remove_cv<T>::type> { } (value);
+      }
+    };
+
+  }
+
+} // namespace gch
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * A hash of the referent of an `optional_ref`, which is consistent
+   * with `identity_first_equal`.
+   *
+   * Note that `std::hash<optional_ref<T>>` hashes the pointer, which is
+   * only consistent with `equal_pointer`.
+   *
+   * @tparam Hash a hash for the value type of the `optional_ref`s. By
+   *              default, `std::hash` of the value type.
+   */
+  template <typename Hash = detail::identity_first_std_hash>
+  struct identity_first_hash
+  {
+    using is_transparent = void; /*!< Enables heterogeneous lookup */
+
+    /**
+     * Default constructor
+     */
+    identity_first_hash (void) = default;
+
+    /**
+     * Constructor
+     *
+     * @param hash the hash for the value type.
+     */
+    explicit
+    identity_first_hash (const Hash& hash)
+      : m_hash (hash)
+    { }
+
+    /**
+     * Hashes the referent of an `optional_ref`.
+     *
+     * @tparam T the value type of `ref`.
+     * @param ref an `optional_ref`.
+     * @return the hash of the referent, or `0` if `ref` has no value.
+     */
+    template <typename T>
+    GCH_NODISCARD
+    std::size_t
+    operator() (optional_ref<T> ref) const
+      noexcept (noexcept (std::declval<const Hash&> () (*ref)))
+    {
+      return ref.has_value () ? m_hash (*ref) : 0U;
+    }
+
+  private:
+    // A member rather than a base, so that `Hash` may be final.
+    Hash m_hash { };
+  };
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_OPTIONAL_REF_IDENTITY_FIRST_HPP
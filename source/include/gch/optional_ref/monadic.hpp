@@ -0,0 +1,1192 @@
+/** monadic.hpp
+ * Defines `maybe_invoke` and the monadic operators for `optional_ref`.
+ *
+ * Copyright © 2019 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_OPTIONAL_REF_MONADIC_HPP
+#define GCH_OPTIONAL_REF_MONADIC_HPP
+
+#include "core.hpp"
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#if __cplusplus >= 201703L || (defined (_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#  if defined (__has_include) && __has_include (<optional>)
+#    include <optional>
+#  endif
+#endif
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * Determines whether the given types may be used in a call to
+   * `maybe_invoke`.
+   *
+   * @tparam Optional a monadic optional type.
+   * @tparam Functor a functor type
+   * @tparam Args the types of arguments used in a call to `maybe_invoke`.
+   */
+  template <typename Optional, typename Functor, typename ...Args>
+  struct is_maybe_invocable;
+
+  /**
+   * Determines whether the given types may be used in a noexcept call to
+   * `maybe_invoke`.
+   *
+   * @tparam Optional a monadic optional type.
+   * @tparam Functor a functor type
+   * @tparam Args the types of arguments used in a call to `maybe_invoke`.
+   */
+  template <typename Optional, typename Functor, typename ...Args>
+  struct is_nothrow_maybe_invocable;
+
+  /**
+   * Deduces the return type of a call to `maybe_invoke`.
+   *
+   * Contains the member type `type` only if an object of type `Optional`
+   * may be used in a call to `maybe_invoke` with a functor of type
+   * `Functor`, and arguments `Args...`.
+   *
+   * In other words, the value of
+   * `is_maybe_invocable<Optional, Functor, Args...>` must be equal to `true`.
+   *
+   * @tparam Optional a monadic optional type.
+   * @tparam Functor a functor type
+   * @tparam Args the types of arguments used in a call to `maybe_invoke`.
+   */
+  template <typename Optional, typename Functor, typename ...Args>
+  struct maybe_invoke_result;
+
+  /**
+   * A convenience alias for `maybe_invoke_result`.
+   *
+   * @tparam Optional a monadic optional type.
+   * @tparam Functor a functor type
+   * @tparam Args the types of arguments used in a call to `maybe_invoke`.
+   */
+  template <typename Optional, typename Functor, typename ...Args>
+  using maybe_invoke_result_t = typename maybe_invoke_result<Optional, Functor, Args...>::type;
+
+  /**
+   * Determines whether the type may be used as a return type in a
+   * `maybe_invoke` expression.
+   *
+   * Valid return types must either not be object types, or
+   * default constructible.
+   *
+   * @tparam Result the return type of a call to `maybe_invoke`.
+   */
+  template <typename Result>
+  struct is_valid_maybe_invoke_result;
+
+#ifdef GCH_VARIABLE_TEMPLATES
+
+  template <typename Optional, typename Functor, typename ...Args>
+  GCH_INLINE_VARIABLE constexpr
+  bool
+  is_maybe_invocable_v = is_maybe_invocable<Optional, Functor, Args...>::value;
+
+  template <typename Optional, typename Functor, typename ...Args>
+  GCH_INLINE_VARIABLE constexpr
+  bool
+  is_nothrow_maybe_invocable_v = is_nothrow_maybe_invocable<Optional, Functor, Args...>::value;
+
+  template <typename Result>
+  GCH_INLINE_VARIABLE constexpr
+  bool
+  is_valid_maybe_invoke_result_v = is_valid_maybe_invoke_result<Result>::value;
+
+#endif
+
+} // namespace gch
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    template <typename Result, typename Enable = void>
+    struct is_valid_maybe_invoke_result_impl
+      : std::false_type
+    { };
+
+    template <typename Result>
+    struct is_valid_maybe_invoke_result_impl<
+          Result,
+          typename std::enable_if<! std::is_object<Result>::value
+                                ||  std::is_default_constructible<Result>::value>::type>
+      : std::true_type
+    { };
+
+#ifdef GCH_CONCEPTS
+
+    template <typename T>
+    using remove_cvref_t = typename std::remove_cv<typename std::remove_reference<T>::type>::type;
+
+#endif
+
+    // Maps the result of an invocation to the return type of `maybe_invoke`.
+    // See the documentation of `maybe_invoke` for the mapping. An lvalue
+    // reference `U&` maps to `Ref<U>`. If the result may be empty, an object
+    // must be default constructible, since that is the empty result.
+    template <typename Result,
+              template <typename> class Ref = optional_ref,
+              bool MayBeEmpty = true,
+              typename Enable = void>
+    struct maybe_invoke_wrap
+    {
+      using type = void;
+    };
+
+#ifdef GCH_CONCEPTS
+
+    template <typename Result, template <typename> class Ref, bool MayBeEmpty>
+    requires std::is_lvalue_reference<Result>::value
+    struct maybe_invoke_wrap<Result, Ref, MayBeEmpty>
+    {
+      using type = Ref<typename std::remove_reference<Result>::type>;
+    };
+
+    template <typename Result, template <typename> class Ref, bool MayBeEmpty>
+    requires std::is_object<Result>::value
+    struct maybe_invoke_wrap<Result, Ref, MayBeEmpty>
+      : std::enable_if<! MayBeEmpty || std::is_default_constructible<Result>::value, Result>
+    { };
+
+    // Invokes a functor on a referent. The functor may be a pointer to member
+    // function, a pointer to member object, or anything else callable with
+    // the referent as its first argument.
+    template <typename T, typename Functor, typename ...Args>
+    requires std::is_member_function_pointer<remove_cvref_t<Functor>>::value
+    constexpr
+    auto
+    invoke_referent (T& ref, Functor&& f, Args&&... args)
+      noexcept (noexcept ((ref.*f) (std::forward<Args> (args)...)))
+      -> decltype ((ref.*f) (std::forward<Args> (args)...))
+    {
+      return (ref.*f) (std::forward<Args> (args)...);
+    }
+
+    template <typename T, typename Functor>
+    requires std::is_member_object_pointer<remove_cvref_t<Functor>>::value
+    constexpr
+    auto
+    invoke_referent (T& ref, Functor&& m) noexcept
+      -> decltype (ref.*m)
+    {
+      return ref.*m;
+    }
+
+    template <typename T, typename Functor, typename ...Args>
+    requires (! std::is_member_pointer<remove_cvref_t<Functor>>::value)
+    constexpr
+    auto
+    invoke_referent (T& ref, Functor&& f, Args&&... args)
+      noexcept (noexcept (std::forward<Functor> (f) (ref, std::forward<Args> (args)...)))
+      -> decltype (std::forward<Functor> (f) (ref, std::forward<Args> (args)...))
+    {
+      return std::forward<Functor> (f) (ref, std::forward<Args> (args)...);
+    }
+
+#else
+
+    template <typename Result, template <typename> class Ref, bool MayBeEmpty>
+    struct maybe_invoke_wrap<
+      Result, Ref, MayBeEmpty,
+      typename std::enable_if<std::is_lvalue_reference<Result>::value>::type>
+    {
+      using type = Ref<typename std::remove_reference<Result>::type>;
+    };
+
+    template <typename Result, template <typename> class Ref, bool MayBeEmpty>
+    struct maybe_invoke_wrap<
+      Result, Ref, MayBeEmpty,
+      typename std::enable_if<std::is_object<Result>::value>::type>
+      : std::enable_if<! MayBeEmpty || std::is_default_constructible<Result>::value, Result>
+    { };
+
+    // Invokes a functor on a referent. The functor may be a pointer to member
+    // function, a pointer to member object, or anything else callable with
+    // the referent as its first argument.
+    template <typename T, typename Functor, typename ...Args>
+    constexpr
+    auto
+    invoke_referent (T& ref, Functor&& f, Args&&... args)
+      noexcept (noexcept ((ref.*f) (std::forward<Args> (args)...)))
+      -> typename std::enable_if<
+           std::is_member_function_pointer<typename std::decay<Functor>::type>::value,
+           decltype ((ref.*f) (std::forward<Args> (args)...))>::type
+    {
+      return (ref.*f) (std::forward<Args> (args)...);
+    }
+
+    template <typename T, typename Functor>
+    constexpr
+    auto
+    invoke_referent (T& ref, Functor&& m) noexcept
+      -> typename std::enable_if<
+           std::is_member_object_pointer<typename std::decay<Functor>::type>::value,
+           decltype (ref.*m)>::type
+    {
+      return ref.*m;
+    }
+
+    template <typename T, typename Functor, typename ...Args>
+    constexpr
+    auto
+    invoke_referent (T& ref, Functor&& f, Args&&... args)
+      noexcept (noexcept (std::forward<Functor> (f) (ref, std::forward<Args> (args)...)))
+      -> typename std::enable_if<
+           ! std::is_member_pointer<typename std::decay<Functor>::type>::value,
+           decltype (std::forward<Functor> (f) (ref, std::forward<Args> (args)...))>::type
+    {
+      return std::forward<Functor> (f) (ref, std::forward<Args> (args)...);
+    }
+
+#endif
+
+    template <typename T, typename Functor, typename ...Args>
+    using invoke_referent_result_t = decltype (invoke_referent (std::declval<T&> (),
+                                                                std::declval<Functor> (),
+                                                                std::declval<Args> ()...));
+
+  }
+
+} // namespace gch
+
+#ifdef GCH_CONCEPTS
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    template <typename T, typename Functor, typename ...Args>
+    struct maybe_invoke_result_optional_ref
+    { };
+
+    template <typename T, typename Functor, typename ...Args>
+    requires requires { typename invoke_referent_result_t<T, Functor, Args...>; }
+    struct maybe_invoke_result_optional_ref<T, Functor, Args...>
+      : maybe_invoke_wrap<invoke_referent_result_t<T, Functor, Args...>>
+    { };
+
+    template <typename T, typename Functor, typename ...Args>
+    concept maybe_invocable_optional_ref =
+      requires { typename maybe_invoke_result_optional_ref<T, Functor, Args...>::type; };
+
+    template <typename T, typename Functor, typename ...Args>
+    concept nothrow_maybe_invocable_optional_ref =
+          maybe_invocable_optional_ref<T, Functor, Args...>
+      &&  noexcept (invoke_referent (std::declval<T&> (),
+                                     std::declval<Functor> (),
+                                     std::declval<Args> ()...));
+
+    template <typename Optional>
+    concept optional_ref_cvref = is_optional_ref<remove_cvref_t<Optional>>::value;
+
+  }
+
+} // namespace gch
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  template <detail::optional_ref_cvref Optional, typename Functor, typename ...Args>
+  struct is_maybe_invocable<Optional, Functor, Args...>
+    : std::integral_constant<bool,
+        detail::maybe_invocable_optional_ref<
+          typename detail::remove_cvref_t<Optional>::value_type, Functor, Args...>>
+  { };
+
+  template <detail::optional_ref_cvref Optional, typename Functor, typename ...Args>
+  struct is_nothrow_maybe_invocable<Optional, Functor, Args...>
+    : std::integral_constant<bool,
+        detail::nothrow_maybe_invocable_optional_ref<
+          typename detail::remove_cvref_t<Optional>::value_type, Functor, Args...>>
+  { };
+
+  template <detail::optional_ref_cvref Optional, typename Functor, typename ...Args>
+  struct maybe_invoke_result<Optional, Functor, Args...>
+    : detail::maybe_invoke_result_optional_ref<
+        typename detail::remove_cvref_t<Optional>::value_type, Functor, Args...>
+  { };
+
+#else
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    template <typename T, typename Type, typename Base, typename ...Args>
+    constexpr
+    auto
+    maybe_invoke_optional_ref (optional_ref<T> opt, Type Base::* f, Args&&... args)
+      noexcept (noexcept (((*opt).*f) (std::forward<Args> (args)...)))
+      -> typename std::enable_if<std::is_member_function_pointer<decltype (f)>::value
+                             &&  std::is_object<decltype (
+                                   ((*opt).*f) (std::forward<Args> (args)...))>::value
+                             &&  std::is_default_constructible<decltype (
+                                   ((*opt).*f) (std::forward<Args> (args)...))>::value,
+                                 decltype (((*opt).*f) (std::forward<Args> (args)...))>::type
+    {
+      using ret_type = decltype (((*opt).*f) (std::forward<Args> (args)...));
+      return opt ? ((*opt).*f) (std::forward<Args> (args)...) : ret_type ();
+    }
+
+    template <typename T, typename Type, typename Base, typename ...Args>
+    constexpr
+    auto
+    maybe_invoke_optional_ref (optional_ref<T> opt, Type Base::* f, Args&&... args)
+      noexcept (noexcept (((*opt).*f) (std::forward<Args> (args)...)))
+      -> typename std::enable_if<std::is_member_function_pointer<decltype (f)>::value
+                             &&! std::is_object<decltype (
+                                   ((*opt).*f) (std::forward<Args> (args)...))>::value
+                             &&  std::is_lvalue_reference<decltype (
+                                   ((*opt).*f) (std::forward<Args> (args)...))>::value,
+                                 optional_ref<typename std::remove_reference<decltype (
+                                   ((*opt).*f) (std::forward<Args> (args)...))>::type>>::type
+    {
+      using ref = decltype (((*opt).*f) (std::forward<Args> (args)...));
+      using ret_type = optional_ref<typename std::remove_reference<ref>::type>;
+      return opt ? ret_type (((*opt).*f) (std::forward<Args> (args)...)) : ret_type ();
+    }
+
+    template <typename T, typename Type, typename Base, typename ...Args>
+    inline GCH_CPP14_CONSTEXPR
+    auto
+    maybe_invoke_optional_ref (optional_ref<T> opt, Type Base::* f, Args&&... args)
+      noexcept (noexcept (((*opt).*f) (std::forward<Args> (args)...)))
+      -> typename std::enable_if<std::is_member_function_pointer<decltype (f)>::value
+                             &&! std::is_object<decltype (
+                                   ((*opt).*f) (std::forward<Args> (args)...))>::value
+                             &&! std::is_lvalue_reference<decltype (
+                                   ((*opt).*f) (std::forward<Args> (args)...))>::value,
+                                 void>::type
+    {
+      if (opt)
+        ((*opt).*f) (std::forward<Args> (args)...);
+    }
+
+    template <typename T, typename Type, typename Base>
+    constexpr
+    auto
+    maybe_invoke_optional_ref (optional_ref<T> opt, Type Base::* m)
+      noexcept (noexcept ((*opt).*m))
+      -> typename std::enable_if<std::is_member_object_pointer<decltype (m)>::value,
+                                 optional_ref<typename std::remove_reference<decltype (
+                                   (*opt).*m)>::type>>::type
+    {
+      using ref = decltype ((*opt).*m);
+      using ret_type = optional_ref<typename std::remove_reference<ref>::type>;
+      return opt ? ret_type ((*opt).*m) : ret_type ();
+    }
+
+    template <typename T, typename Functor, typename ...Args>
+    constexpr
+    auto
+    maybe_invoke_optional_ref (optional_ref<T> opt, Functor&& f, Args&&... args)
+      noexcept (noexcept (std::forward<Functor> (f) (*opt, std::forward<Args> (args)...)))
+      -> typename std::enable_if<
+               std::is_object<decltype (
+                 std::forward<Functor> (f) (*opt, std::forward<Args> (args)...))>::value
+           &&  std::is_default_constructible<decltype (
+                 std::forward<Functor> (f) (*opt, std::forward<Args> (args)...))>::value,
+               decltype (
+                 std::forward<Functor> (f) (*opt, std::forward<Args> (args)...))>::type
+    {
+      using ret_type = decltype (std::forward<Functor> (f) (*opt, std::forward<Args> (args)...));
+      return opt ? std::forward<Functor> (f) (*opt, std::forward<Args> (args)...) : ret_type ();
+    }
+
+    template <typename T, typename Functor, typename ...Args>
+    constexpr
+    auto
+    maybe_invoke_optional_ref (optional_ref<T> opt, Functor&& f, Args&&... args)
+      noexcept (noexcept (std::forward<Functor> (f) (*opt, std::forward<Args> (args)...)))
+      -> typename std::enable_if<
+             ! std::is_object<decltype (
+                 std::forward<Functor> (f) (*opt, std::forward<Args> (args)...))>::value
+           &&  std::is_lvalue_reference<decltype (
+                 std::forward<Functor> (f) (*opt, std::forward<Args> (args)...))>::value,
+               optional_ref<typename std::remove_reference<decltype (
+                 std::forward<Functor> (f) (*opt, std::forward<Args> (args)...))>::type>>::type
+    {
+      using ref = decltype (std::forward<Functor> (f) (*opt, std::forward<Args> (args)...));
+      using ret_type = optional_ref<typename std::remove_reference<ref>::type>;
+
+      return opt ? ret_type (std::forward<Functor> (f) (*opt, std::forward<Args> (args)...))
+                 : ret_type ();
+    }
+
+    template <typename T, typename Functor, typename ...Args>
+    inline GCH_CPP14_CONSTEXPR
+    auto
+    maybe_invoke_optional_ref (optional_ref<T> opt, Functor&& f, Args&&... args)
+      noexcept (noexcept (std::forward<Functor> (f) (*opt, std::forward<Args> (args)...)))
+      -> typename std::enable_if<
+             ! std::is_object<decltype (
+                 std::forward<Functor> (f) (*opt, std::forward<Args> (args)...))>::value
+           &&! std::is_lvalue_reference<decltype (
+                 std::forward<Functor> (f) (*opt, std::forward<Args> (args)...))>::value,
+               void>::type
+    {
+      if (opt)
+        std::forward<Functor> (f) (*opt, std::forward<Args> (args)...);
+    }
+
+    template <typename Void, typename Optional, typename Functor, typename ...Args>
+    struct is_maybe_invocable_optional_ref
+      : std::false_type
+    {
+      using nothrow = std::false_type;
+    };
+
+    template <typename T, typename Functor, typename ...Args>
+    struct is_maybe_invocable_optional_ref<
+          decltype (static_cast<void> (maybe_invoke_optional_ref (std::declval<optional_ref<T>> (),
+                                                                  std::declval<Functor> (),
+                                                                  std::declval<Args> ()...))),
+          optional_ref<T>, Functor, Args...>
+      : std::true_type
+    {
+      using nothrow = std::integral_constant<bool,
+                        noexcept (maybe_invoke_optional_ref (std::declval<optional_ref<T>> (),
+                                                             std::declval<Functor> (),
+                                                             std::declval<Args> ()...))>;
+    };
+
+    template <typename Void, typename Optional, typename Functor, typename ...Args>
+    struct maybe_invoke_result_optional_ref
+    { };
+
+    template <typename T, typename Functor, typename ...Args>
+    struct maybe_invoke_result_optional_ref<
+      decltype (static_cast<void> (maybe_invoke_optional_ref (std::declval<optional_ref<T>> (),
+                                                              std::declval<Functor> (),
+                                                              std::declval<Args> ()...))),
+      optional_ref<T>, Functor, Args...>
+    {
+      using type = decltype (maybe_invoke_optional_ref (std::declval<optional_ref<T>> (),
+                                                        std::declval<Functor> (),
+                                                        std::declval<Args> ()...));
+    };
+
+  }
+
+} // namespace gch
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  template <typename T, typename Functor, typename ...Args>
+  struct is_maybe_invocable<optional_ref<T>, Functor, Args...>
+    : detail::is_maybe_invocable_optional_ref<void, optional_ref<T>, Functor, Args...>
+  { };
+
+  template <typename T, typename Functor, typename ...Args>
+  struct is_maybe_invocable<optional_ref<T>&, Functor, Args...>
+    : is_maybe_invocable<optional_ref<T>, Functor, Args...>
+  { };
+
+  template <typename T, typename Functor, typename ...Args>
+  struct is_maybe_invocable<const optional_ref<T>&, Functor, Args...>
+    : is_maybe_invocable<optional_ref<T>, Functor, Args...>
+  { };
+
+  template <typename T, typename Functor, typename ...Args>
+  struct is_maybe_invocable<optional_ref<T>&&, Functor, Args...>
+    : is_maybe_invocable<optional_ref<T>, Functor, Args...>
+  { };
+
+  template <typename T, typename Functor, typename ...Args>
+  struct is_maybe_invocable<const optional_ref<T>&&, Functor, Args...>
+    : is_maybe_invocable<optional_ref<T>, Functor, Args...>
+  { };
+
+  template <typename T, typename Functor, typename ...Args>
+  struct is_nothrow_maybe_invocable<optional_ref<T>, Functor, Args...>
+    : detail::is_maybe_invocable_optional_ref<void, optional_ref<T>, Functor, Args...>::nothrow
+  { };
+
+  template <typename T, typename Functor, typename ...Args>
+  struct is_nothrow_maybe_invocable<optional_ref<T>&, Functor, Args...>
+    : is_nothrow_maybe_invocable<optional_ref<T>, Functor, Args...>
+  { };
+
+  template <typename T, typename Functor, typename ...Args>
+  struct is_nothrow_maybe_invocable<const optional_ref<T>&, Functor, Args...>
+    : is_nothrow_maybe_invocable<optional_ref<T>, Functor, Args...>
+  { };
+
+  template <typename T, typename Functor, typename ...Args>
+  struct is_nothrow_maybe_invocable<optional_ref<T>&&, Functor, Args...>
+    : is_nothrow_maybe_invocable<optional_ref<T>, Functor, Args...>
+  { };
+
+  template <typename T, typename Functor, typename ...Args>
+  struct is_nothrow_maybe_invocable<const optional_ref<T>&&, Functor, Args...>
+    : is_nothrow_maybe_invocable<optional_ref<T>, Functor, Args...>
+  { };
+
+  template <typename T, typename Functor, typename ...Args>
+  struct maybe_invoke_result<optional_ref<T>, Functor, Args...>
+    : detail::maybe_invoke_result_optional_ref<void, optional_ref<T>, Functor, Args...>
+  { };
+
+  template <typename T, typename Functor, typename ...Args>
+  struct maybe_invoke_result<optional_ref<T>&, Functor, Args...>
+    : maybe_invoke_result<optional_ref<T>, Functor, Args...>
+  { };
+
+  template <typename T, typename Functor, typename ...Args>
+  struct maybe_invoke_result<const optional_ref<T>&, Functor, Args...>
+    : maybe_invoke_result<optional_ref<T>, Functor, Args...>
+  { };
+
+  template <typename T, typename Functor, typename ...Args>
+  struct maybe_invoke_result<optional_ref<T>&&, Functor, Args...>
+    : maybe_invoke_result<optional_ref<T>, Functor, Args...>
+  { };
+
+  template <typename T, typename Functor, typename ...Args>
+  struct maybe_invoke_result<const optional_ref<T>&&, Functor, Args...>
+    : maybe_invoke_result<optional_ref<T>, Functor, Args...>
+  { };
+
+#endif
+
+  template <typename Result>
+  struct is_valid_maybe_invoke_result
+    : detail::is_valid_maybe_invoke_result_impl<Result>
+  { };
+
+  /**
+   * Invokes a functor on the optional if and only if it has a value.
+   *
+   * On the return type:
+   *   let `U = std::invoke_result_t<Functor, T&, Args...>`
+   *   if `U` is
+   *     -     object and     default constructible -> `U`
+   *     -     object and not default constructible -> <ill-formed>
+   *     - not object and     lvalue reference      -> `optional_ref<std::remove_reference_t<U>>`
+   *     - not object and not lvalue reference      -> `void`
+   *
+   * In the case that U is an object and default constructible, the intent
+   * is that U is either a `std::optional` or `optional_ref`, but holds no
+   * restriction to those types so that user defined monads can be used.
+   * In the aforementioned case, a default constructed value of `U` is
+   * returned if `opt` has no value.
+   *
+   * The functor may be a free function pointer, a pointer to member function,
+   * a pointer to member object, or a function object.
+   *
+   * @tparam T the value type of an `optional_ref`
+   * @tparam Functor a functor
+   * @tparam Args argument types passed to the function
+   * @param opt an `optional_ref`
+   * @param f a functor to be invoked
+   * @param args arguments passed to the function
+   * @return [see above]
+   */
+#ifdef GCH_CONCEPTS
+
+  template <typename T, typename Functor, typename ...Args>
+  requires detail::maybe_invocable_optional_ref<T, Functor, Args...>
+  constexpr
+  typename detail::maybe_invoke_result_optional_ref<T, Functor, Args...>::type
+  maybe_invoke (optional_ref<T> opt, Functor&& f, Args&&... args)
+    noexcept (detail::nothrow_maybe_invocable_optional_ref<T, Functor, Args...>)
+  {
+    using ret_type = typename detail::maybe_invoke_result_optional_ref<T, Functor, Args...>::type;
+
+    if constexpr (std::is_void<ret_type>::value)
+    {
+      if (opt)
+        detail::invoke_referent (*opt, std::forward<Functor> (f), std::forward<Args> (args)...);
+    }
+    else
+    {
+      return opt ? ret_type (detail::invoke_referent (*opt,
+                                                      std::forward<Functor> (f),
+                                                      std::forward<Args> (args)...))
+                 : ret_type ();
+    }
+  }
+
+#else
+
+  template <typename T, typename Functor, typename ...Args,
+            typename std::enable_if<
+              is_maybe_invocable<optional_ref<T>, Functor, Args...>::value>::type * = nullptr>
+  constexpr
+  maybe_invoke_result_t<optional_ref<T>, Functor, Args...>
+  maybe_invoke (optional_ref<T> opt, Functor&& f, Args&&... args)
+    noexcept (is_nothrow_maybe_invocable<optional_ref<T>, Functor, Args...>::value)
+  {
+    return detail::maybe_invoke_optional_ref (opt,
+                                              std::forward<Functor> (f),
+                                              std::forward<Args> (args)...);
+  }
+
+#endif
+
+  /**
+   * Calls maybe_invoke with the specified function.
+   *
+   * @tparam T the value type of an `optional_ref`
+   * @tparam Functor a functor
+   * @param opt an `optional_ref`
+   * @param f a functor to be invoked
+   * @return the result of the call to `maybe_invoke`
+   *
+   * @see gch::maybe_invoke
+   */
+  template <typename T, typename Functor,
+            typename std::enable_if<
+              is_maybe_invocable<optional_ref<T>, Functor>::value>::type * = nullptr>
+  constexpr
+  maybe_invoke_result_t<optional_ref<T>, Functor>
+  operator>>= (optional_ref<T> opt, Functor&& f)
+    noexcept (is_nothrow_maybe_invocable<optional_ref<T>, Functor>::value)
+  {
+    return maybe_invoke (opt, std::forward<Functor> (f));
+  }
+
+  // NOTE: The following overloads are a byproduct of the comment below.
+
+  template <typename T>
+  constexpr
+  maybe_invoke_result_t<optional_ref<T>, void (T&)>
+  operator>>= (optional_ref<T> opt, void f (T&))
+  {
+    return maybe_invoke (opt, f);
+  }
+
+  template <typename T>
+  constexpr
+  maybe_invoke_result_t<optional_ref<T>, T (T&)>
+  operator>>= (optional_ref<T> opt, T f (T&))
+  {
+    return maybe_invoke (opt, f);
+  }
+
+  template <typename T>
+  constexpr
+  maybe_invoke_result_t<optional_ref<T>, T& (T&)>
+  operator>>= (optional_ref<T> opt, T& f (T&))
+  {
+    return maybe_invoke (opt, f);
+  }
+
+  template <typename T>
+  constexpr
+  maybe_invoke_result_t<optional_ref<T>, optional_ref<T> (T&)>
+  operator>>= (optional_ref<T> opt, optional_ref<T> f (T&))
+  {
+    return maybe_invoke (opt, f);
+  }
+
+  // FIXME: Citing temp.deduct.type-(5.5.1), I think this is defined to be ill-formed for
+  //        overloaded functions because of the deduction for Return performed by the second
+  //        argument. However, using it like this does work on GCC and MSVC (but not on Clang).
+  //
+  //        The overloads defined above this are to allow for some overloads to exist without
+  //        deduction of the return type.
+  //
+  //        Note that the pointer-to-member-function overloads seen below should be legal because
+  //        the cvref qualification of the second argument restricts it to one overload before
+  //        deduction of the return type is performed.
+  template <typename T, typename Return,
+            typename std::enable_if<
+              is_maybe_invocable<optional_ref<T>,
+                                 Return (T&)>::value>::type * = nullptr>
+  constexpr
+  maybe_invoke_result_t<optional_ref<T>, Return (T&)>
+  operator>>= (optional_ref<T> opt, Return f (T&))
+  {
+    return maybe_invoke (opt, f);
+  }
+
+  template <typename T, typename Base, typename Return,
+            typename std::enable_if<
+                  is_maybe_invocable<optional_ref<T>, Return (Base::*) (void)>::value
+              &&  std::is_base_of<Base, T>::value>::type * = nullptr>
+  constexpr
+  maybe_invoke_result_t<optional_ref<T>, Return (Base::*) (void)>
+  operator>>= (optional_ref<T> opt, Return (Base::* f) (void))
+  {
+    return maybe_invoke (opt, f);
+  }
+
+  template <typename T, typename Base, typename Return,
+            typename std::enable_if<
+                  is_maybe_invocable<optional_ref<T>, Return (Base::*) (void) &>::value
+              &&  std::is_base_of<Base, T>::value>::type * = nullptr>
+  constexpr
+  maybe_invoke_result_t<optional_ref<T>, Return (Base::*) (void) &>
+  operator>>= (optional_ref<T> opt, Return (Base::* f) (void) &)
+  {
+    return maybe_invoke (opt, f);
+  }
+
+  template <typename T, typename Base, typename Return,
+            typename std::enable_if<
+                  is_maybe_invocable<optional_ref<const T>, Return (Base::*) (void) const>::value
+              &&  std::is_base_of<Base, T>::value>::type * = nullptr>
+  constexpr
+  maybe_invoke_result_t<optional_ref<const T>, Return (Base::*) (void) const>
+  operator>>= (optional_ref<const T> opt, Return (Base::* f) (void) const)
+  {
+    return maybe_invoke (opt, f);
+  }
+
+  template <typename T, typename Base, typename Return,
+            typename std::enable_if<
+                  is_maybe_invocable<optional_ref<const T>, Return (Base::*) (void) const &>::value
+              &&  std::is_base_of<Base, T>::value>::type * = nullptr>
+  constexpr
+  maybe_invoke_result_t<optional_ref<const T>, Return (Base::*) (void) const &>
+  operator>>= (optional_ref<const T> opt, Return (Base::* f) (void) const &)
+  {
+    return maybe_invoke (opt, f);
+  }
+
+#ifdef GCH_TYPESYSTEM_NOEXCEPT
+
+  template <typename T>
+  constexpr
+  maybe_invoke_result_t<optional_ref<T>, void (T&) noexcept>
+  operator>>= (optional_ref<T> opt, void f (T&) noexcept) noexcept
+  {
+    return maybe_invoke (opt, f);
+  }
+
+  template <typename T>
+  constexpr
+  maybe_invoke_result_t<optional_ref<T>, T (T&) noexcept>
+  operator>>= (optional_ref<T> opt, T f (T&) noexcept) noexcept
+  {
+    return maybe_invoke (opt, f);
+  }
+
+  template <typename T>
+  constexpr
+  maybe_invoke_result_t<optional_ref<T>, T& (T&) noexcept>
+  operator>>= (optional_ref<T> opt, T& f (T&) noexcept) noexcept
+  {
+    return maybe_invoke (opt, f);
+  }
+
+  template <typename T>
+  constexpr
+  maybe_invoke_result_t<optional_ref<T>, optional_ref<T> (T&) noexcept>
+  operator>>= (optional_ref<T> opt, optional_ref<T> f (T&) noexcept) noexcept
+  {
+    return maybe_invoke (opt, f);
+  }
+
+  template <typename T, typename Return,
+            typename std::enable_if<
+              is_maybe_invocable<optional_ref<T>,
+                                 Return (T&) noexcept>::value>::type * = nullptr>
+  constexpr
+  maybe_invoke_result_t<optional_ref<T>, Return (T&) noexcept>
+  operator>>= (optional_ref<T> opt, Return f (T&) noexcept) noexcept
+  {
+    return maybe_invoke (opt, f);
+  }
+
+  template <typename T, typename Base, typename Return,
+            typename std::enable_if<
+                  is_maybe_invocable<optional_ref<T>,
+                                     Return (Base::*) (void) noexcept>::value
+              &&  std::is_base_of<Base, typename std::decay<T>::type>::value
+              &&! std::is_const<T>::value>::type * = nullptr>
+  constexpr
+  maybe_invoke_result_t<optional_ref<T>, Return (Base::*) (void) noexcept>
+  operator>>= (optional_ref<T> opt, Return (Base::* f) (void) noexcept) noexcept
+  {
+    return maybe_invoke (opt, f);
+  }
+
+  template <typename T, typename Base, typename Return,
+            typename std::enable_if<
+                  is_maybe_invocable<optional_ref<T>,
+                                     Return (Base::*) (void) & noexcept>::value
+              &&  std::is_base_of<Base, typename std::decay<T>::type>::value
+              &&! std::is_const<T>::value>::type * = nullptr>
+  constexpr
+  maybe_invoke_result_t<optional_ref<T>, Return (Base::*) (void) & noexcept>
+  operator>>= (optional_ref<T> opt, Return (Base::* f) (void) & noexcept) noexcept
+  {
+    return maybe_invoke (opt, f);
+  }
+
+  template <typename T, typename Base, typename Return,
+            typename std::enable_if<
+                  is_maybe_invocable<optional_ref<T>,
+                                     Return (Base::*) (void) const noexcept>::value
+              &&  std::is_base_of<Base, typename std::decay<T>::type>::value
+              &&  std::is_const<T>::value>::type * = nullptr>
+  constexpr
+  maybe_invoke_result_t<optional_ref<T>, Return (Base::*) (void) const noexcept>
+  operator>>= (optional_ref<T> opt, Return (Base::* f) (void) const noexcept) noexcept
+  {
+    return maybe_invoke (opt, f);
+  }
+
+  template <typename T, typename Base, typename Return,
+            typename std::enable_if<
+                  is_maybe_invocable<optional_ref<T>,
+                                     Return (Base::*) (void) const & noexcept>::value
+              &&  std::is_base_of<Base, typename std::decay<T>::type>::value
+              &&  std::is_const<T>::value>::type * = nullptr>
+  constexpr
+  maybe_invoke_result_t<optional_ref<T>, Return (Base::*) (void) const & noexcept>
+  operator>>= (optional_ref<T> opt, Return (Base::* f) (void) const & noexcept) noexcept
+  {
+    return maybe_invoke (opt, f);
+  }
+
+#endif
+
+  template <typename T, typename Functor,
+            typename std::enable_if<
+              is_valid_maybe_invoke_result<decltype (std::declval<Functor> () ())>::value
+            >::type * = nullptr>
+  constexpr
+  maybe_invoke_result_t<optional_ref<T>, decltype (std::declval<Functor> () ()) (T&)>
+  operator>> (optional_ref<T> opt, Functor&& f)
+    noexcept (noexcept (std::forward<Functor> (f) ()))
+  {
+    // make sure that the return is forwarded and not copied
+    using ret_type = decltype (std::forward<Functor> (f) ());
+    return opt >>= [&f](T&) noexcept (noexcept (std::forward<Functor> (f) ())) -> ret_type
+                   { return std::forward<Functor> (f) (); };
+  }
+
+#if defined (__cpp_lib_optional) && __cpp_lib_optional >= 201606L
+
+  /**
+   * Invokes a function returning an object on the referent of an
+   * `optional_ref`, and wraps the result in a `std::optional`.
+   *
+   * This complements the member `optional_ref::transform`, which wraps
+   * lvalue results in an `optional_ref` and object results in a lazy
+   * `lazy_transform`. If `opt` does not contain a value,
+   * `f` is not invoked and an empty `std::optional` is returned.
+   *
+   * @tparam T the value type of an `optional_ref`.
+   * @tparam F a type invocable with `T&`, returning an object.
+   * @param opt an `optional_ref`.
+   * @param f a function.
+   * @return a `std::optional` containing the result of `f`,
+   *         or an empty `std::optional`.
+   */
+  template <typename T, typename F,
+            typename R = decltype (std::declval<F> () (std::declval<T&> ())),
+            typename std::enable_if<std::is_object<R>::value>::type * = nullptr>
+  GCH_NODISCARD constexpr
+  std::optional<typename std::remove_cv<R>::type>
+  transform (optional_ref<T> opt, F&& f)
+    noexcept (noexcept (std::declval<F> () (std::declval<T&> ()))
+          &&  std::is_nothrow_move_constructible<typename std::remove_cv<R>::type>::value)
+  {
+    using ret_type = std::optional<typename std::remove_cv<R>::type>;
+    return opt ? ret_type (std::forward<F> (f) (*opt)) : ret_type ();
+  }
+
+#endif
+
+} // namespace gch
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    template <typename Void, typename Functor, typename ...Ts>
+    struct maybe_invoke_all_result_impl
+    { };
+
+    template <typename Functor, typename ...Ts>
+    struct maybe_invoke_all_result_impl<
+      decltype (static_cast<void> (std::declval<Functor> () (std::declval<Ts&> ()...))),
+      Functor, Ts...>
+      : maybe_invoke_wrap<decltype (std::declval<Functor> () (std::declval<Ts&> ()...))>
+    { };
+
+    struct maybe_invoke_no_result
+    { };
+
+    template <typename Result, typename Functor, typename ...Ts>
+    struct maybe_invoke_any_result_impl
+    {
+      using type = Result;
+    };
+
+    template <typename Result, typename Functor, typename T, typename ...Ts>
+    struct maybe_invoke_any_result_impl<Result, Functor, T, Ts...>
+      : std::conditional<
+          std::is_same<typename maybe_invoke_all_result_impl<void, Functor, T>::type,
+                       Result>::value,
+          maybe_invoke_any_result_impl<Result, Functor, Ts...>,
+          maybe_invoke_no_result>::type
+    { };
+
+    template <typename Functor, typename ...Ts>
+    struct is_nothrow_invocable_with_each
+      : std::true_type
+    { };
+
+    template <typename Functor, typename T, typename ...Ts>
+    struct is_nothrow_invocable_with_each<Functor, T, Ts...>
+      : std::integral_constant<bool,
+             noexcept (std::declval<Functor> () (std::declval<T&> ()))
+          && is_nothrow_invocable_with_each<Functor, Ts...>::value>
+    { };
+
+    inline constexpr
+    bool
+    all_engaged_constant (void) noexcept
+    {
+      return true;
+    }
+
+    template <typename T, typename ...Ts>
+    constexpr
+    bool
+    all_engaged_constant (optional_ref<T> first, optional_ref<Ts>... rest) noexcept
+    {
+      return first.has_value () && all_engaged_constant (rest...);
+    }
+
+    inline
+    std::uintptr_t
+    min_address (void) noexcept
+    {
+      return UINTPTR_MAX;
+    }
+
+    // Compiles to conditional moves, so that the caller tests a single value.
+    template <typename T, typename ...Ts>
+    std::uintptr_t
+    min_address (optional_ref<T> first, optional_ref<Ts>... rest) noexcept
+    {
+      std::uintptr_t address = reinterpret_cast<std::uintptr_t> (first.get_pointer ());
+      std::uintptr_t rest_min = min_address (rest...);
+      return address < rest_min ? address : rest_min;
+    }
+
+    // Checks that every `optional_ref` has a value with a single branch. All of
+    // them have a value if and only if the least address is nonzero.
+    template <typename ...Ts>
+    constexpr
+    bool
+    all_engaged (optional_ref<Ts>... opts) noexcept
+    {
+#ifdef GCH_BUILTIN_IS_CONSTANT_EVALUATED
+      return __builtin_is_constant_evaluated () ? all_engaged_constant (opts...)
+                                                : min_address (opts...) != 0;
+#else
+      return all_engaged_constant (opts...);
+#endif
+    }
+
+    template <typename Result, typename Functor, typename ...Ts>
+    constexpr
+    Result
+    maybe_invoke_all_impl (std::false_type, Functor&& f, optional_ref<Ts>... opts)
+      noexcept (noexcept (std::forward<Functor> (f) (*opts...)))
+    {
+      return all_engaged (opts...) ? Result (std::forward<Functor> (f) (*opts...)) : Result ();
+    }
+
+    template <typename Result, typename Functor, typename ...Ts>
+    GCH_CPP14_CONSTEXPR
+    void
+    maybe_invoke_all_impl (std::true_type, Functor&& f, optional_ref<Ts>... opts)
+      noexcept (noexcept (std::forward<Functor> (f) (*opts...)))
+    {
+      if (all_engaged (opts...))
+        std::forward<Functor> (f) (*opts...);
+    }
+
+    template <typename Result, typename Functor>
+    constexpr
+    Result
+    maybe_invoke_any_impl (std::false_type, Functor&&) noexcept
+    {
+      return Result ();
+    }
+
+    template <typename Result, typename Functor, typename T, typename ...Ts>
+    constexpr
+    Result
+    maybe_invoke_any_impl (std::false_type, Functor&& f, optional_ref<T> first,
+                           optional_ref<Ts>... rest)
+      noexcept (is_nothrow_invocable_with_each<Functor, T, Ts...>::value)
+    {
+      return first.has_value ()
+           ? Result (std::forward<Functor> (f) (*first))
+           : maybe_invoke_any_impl<Result> (std::false_type { },
+                                            std::forward<Functor> (f), rest...);
+    }
+
+    template <typename Result, typename Functor>
+    GCH_CPP14_CONSTEXPR
+    void
+    maybe_invoke_any_impl (std::true_type, Functor&&) noexcept
+    { }
+
+    template <typename Result, typename Functor, typename T, typename ...Ts>
+    GCH_CPP14_CONSTEXPR
+    void
+    maybe_invoke_any_impl (std::true_type, Functor&& f, optional_ref<T> first,
+                           optional_ref<Ts>... rest)
+      noexcept (is_nothrow_invocable_with_each<Functor, T, Ts...>::value)
+    {
+      if (first.has_value ())
+        std::forward<Functor> (f) (*first);
+      else
+        maybe_invoke_any_impl<Result> (std::true_type { }, std::forward<Functor> (f), rest...);
+    }
+
+  }
+
+} // namespace gch
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * Deduces the return type of a call to `maybe_invoke_all`.
+   *
+   * Contains the member type `type` only if `Functor` is invocable with
+   * `Ts&...` and the result is valid for `maybe_invoke`.
+   *
+   * @tparam Functor a functor type.
+   * @tparam Ts the value types of the `optional_ref`s.
+   */
+  template <typename Functor, typename ...Ts>
+  struct maybe_invoke_all_result
+    : detail::maybe_invoke_all_result_impl<void, Functor, Ts...>
+  { };
+
+  /**
+   * A convenience alias for `maybe_invoke_all_result`.
+   *
+   * @tparam Functor a functor type.
+   * @tparam Ts the value types of the `optional_ref`s.
+   */
+  template <typename Functor, typename ...Ts>
+  using maybe_invoke_all_result_t = typename maybe_invoke_all_result<Functor, Ts...>::type;
+
+  /**
+   * Deduces the return type of a call to `maybe_invoke_any`.
+   *
+   * Contains the member type `type` only if `Functor` is invocable with each
+   * of `T&, Ts&...`, and every invocation maps to the same return type.
+   *
+   * @tparam Functor a functor type.
+   * @tparam T the value type of the first `optional_ref`.
+   * @tparam Ts the value types of the other `optional_ref`s.
+   */
+  template <typename Functor, typename T, typename ...Ts>
+  struct maybe_invoke_any_result
+    : detail::maybe_invoke_any_result_impl<maybe_invoke_all_result_t<Functor, T>,
+                                           Functor, Ts...>
+  { };
+
+  /**
+   * A convenience alias for `maybe_invoke_any_result`.
+   *
+   * @tparam Functor a functor type.
+   * @tparam T the value type of the first `optional_ref`.
+   * @tparam Ts the value types of the other `optional_ref`s.
+   */
+  template <typename Functor, typename T, typename ...Ts>
+  using maybe_invoke_any_result_t = typename maybe_invoke_any_result<Functor, T, Ts...>::type;
+
+  /**
+   * Invokes a functor on the referents of several `optional_ref`s if and
+   * only if all of them have a value.
+   *
+   * The engagement of the `optional_ref`s is tested with a single branch.
+   * The return type is mapped in the same way as for `maybe_invoke`, with
+   * `U = std::invoke_result_t<Functor, Ts&...>`.
+   *
+   * @tparam Functor a function object or function pointer.
+   * @tparam Ts the value types of the `optional_ref`s.
+   * @param f a functor to be invoked.
+   * @param opts the `optional_ref`s whose referents are passed to `f`.
+   * @return [see `maybe_invoke`]
+   *
+   * @see gch::maybe_invoke
+   */
+  template <typename Functor, typename ...Ts>
+  GCH_CPP14_CONSTEXPR
+  maybe_invoke_all_result_t<Functor, Ts...>
+  maybe_invoke_all (Functor&& f, optional_ref<Ts>... opts)
+    noexcept (noexcept (std::forward<Functor> (f) (*opts...)))
+  {
+    using ret_type = maybe_invoke_all_result_t<Functor, Ts...>;
+    return detail::maybe_invoke_all_impl<ret_type> (std::is_void<ret_type> { },
+                                                    std::forward<Functor> (f), opts...);
+  }
+
+  /**
+   * Invokes a functor on the referent of the first `optional_ref`
+   * which has a value.
+   *
+   * If none of the `optional_ref`s has a value, the result is the same as for
+   * `maybe_invoke` on an empty `optional_ref`. The functor must be invocable
+   * with each of the value types, and each invocation must map to the same
+   * return type.
+   *
+   * @tparam Functor a function object or function pointer.
+   * @tparam T the value type of the first `optional_ref`.
+   * @tparam Ts the value types of the other `optional_ref`s.
+   * @param f a functor to be invoked.
+   * @param first the first candidate.
+   * @param rest the other candidates, in order of preference.
+   * @return [see `maybe_invoke`]
+   *
+   * @see gch::maybe_invoke
+   */
+  template <typename Functor, typename T, typename ...Ts>
+  GCH_CPP14_CONSTEXPR
+  maybe_invoke_any_result_t<Functor, T, Ts...>
+  maybe_invoke_any (Functor&& f, optional_ref<T> first, optional_ref<Ts>... rest)
+    noexcept (detail::is_nothrow_invocable_with_each<Functor, T, Ts...>::value)
+  {
+    using ret_type = maybe_invoke_any_result_t<Functor, T, Ts...>;
+    return detail::maybe_invoke_any_impl<ret_type> (std::is_void<ret_type> { },
+                                                    std::forward<Functor> (f), first, rest...);
+  }
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_OPTIONAL_REF_MONADIC_HPP
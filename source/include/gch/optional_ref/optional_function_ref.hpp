@@ -0,0 +1,452 @@
+/** optional_function_ref.hpp
+ * Defines `optional_function_ref`, a nullable non-owning reference to a
+ * callable object.
+ *
+ * An `optional_function_ref` is two pointers wide: a pointer to the
+ * referenced callable and a pointer to a function which invokes it. It never
+ * allocates, and it has no value when the invoker is null.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_OPTIONAL_REF_OPTIONAL_FUNCTION_REF_HPP
+#define GCH_OPTIONAL_REF_OPTIONAL_FUNCTION_REF_HPP
+
+#include "core.hpp"
+#include "monadic.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * A nullable non-owning reference to a callable object.
+   *
+   * @tparam Signature a function type `R (Args...)`, or, if `noexcept` is
+   *                   part of the type system, `R (Args...) noexcept`.
+   */
+  template <typename Signature>
+  class optional_function_ref;
+
+} // namespace gch
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    template <typename T>
+    struct is_optional_function_ref
+      : std::false_type
+    { };
+
+    template <typename Signature>
+    struct is_optional_function_ref<optional_function_ref<Signature>>
+      : std::true_type
+    { };
+
+    template <typename F, typename R, bool Noexcept, typename ...Args>
+    struct function_ref_invocable_impl
+      : std::false_type
+    { };
+
+    template <typename F, typename R, typename ...Args>
+    struct function_ref_invocable_impl<F, R, false, Args...>
+      : std::integral_constant<bool,
+             std::is_void<R>::value
+          || std::is_convertible<decltype (std::declval<F&> () (std::declval<Args> ()...)),
+                                 R>::value>
+    { };
+
+    template <typename F, typename R, typename ...Args>
+    struct function_ref_invocable_impl<F, R, true, Args...>
+      : std::integral_constant<bool,
+             function_ref_invocable_impl<F, R, false, Args...>::value
+          && noexcept (std::declval<F&> () (std::declval<Args> ()...))>
+    { };
+
+    template <typename F, typename Enable, typename R, bool Noexcept, typename ...Args>
+    struct function_ref_invocable
+      : std::false_type
+    { };
+
+    template <typename F, typename R, bool Noexcept, typename ...Args>
+    struct function_ref_invocable<
+      F,
+      decltype (static_cast<void> (std::declval<F&> () (std::declval<Args> ()...))),
+      R, Noexcept, Args...>
+      : function_ref_invocable_impl<F, R, Noexcept, Args...>
+    { };
+
+    // Shared implementation for `R (Args...)` and `R (Args...) noexcept`.
+    template <bool Noexcept, typename R, typename ...Args>
+    class optional_function_ref_base
+    {
+      union storage
+      {
+        constexpr
+        storage (void) noexcept
+          : object (nullptr)
+        { }
+
+        constexpr explicit
+        storage (const void *obj) noexcept
+          : object (obj)
+        { }
+
+        constexpr explicit
+        storage (void (*fn) (void)) noexcept
+          : function (fn)
+        { }
+
+        const void *object;
+        void (*function) (void);
+      };
+
+      using invoker_type = R (*) (storage, Args&&...);
+
+      template <typename F>
+      static
+      R
+      invoke_object (storage s, Args&&... args) noexcept (Noexcept)
+      {
+        using object_pointer = typename std::add_pointer<F>::type;
+        return static_cast<R> (
+          (*static_cast<object_pointer> (const_cast<void *> (s.object))) (
+            std::forward<Args> (args)...));
+      }
+
+      template <typename F>
+      static
+      R
+      invoke_function (storage s, Args&&... args) noexcept (Noexcept)
+      {
+        return static_cast<R> (
+          reinterpret_cast<F *> (s.function) (std::forward<Args> (args)...));
+      }
+
+    protected:
+      template <typename F>
+      using is_invocable = function_ref_invocable<F, void, R, Noexcept, Args...>;
+
+    public:
+      using result_type = R; /*!< The return type of the referenced callable */
+
+      /**
+       * Constructor
+       *
+       * The `optional_function_ref` has no value after default construction.
+       */
+      constexpr
+      optional_function_ref_base (void) noexcept = default;
+
+      /**
+       * Constructor
+       *
+       * Constructs an `optional_function_ref` with no value.
+       */
+      constexpr /* implicit */
+      optional_function_ref_base (nullopt_t) noexcept
+      { }
+
+      /**
+       * Constructor
+       *
+       * Constructs an `optional_function_ref` with no value.
+       */
+      constexpr /* implicit */
+      optional_function_ref_base (std::nullptr_t) noexcept
+      { }
+
+      /**
+       * Constructor
+       *
+       * Binds a function pointer. The result has no value if `fn` is `nullptr`.
+       *
+       * @tparam F a function type.
+       * @param fn a function pointer.
+       */
+      template <typename F,
+                typename std::enable_if<std::is_function<F>::value
+                                    &&  is_invocable<F>::value>::type * = nullptr>
+      /* implicit */
+      optional_function_ref_base (F *fn) noexcept
+        : m_storage (reinterpret_cast<void (*) (void)> (fn)),
+          m_invoker (fn != nullptr ? &invoke_function<F> : nullptr)
+      { }
+
+      /**
+       * Constructor
+       *
+       * Binds a callable lvalue. The callable must outlive every
+       * invocation through `*this`.
+       *
+       * @tparam F the type of the callable.
+       * @param f a callable object.
+       */
+      template <typename F,
+                typename std::enable_if<
+                      ! std::is_function<F>::value
+                  &&! is_optional_function_ref<typename std::remove_cv<F>::type>::value
+                  &&! is_optional_ref<typename std::remove_cv<F>::type>::value
+                  &&  is_invocable<F>::value>::type * = nullptr>
+      /* implicit */
+      optional_function_ref_base (F& f) noexcept
+        : m_storage (static_cast<const void *> (std::addressof (f))),
+          m_invoker (&invoke_object<F>)
+      { }
+
+      /**
+       * Constructor
+       *
+       * Binds the referent of an `optional_ref` to a callable. The result
+       * has no value if `ref` has no value.
+       *
+       * @tparam F the type of the callable.
+       * @param ref an `optional_ref` to a callable.
+       */
+      template <typename F,
+                typename std::enable_if<is_invocable<F>::value>::type * = nullptr>
+      /* implicit */
+      optional_function_ref_base (optional_ref<F> ref) noexcept
+        : m_storage (static_cast<const void *> (ref.get_pointer ())),
+          m_invoker (ref.has_value () ? &invoke_object<F> : nullptr)
+      { }
+
+      /**
+       * Checks if the `*this` refers to a callable.
+       *
+       * @return whether this `*this` refers to a callable.
+       */
+      GCH_NODISCARD constexpr
+      bool
+      has_value (void) const noexcept
+      {
+        return m_invoker != nullptr;
+      }
+
+      /**
+       * Checks if the `*this` refers to a callable.
+       *
+       * The return is forwarded from `has_value ()`.
+       *
+       * @return whether this `*this` refers to a callable.
+       */
+      GCH_NODISCARD constexpr explicit
+      operator bool (void) const noexcept
+      {
+        return has_value ();
+      }
+
+      /**
+       * Invokes the referenced callable.
+       *
+       * The behavior is undefined if `*this` has no value.
+       *
+       * @param args the arguments.
+       * @return the result of the invocation.
+       */
+      R
+      operator() (Args... args) const noexcept (Noexcept)
+      {
+        return m_invoker (m_storage, std::forward<Args> (args)...);
+      }
+
+      /**
+       * Invokes the referenced callable, while checking whether it exists.
+       *
+       * @throws bad_optional_access when `*this` does not contain a value.
+       *
+       * @see gch::set_bad_optional_access_handler
+       *
+       * @param args the arguments.
+       * @return the result of the invocation.
+       */
+      R
+      value (Args... args) const
+      {
+        if (! has_value ())
+          bad_optional_access_failure ();
+        return m_invoker (m_storage, std::forward<Args> (args)...);
+      }
+
+      /**
+       * Invokes the referenced callable, or returns a default.
+       *
+       * @tparam U a type convertible to `R`.
+       * @param default_value the value returned if `*this` has no value.
+       * @param args the arguments.
+       * @return the result of the invocation, or `default_value`.
+       */
+      template <typename U,
+                typename std::enable_if<std::is_convertible<U, R>::value>::type * = nullptr>
+      R
+      invoke_or (U&& default_value, Args... args) const noexcept (Noexcept)
+      {
+        return has_value () ? m_invoker (m_storage, std::forward<Args> (args)...)
+                            : static_cast<R> (std::forward<U> (default_value));
+      }
+
+      /**
+       * Removes the reference.
+       */
+      GCH_CPP14_CONSTEXPR
+      void
+      reset (void) noexcept
+      {
+        m_storage = storage ();
+        m_invoker = nullptr;
+      }
+
+    private:
+      storage      m_storage { };
+      invoker_type m_invoker = nullptr;
+    };
+
+    template <typename Result, typename Function, typename ...Args>
+    GCH_CPP14_CONSTEXPR
+    void
+    maybe_invoke_function_ref (std::true_type, const Function& f, Args&&... args)
+    {
+      if (f.has_value ())
+        f (std::forward<Args> (args)...);
+    }
+
+    template <typename Result, typename Function, typename ...Args>
+    Result
+    maybe_invoke_function_ref (std::false_type, const Function& f, Args&&... args)
+    {
+      return f.has_value () ? Result (f (std::forward<Args> (args)...)) : Result ();
+    }
+
+  }
+
+} // namespace gch
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  template <typename R, typename ...Args>
+  class optional_function_ref<R (Args...)>
+    : public detail::optional_function_ref_base<false, R, Args...>
+  {
+    using base = detail::optional_function_ref_base<false, R, Args...>;
+
+  public:
+    using base::base;
+  };
+
+#ifdef GCH_TYPESYSTEM_NOEXCEPT
+
+  template <typename R, typename ...Args>
+  class optional_function_ref<R (Args...) noexcept>
+    : public detail::optional_function_ref_base<true, R, Args...>
+  {
+    using base = detail::optional_function_ref_base<true, R, Args...>;
+
+  public:
+    using base::base;
+  };
+
+#endif
+
+  /**
+   * An equality comparison function.
+   *
+   * @return whether `lhs` has no value.
+   */
+  template <typename Signature>
+  GCH_NODISCARD constexpr
+  bool
+  operator== (const optional_function_ref<Signature>& lhs, nullopt_t) noexcept
+  {
+    return ! lhs.has_value ();
+  }
+
+  /**
+   * An equality comparison function.
+   *
+   * @return whether `rhs` has no value.
+   */
+  template <typename Signature>
+  GCH_NODISCARD constexpr
+  bool
+  operator== (nullopt_t, const optional_function_ref<Signature>& rhs) noexcept
+  {
+    return ! rhs.has_value ();
+  }
+
+  /**
+   * An inequality comparison function.
+   *
+   * @return whether `lhs` has a value.
+   */
+  template <typename Signature>
+  GCH_NODISCARD constexpr
+  bool
+  operator!= (const optional_function_ref<Signature>& lhs, nullopt_t) noexcept
+  {
+    return lhs.has_value ();
+  }
+
+  /**
+   * An inequality comparison function.
+   *
+   * @return whether `rhs` has a value.
+   */
+  template <typename Signature>
+  GCH_NODISCARD constexpr
+  bool
+  operator!= (nullopt_t, const optional_function_ref<Signature>& rhs) noexcept
+  {
+    return rhs.has_value ();
+  }
+
+  /**
+   * Invokes the referenced callable of an `optional_function_ref`,
+   * if it has a value.
+   *
+   * The return type is mapped in the same way as for `optional_ref`:
+   * lvalue references are wrapped in `optional_ref`, default-constructible
+   * objects are returned directly (default-constructed if there is no
+   * value), and anything else results in `void`.
+   *
+   * @tparam Signature the signature of `f`.
+   * @tparam Args the types of the arguments.
+   * @param f an `optional_function_ref`.
+   * @param args the arguments.
+   * @return the mapped result of the invocation.
+   */
+  template <typename Signature, typename ...Args>
+  typename detail::maybe_invoke_wrap<
+    typename optional_function_ref<Signature>::result_type>::type
+  maybe_invoke (const optional_function_ref<Signature>& f, Args&&... args)
+    noexcept (noexcept (f (std::forward<Args> (args)...)))
+  {
+    using result_type = typename detail::maybe_invoke_wrap<
+      typename optional_function_ref<Signature>::result_type>::type;
+
+    return detail::maybe_invoke_function_ref<result_type> (
+      std::is_void<result_type> { }, f, std::forward<Args> (args)...);
+  }
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_OPTIONAL_REF_OPTIONAL_FUNCTION_REF_HPP
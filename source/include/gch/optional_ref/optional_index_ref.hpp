@@ -0,0 +1,507 @@
+/** optional_index_ref.hpp
+ * Defines `optional_index_ref`, an optional reference to an element of
+ * a container which is stored as an index.
+ *
+ * Unlike an `optional_ref` to an element of a `std::vector`, an
+ * `optional_index_ref` remains valid when the container reallocates, and it
+ * is half the size of a pointer by default. The container is passed to every
+ * access.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_OPTIONAL_REF_OPTIONAL_INDEX_REF_HPP
+#define GCH_OPTIONAL_REF_OPTIONAL_INDEX_REF_HPP
+
+#include "core.hpp"
+#include "monadic.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * An optional reference to an element of a container, stored as an index.
+   *
+   * The maximum value of `Index` represents the empty state. Accesses
+   * resolve the index through a container passed as an argument, and
+   * indices past the end of the container are treated as empty.
+   *
+   * @tparam Container a random-access container, which may be const-qualified.
+   * @tparam Index an unsigned integral type.
+   */
+  template <typename Container, typename Index = std::uint32_t>
+  class optional_index_ref
+  {
+    static_assert (std::is_integral<Index>::value && std::is_unsigned<Index>::value,
+                   "optional_index_ref expects an unsigned integral index type.");
+
+    template <typename C, typename I>
+    friend class optional_index_ref;
+
+  public:
+    using container_type = Container; /*!< The type of the container */
+    using index_type     = Index;     /*!< The type of the index     */
+
+    /**
+     * The value type of the referenced element.
+     */
+    using value_type = typename std::remove_reference<
+      decltype (std::declval<Container&> ()[std::size_t { }])>::type;
+
+    using reference = value_type&;  /*!< The reference type to an element */
+    using pointer   = value_type *; /*!< The pointer type to an element   */
+
+    /**
+     * The index which represents the empty state.
+     */
+    static constexpr
+    index_type
+    npos = (std::numeric_limits<index_type>::max) ();
+
+    /**
+     * Constructor
+     *
+     * The `optional_index_ref` has no value after default
+     * construction.
+     */
+    constexpr
+    optional_index_ref (void) noexcept
+      : m_index (npos)
+    { }
+
+    /**
+     * Constructor
+     *
+     * Constructs an `optional_index_ref` with no value.
+     */
+    constexpr /* implicit */
+    optional_index_ref (nullopt_t) noexcept
+      : m_index (npos)
+    { }
+
+    /**
+     * Constructor
+     *
+     * Constructs an `optional_index_ref` to the element at `index`.
+     * The result has no value if `index` is equal to `npos`.
+     *
+     * @param index the index of the element.
+     */
+    constexpr explicit
+    optional_index_ref (index_type index) noexcept
+      : m_index (index)
+    { }
+
+    /**
+     * Constructor
+     *
+     * A converting constructor for adding const-qualification
+     * to the container type.
+     *
+     * @tparam C the container type of `other`.
+     * @param other an `optional_index_ref` into a non-const container.
+     */
+    template <typename C,
+              typename std::enable_if<std::is_same<const C, Container>::value
+                                  &&! std::is_same<C, Container>::value>::type * = nullptr>
+    constexpr /* implicit */
+    optional_index_ref (const optional_index_ref<C, Index>& other) noexcept
+      : m_index (other.m_index)
+    { }
+
+    /**
+     * Returns the stored index.
+     *
+     * @return the index, or `npos` if `*this` has no value.
+     */
+    GCH_NODISCARD constexpr
+    index_type
+    index (void) const noexcept
+    {
+      return m_index;
+    }
+
+    /**
+     * Checks if the `*this` contains an index.
+     *
+     * Note that this does not check whether the index is in range
+     * for any particular container.
+     *
+     * @return whether this `*this` contains an index.
+     */
+    GCH_NODISCARD constexpr
+    bool
+    has_value (void) const noexcept
+    {
+      return m_index != npos;
+    }
+
+    /**
+     * Checks if the `*this` contains an index.
+     *
+     * The return is forwarded from `has_value ()`.
+     *
+     * @return whether this `*this` contains an index.
+     */
+    GCH_NODISCARD constexpr explicit
+    operator bool (void) const noexcept
+    {
+      return has_value ();
+    }
+
+    /**
+     * Checks if `*this` refers to an element of a container.
+     *
+     * @param c the container.
+     * @return whether `*this` contains an index which is in range for `c`.
+     */
+    GCH_NODISCARD constexpr
+    bool
+    has_value (const Container& c) const noexcept
+    {
+      return has_value () && m_index < c.size ();
+    }
+
+    /**
+     * Returns a pointer to the referenced element.
+     *
+     * @param c the container.
+     * @return a pointer to the element, or `nullptr` if `*this`
+     *         does not refer to an element of `c`.
+     */
+    GCH_NODISCARD constexpr
+    pointer
+    get_pointer (Container& c) const noexcept
+    {
+      return has_value (c) ? &c[m_index] : nullptr;
+    }
+
+    /**
+     * Resolves `*this` into an `optional_ref`.
+     *
+     * The result is invalidated by anything which invalidates
+     * references into `c`, so it should not be stored.
+     *
+     * @param c the container.
+     * @return an `optional_ref` to the referenced element.
+     */
+    GCH_NODISCARD constexpr
+    optional_ref<value_type>
+    get (Container& c) const noexcept
+    {
+      return optional_ref<value_type> { get_pointer (c) };
+    }
+
+    /**
+     * Returns the referenced element, while checking whether it exists.
+     *
+     * @throws bad_optional_access when `*this` does not refer to an element of `c`.
+     *
+     * @see gch::set_bad_optional_access_handler
+     *
+     * @param c the container.
+     * @return the referenced element.
+     */
+    GCH_NODISCARD GCH_CPP14_CONSTEXPR
+    reference
+    value (Container& c) const
+    {
+      if (! has_value (c))
+        detail::bad_optional_access_failure ();
+      return c[m_index];
+    }
+
+    /**
+     * Returns the referenced element, or a default.
+     *
+     * @tparam U a reference type convertible to `reference`.
+     * @param c the container.
+     * @param default_value the value returned if `*this` does not refer to an element of `c`.
+     * @return the referenced element, or `default_value`.
+     */
+    template <typename U>
+    GCH_NODISCARD constexpr
+    reference
+    value_or (Container& c, U& default_value) const noexcept
+    {
+      return has_value (c) ? c[m_index] : static_cast<reference> (default_value);
+    }
+
+    /**
+     * Removes the index.
+     */
+    GCH_CPP14_CONSTEXPR
+    void
+    reset (void) noexcept
+    {
+      m_index = npos;
+    }
+
+    /**
+     * Sets the index.
+     *
+     * @param index the index of the element.
+     */
+    GCH_CPP14_CONSTEXPR
+    void
+    emplace (index_type index) noexcept
+    {
+      m_index = index;
+    }
+
+  private:
+    index_type m_index;
+  };
+
+#if ! defined (__cpp_inline_variables) || __cpp_inline_variables < 201606L
+
+  template <typename Container, typename Index>
+  constexpr
+  typename optional_index_ref<Container, Index>::index_type
+  optional_index_ref<Container, Index>::npos;
+
+#endif
+
+} // namespace gch
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    // Maps the empty state to 0 and shifts every index up by one so
+    // that empty `optional_index_ref`s are ordered first.
+    template <typename Index>
+    constexpr
+    Index
+    optional_index_order (Index index) noexcept
+    {
+      return static_cast<Index> (index + 1U);
+    }
+
+  }
+
+} // namespace gch
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * Compares two `optional_index_ref`s.
+   *
+   * @return whether `lhs` and `rhs` hold the same index.
+   */
+  template <typename C, typename D, typename Index>
+  GCH_NODISCARD constexpr
+  bool
+  operator== (const optional_index_ref<C, Index>& lhs,
+              const optional_index_ref<D, Index>& rhs) noexcept
+  {
+    return lhs.index () == rhs.index ();
+  }
+
+  /**
+   * Compares two `optional_index_ref`s.
+   *
+   * @return whether `lhs` and `rhs` hold different indices.
+   */
+  template <typename C, typename D, typename Index>
+  GCH_NODISCARD constexpr
+  bool
+  operator!= (const optional_index_ref<C, Index>& lhs,
+              const optional_index_ref<D, Index>& rhs) noexcept
+  {
+    return ! (lhs == rhs);
+  }
+
+  /**
+   * Compares two `optional_index_ref`s by index. An empty
+   * `optional_index_ref` is less than any non-empty one.
+   *
+   * @return whether `lhs` is less than `rhs`.
+   */
+  template <typename C, typename D, typename Index>
+  GCH_NODISCARD constexpr
+  bool
+  operator< (const optional_index_ref<C, Index>& lhs,
+             const optional_index_ref<D, Index>& rhs) noexcept
+  {
+    return detail::optional_index_order (lhs.index ())
+         < detail::optional_index_order (rhs.index ());
+  }
+
+  /**
+   * Compares two `optional_index_ref`s by index.
+   *
+   * @return whether `lhs` is greater than `rhs`.
+   */
+  template <typename C, typename D, typename Index>
+  GCH_NODISCARD constexpr
+  bool
+  operator> (const optional_index_ref<C, Index>& lhs,
+             const optional_index_ref<D, Index>& rhs) noexcept
+  {
+    return rhs < lhs;
+  }
+
+  /**
+   * Compares two `optional_index_ref`s by index.
+   *
+   * @return whether `lhs` is less than or equal to `rhs`.
+   */
+  template <typename C, typename D, typename Index>
+  GCH_NODISCARD constexpr
+  bool
+  operator<= (const optional_index_ref<C, Index>& lhs,
+              const optional_index_ref<D, Index>& rhs) noexcept
+  {
+    return ! (rhs < lhs);
+  }
+
+  /**
+   * Compares two `optional_index_ref`s by index.
+   *
+   * @return whether `lhs` is greater than or equal to `rhs`.
+   */
+  template <typename C, typename D, typename Index>
+  GCH_NODISCARD constexpr
+  bool
+  operator>= (const optional_index_ref<C, Index>& lhs,
+              const optional_index_ref<D, Index>& rhs) noexcept
+  {
+    return ! (lhs < rhs);
+  }
+
+  /**
+   * Compares an `optional_index_ref` with `nullopt`.
+   *
+   * @return whether `lhs` has no value.
+   */
+  template <typename C, typename Index>
+  GCH_NODISCARD constexpr
+  bool
+  operator== (const optional_index_ref<C, Index>& lhs, nullopt_t) noexcept
+  {
+    return ! lhs.has_value ();
+  }
+
+  /**
+   * Compares an `optional_index_ref` with `nullopt`.
+   *
+   * @return whether `rhs` has no value.
+   */
+  template <typename C, typename Index>
+  GCH_NODISCARD constexpr
+  bool
+  operator== (nullopt_t, const optional_index_ref<C, Index>& rhs) noexcept
+  {
+    return ! rhs.has_value ();
+  }
+
+  /**
+   * Compares an `optional_index_ref` with `nullopt`.
+   *
+   * @return whether `lhs` has a value.
+   */
+  template <typename C, typename Index>
+  GCH_NODISCARD constexpr
+  bool
+  operator!= (const optional_index_ref<C, Index>& lhs, nullopt_t) noexcept
+  {
+    return lhs.has_value ();
+  }
+
+  /**
+   * Compares an `optional_index_ref` with `nullopt`.
+   *
+   * @return whether `rhs` has a value.
+   */
+  template <typename C, typename Index>
+  GCH_NODISCARD constexpr
+  bool
+  operator!= (nullopt_t, const optional_index_ref<C, Index>& rhs) noexcept
+  {
+    return rhs.has_value ();
+  }
+
+  /**
+   * Resolves an `optional_index_ref` and forwards it to `maybe_invoke`.
+   *
+   * @tparam Container the container type of `ref`.
+   * @tparam Index the index type of `ref`.
+   * @tparam Functor the type of the functor.
+   * @tparam Args the types of the additional arguments.
+   * @param ref an `optional_index_ref`.
+   * @param c the container into which `ref` is resolved.
+   * @param f the functor.
+   * @param args the additional arguments.
+   * @return the result of `maybe_invoke` on the resolved `optional_ref`.
+   */
+  template <typename Container, typename Index, typename Functor, typename ...Args>
+  inline
+  maybe_invoke_result_t<
+    optional_ref<typename optional_index_ref<Container, Index>::value_type>, Functor, Args...>
+  maybe_invoke (optional_index_ref<Container, Index> ref,
+                typename optional_index_ref<Container, Index>::container_type& c,
+                Functor&& f,
+                Args&&... args)
+    noexcept (is_nothrow_maybe_invocable<
+                optional_ref<typename optional_index_ref<Container, Index>::value_type>,
+                Functor,
+                Args...>::value)
+  {
+    return maybe_invoke (ref.get (c), std::forward<Functor> (f), std::forward<Args> (args)...);
+  }
+
+} // namespace gch
+
+namespace std
+{
+
+  /**
+   * A specialization of `std::hash` for `gch::optional_index_ref`.
+   *
+   * @tparam Container the container type of `gch::optional_index_ref`.
+   * @tparam Index the index type of `gch::optional_index_ref`.
+   */
+  template <typename Container, typename Index>
+  struct hash<gch::optional_index_ref<Container, Index>>
+  {
+    /**
+     * An invocable operator.
+     *
+     * We just use the same hash as the underlying index.
+     *
+     * @param ref a reference to a value of type `gch::optional_index_ref`.
+     * @return a hash of the argument.
+     */
+    std::size_t
+    operator() (const gch::optional_index_ref<Container, Index>& ref) const noexcept
+    {
+      return std::hash<Index> { } (ref.index ());
+    }
+  };
+
+} // namespace std
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_OPTIONAL_REF_OPTIONAL_INDEX_REF_HPP
@@ -0,0 +1,866 @@
+/** optional_span.hpp
+ * Defines `optional_span`, a nullable non-owning reference to an array.
+ *
+ * An `optional_span` is empty when its data pointer is null, so it is the
+ * size of a pointer and a size (or just a pointer with a static extent), and
+ * it may refer to an array of size zero while having a value. It is
+ * trivially copyable, so it is passed in registers.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_OPTIONAL_REF_OPTIONAL_SPAN_HPP
+#define GCH_OPTIONAL_REF_OPTIONAL_SPAN_HPP
+
+#include "core.hpp"
+#include "monadic.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#if defined (__has_include) && __has_include (<span>)
+#  include <span>
+#endif
+
+#if defined (__has_include) && __has_include (<memory>)
+#  include <memory>
+#endif
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * The extent of an `optional_span` whose size is determined at runtime.
+   */
+  GCH_INLINE_VARIABLE constexpr
+  std::size_t
+  dynamic_extent = static_cast<std::size_t> (-1);
+
+  template <typename T, std::size_t Extent = dynamic_extent, std::size_t Alignment = alignof (T)>
+  class optional_span;
+
+} // namespace gch
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    template <std::size_t Extent>
+    struct optional_span_extent
+    {
+      constexpr explicit
+      optional_span_extent (std::size_t) noexcept
+      { }
+
+      GCH_NODISCARD constexpr
+      std::size_t
+      get_extent (void) const noexcept
+      {
+        return Extent;
+      }
+    };
+
+    template <>
+    struct optional_span_extent<dynamic_extent>
+    {
+      constexpr explicit
+      optional_span_extent (std::size_t size) noexcept
+        : m_size (size)
+      { }
+
+      GCH_NODISCARD constexpr
+      std::size_t
+      get_extent (void) const noexcept
+      {
+        return m_size;
+      }
+
+    private:
+      std::size_t m_size;
+    };
+
+    template <std::size_t Alignment, typename T>
+    GCH_NODISCARD inline
+    T *
+    assume_aligned (T *ptr) noexcept
+    {
+#if defined (__cpp_lib_assume_aligned) && __cpp_lib_assume_aligned >= 201811L
+      return std::assume_aligned<Alignment> (ptr);
+#elif defined (__GNUC__)
+      return static_cast<T *> (__builtin_assume_aligned (ptr, Alignment));
+#else
+      return ptr;
+#endif
+    }
+
+    // Checks in debug builds that a pointer has the alignment which will be
+    // assumed for it. Spans which assume only `alignof (T)` are not checked,
+    // so that they may be constructed in constant expressions.
+    template <std::size_t Alignment, typename T>
+    constexpr
+    T *
+    check_span_alignment (T *ptr) noexcept
+    {
+      return assert (Alignment <= alignof (T)
+                 ||  reinterpret_cast<std::uintptr_t> (ptr) % Alignment == 0), ptr;
+    }
+
+    // Checks in debug builds that the size of a span with a static extent is
+    // the extent.
+    template <std::size_t Extent, typename T>
+    constexpr
+    std::size_t
+    check_span_extent (T *ptr, std::size_t size) noexcept
+    {
+      return assert (Extent == dynamic_extent || ptr == nullptr || size == Extent), size;
+    }
+
+    // The alignment which holds for every element of a span whose first
+    // element has an alignment of `Alignment`.
+    template <typename T, std::size_t Alignment>
+    struct optional_span_element_alignment
+      : std::integral_constant<std::size_t,
+                               (sizeof (T) & (~sizeof (T) + 1)) < Alignment
+                             ? (sizeof (T) & (~sizeof (T) + 1))
+                             : Alignment>
+    { };
+
+    template <typename Container, typename T>
+    using container_data_convertible = std::is_convertible<
+      typename std::remove_pointer<decltype (std::declval<Container&> ().data ())>::type (*)[],
+      T (*)[]>;
+
+    template <typename T>
+    struct is_optional_span
+      : std::false_type
+    { };
+
+    template <typename T, std::size_t Extent, std::size_t Alignment>
+    struct is_optional_span<optional_span<T, Extent, Alignment>>
+      : std::true_type
+    { };
+
+    template <typename T>
+    struct is_std_span
+      : std::false_type
+    { };
+
+#if defined (__cpp_lib_span) && __cpp_lib_span >= 202002L
+
+    template <typename T, std::size_t Extent>
+    struct is_std_span<std::span<T, Extent>>
+      : std::true_type
+    { };
+
+#endif
+
+  }
+
+} // namespace gch
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * A nullable non-owning reference to a contiguous array.
+   *
+   * The `optional_span` has no value if its data pointer is `nullptr`.
+   *
+   * `Alignment` is an assumption on the alignment of the data pointer, which
+   * is passed on to the compiler by `data` so that consumers may be
+   * vectorized without runtime alignment checks. The behavior is undefined
+   * if a pointer with a smaller alignment is stored. When `Alignment` is
+   * greater than `alignof (T)`, the constructors from pointers, arrays,
+   * containers, and `std::span`s are explicit, and the alignment is checked
+   * by an `assert`.
+   *
+   * @tparam T the element type, which may be const-qualified.
+   * @tparam Extent the number of elements, or `dynamic_extent`.
+   * @tparam Alignment the assumed alignment of the data pointer.
+   */
+  template <typename T, std::size_t Extent, std::size_t Alignment>
+  class optional_span
+    : private detail::optional_span_extent<Extent>
+  {
+    static_assert (! std::is_reference<T>::value && std::is_object<T>::value,
+                   "optional_span expects an object type as a template argument.");
+
+    static_assert ((Alignment & (Alignment - 1)) == 0 && Alignment >= alignof (T),
+                   "The alignment must be a power of two, and at least the alignment of T.");
+
+    using extent_base = detail::optional_span_extent<Extent>;
+
+  public:
+    using element_type = T;                                   /*!< The element type          */
+    using value_type   = typename std::remove_cv<T>::type;    /*!< The unqualified type      */
+    using size_type    = std::size_t;                         /*!< An unsigned integral type */
+    using pointer      = T *;                                 /*!< A pointer to an element   */
+    using reference    = T&;                                  /*!< A reference to an element */
+    using iterator     = T *;                                 /*!< An iterator               */
+
+#if defined (__cpp_lib_span) && __cpp_lib_span >= 202002L
+    /**
+     * The type of the array reference returned by `value`.
+     */
+    using span_type = std::span<T, Extent>;
+#else
+    /**
+     * The type of the array reference returned by `value`. `std::span` is
+     * not available, so this is `optional_span` itself.
+     */
+    using span_type = optional_span;
+#endif
+
+    /**
+     * The number of elements, or `dynamic_extent`.
+     */
+    static constexpr
+    std::size_t
+    extent = Extent;
+
+    /**
+     * The assumed alignment of the data pointer.
+     */
+    static constexpr
+    std::size_t
+    alignment = Alignment;
+
+    /**
+     * Constructor
+     *
+     * The `optional_span` has no value after default construction.
+     */
+    constexpr
+    optional_span (void) noexcept
+      : extent_base (0),
+        m_data      (nullptr)
+    { }
+
+    /**
+     * Constructor
+     *
+     * Constructs an `optional_span` with no value.
+     */
+    constexpr /* implicit */
+    optional_span (nullopt_t) noexcept
+      : optional_span ()
+    { }
+
+    /**
+     * Constructor
+     *
+     * Constructs an `optional_span` from a pointer and a size.
+     *
+     * If `data` is `nullptr`, the result has no value. If `Extent` is not
+     * `dynamic_extent`, then `size` must be equal to `Extent`.
+     *
+     * @param data a pointer to the first element.
+     * @param size the number of elements.
+     */
+    template <std::size_t A = Alignment,
+              typename std::enable_if<A == alignof (T)>::type * = nullptr>
+    constexpr
+    optional_span (pointer data, size_type size) noexcept
+      : extent_base (data != nullptr ? detail::check_span_extent<Extent> (data, size) : 0),
+        m_data      (data)
+    { }
+
+    /**
+     * Constructor
+     *
+     * Constructs an `optional_span` from a pointer and a size, for the case
+     * where `data` is assumed to be over-aligned. If `Extent` is not
+     * `dynamic_extent`, then `size` must be equal to `Extent`.
+     *
+     * @param data a pointer to the first element, aligned to `Alignment`.
+     * @param size the number of elements.
+     */
+    template <std::size_t A = Alignment,
+              typename std::enable_if<(A > alignof (T))>::type * = nullptr>
+    constexpr explicit
+    optional_span (pointer data, size_type size) noexcept
+      : extent_base (data != nullptr ? detail::check_span_extent<Extent> (data, size) : 0),
+        m_data      (detail::check_span_alignment<Alignment> (data))
+    { }
+
+    /**
+     * Constructor
+     *
+     * Constructs an `optional_span` which refers to an array.
+     *
+     * @tparam N the size of the array.
+     * @param arr an array.
+     */
+    template <std::size_t N, std::size_t A = Alignment,
+              typename std::enable_if<
+                    (Extent == dynamic_extent || N == Extent)
+                &&  A == alignof (T)>::type * = nullptr>
+    constexpr /* implicit */
+    optional_span (element_type (&arr)[N]) noexcept
+      : extent_base (N),
+        m_data      (arr)
+    { }
+
+    /**
+     * Constructor
+     *
+     * Constructs an `optional_span` which refers to an array, for the case
+     * where the array is assumed to be over-aligned.
+     *
+     * @tparam N the size of the array.
+     * @param arr an array aligned to `Alignment`.
+     */
+    template <std::size_t N, std::size_t A = Alignment,
+              typename std::enable_if<
+                    (Extent == dynamic_extent || N == Extent)
+                &&  (A > alignof (T))>::type * = nullptr>
+    constexpr explicit
+    optional_span (element_type (&arr)[N]) noexcept
+      : extent_base (N),
+        m_data      (detail::check_span_alignment<Alignment> (+arr))
+    { }
+
+    /**
+     * Constructor
+     *
+     * Constructs an `optional_span` which refers to the elements of a
+     * contiguous container (one with `data` and `size` members). The
+     * result has a value even if the container is empty.
+     *
+     * @tparam Container the type of the container.
+     * @param c a contiguous container.
+     */
+    template <typename Container, std::size_t A = Alignment,
+              typename std::enable_if<
+                    ! detail::is_optional_span<typename std::remove_cv<Container>::type>::value
+                &&! detail::is_std_span<typename std::remove_cv<Container>::type>::value
+                &&! std::is_array<Container>::value
+                &&  detail::container_data_convertible<Container, T>::value
+                &&  (Extent == dynamic_extent)
+                &&  A == alignof (T)
+              >::type * = nullptr>
+    constexpr /* implicit */
+    optional_span (Container& c) noexcept (noexcept (c.data ()) && noexcept (c.size ()))
+      : extent_base (static_cast<size_type> (c.size ())),
+        m_data      (c.data () != nullptr ? c.data () : non_null_empty ())
+    { }
+
+    /**
+     * Constructor
+     *
+     * Constructs an `optional_span` which refers to the elements of a
+     * contiguous container, for the case where its data is assumed to be
+     * over-aligned.
+     *
+     * @tparam Container the type of the container.
+     * @param c a contiguous container whose data is aligned to `Alignment`.
+     */
+    template <typename Container, std::size_t A = Alignment,
+              typename std::enable_if<
+                    ! detail::is_optional_span<typename std::remove_cv<Container>::type>::value
+                &&! detail::is_std_span<typename std::remove_cv<Container>::type>::value
+                &&! std::is_array<Container>::value
+                &&  detail::container_data_convertible<Container, T>::value
+                &&  (Extent == dynamic_extent)
+                &&  (A > alignof (T))
+              >::type * = nullptr>
+    constexpr explicit
+    optional_span (Container& c) noexcept (noexcept (c.data ()) && noexcept (c.size ()))
+      : extent_base (static_cast<size_type> (c.size ())),
+        m_data      (c.data () != nullptr ? detail::check_span_alignment<Alignment> (c.data ())
+                                          : non_null_empty ())
+    { }
+
+    /**
+     * Constructor
+     *
+     * A converting constructor from `optional_span`s with a compatible
+     * element type, extent, and alignment.
+     *
+     * @tparam U the element type of `other`.
+     * @tparam E the extent of `other`.
+     * @tparam A the alignment of `other`.
+     * @param other an `optional_span`.
+     */
+    template <typename U, std::size_t E, std::size_t A,
+              typename std::enable_if<
+                    std::is_convertible<U (*)[], T (*)[]>::value
+                &&  (Extent == dynamic_extent || E == Extent)
+                &&  A >= Alignment
+                &&! (std::is_same<U, T>::value && E == Extent && A == Alignment)
+              >::type * = nullptr>
+    constexpr /* implicit */
+    optional_span (const optional_span<U, E, A>& other) noexcept
+      : extent_base (other.size ()),
+        m_data      (other.get_pointer ())
+    { }
+
+#if defined (__cpp_lib_span) && __cpp_lib_span >= 202002L
+
+    /**
+     * Constructor
+     *
+     * Constructs an `optional_span` from a `std::span`. The result has no
+     * value if the data pointer of `s` is `nullptr`.
+     *
+     * @tparam U the element type of `s`.
+     * @tparam E the extent of `s`.
+     * @param s a `std::span`.
+     */
+    template <typename U, std::size_t E, std::size_t A = Alignment,
+              typename std::enable_if<
+                    std::is_convertible<U (*)[], T (*)[]>::value
+                &&  (Extent == dynamic_extent || E == Extent)
+                &&  A == alignof (T)
+              >::type * = nullptr>
+    constexpr /* implicit */
+    optional_span (std::span<U, E> s) noexcept
+      : optional_span (s.data (), s.size ())
+    { }
+
+    /**
+     * Constructor
+     *
+     * Constructs an `optional_span` from a `std::span`, for the case where
+     * its data is assumed to be over-aligned.
+     *
+     * @tparam U the element type of `s`.
+     * @tparam E the extent of `s`.
+     * @param s a `std::span` whose data is aligned to `Alignment`.
+     */
+    template <typename U, std::size_t E, std::size_t A = Alignment,
+              typename std::enable_if<
+                    std::is_convertible<U (*)[], T (*)[]>::value
+                &&  (Extent == dynamic_extent || E == Extent)
+                &&  (A > alignof (T))
+              >::type * = nullptr>
+    constexpr explicit
+    optional_span (std::span<U, E> s) noexcept
+      : optional_span (s.data (), s.size ())
+    { }
+
+    /**
+     * Converts to a `std::span`. The result is empty if `*this` has no value.
+     *
+     * This is only available with a dynamic extent, since a `std::span`
+     * with a static extent cannot be empty.
+     *
+     * @return a `std::span` of the elements.
+     */
+    template <std::size_t E = Extent,
+              typename std::enable_if<E == dynamic_extent>::type * = nullptr>
+    GCH_NODISCARD constexpr /* implicit */
+    operator std::span<T> (void) const noexcept
+    {
+      return std::span<T> (get_pointer (), size ());
+    }
+
+#endif
+
+    /**
+     * Checks if the `*this` contains a value.
+     *
+     * Internally, this is just a check against `nullptr`.
+     *
+     * @return whether this `*this` contains a value.
+     */
+    GCH_NODISCARD constexpr
+    bool
+    has_value (void) const noexcept
+    {
+      return m_data != nullptr;
+    }
+
+    /**
+     * Checks if the `*this` contains a value.
+     *
+     * The return is forwarded from `has_value ()`.
+     *
+     * @return whether this `*this` contains a value.
+     */
+    GCH_NODISCARD constexpr explicit
+    operator bool (void) const noexcept
+    {
+      return has_value ();
+    }
+
+    /**
+     * Returns the data pointer without the alignment assumption.
+     *
+     * @return the data pointer, or `nullptr` if `*this` has no value.
+     */
+    GCH_NODISCARD constexpr
+    pointer
+    get_pointer (void) const noexcept
+    {
+      return m_data;
+    }
+
+    /**
+     * Returns the data pointer, with the alignment assumption.
+     *
+     * @return the data pointer, or `nullptr` if `*this` has no value.
+     */
+    GCH_NODISCARD
+    pointer
+    data (void) const noexcept
+    {
+      return detail::assume_aligned<Alignment> (m_data);
+    }
+
+    /**
+     * Returns the number of elements.
+     *
+     * @return the number of elements, or `0` if `*this` has no value.
+     */
+    GCH_NODISCARD constexpr
+    size_type
+    size (void) const noexcept
+    {
+      return has_value () ? extent_base::get_extent () : 0;
+    }
+
+    /**
+     * Returns the size of the elements in bytes.
+     *
+     * @return the size of the elements in bytes.
+     */
+    GCH_NODISCARD constexpr
+    size_type
+    size_bytes (void) const noexcept
+    {
+      return size () * sizeof (element_type);
+    }
+
+    /**
+     * Checks if there are no elements, either because `*this` has
+     * no value or because it refers to an empty array.
+     *
+     * @return whether there are no elements.
+     */
+    GCH_NODISCARD constexpr
+    bool
+    empty (void) const noexcept
+    {
+      return size () == 0;
+    }
+
+    /**
+     * Returns an iterator to the first element.
+     *
+     * @return an iterator to the first element.
+     */
+    GCH_NODISCARD
+    iterator
+    begin (void) const noexcept
+    {
+      return data ();
+    }
+
+    /**
+     * Returns an iterator past the last element.
+     *
+     * @return an iterator past the last element.
+     */
+    GCH_NODISCARD
+    iterator
+    end (void) const noexcept
+    {
+      return data () + size ();
+    }
+
+    /**
+     * Returns an element.
+     *
+     * The behavior is undefined if `idx` is not less than `size ()`.
+     *
+     * @param idx the index of the element.
+     * @return a reference to the element.
+     */
+    GCH_NODISCARD
+    reference
+    operator[] (size_type idx) const noexcept
+    {
+      return data ()[idx];
+    }
+
+    /**
+     * Returns the array reference, while checking whether it exists.
+     *
+     * @throws bad_optional_access when `*this` does not contain a value.
+     *
+     * @see gch::set_bad_optional_access_handler
+     *
+     * @return the array reference.
+     */
+    GCH_NODISCARD GCH_CPP14_CONSTEXPR
+    span_type
+    value (void) const
+    {
+      if (! has_value ())
+        detail::bad_optional_access_failure ();
+      return span_type (m_data, extent_base::get_extent ());
+    }
+
+    /**
+     * Returns the array reference, or a default.
+     *
+     * @param default_value the value returned if `*this` does not contain a value.
+     * @return the array reference, or `default_value`.
+     */
+    GCH_NODISCARD constexpr
+    span_type
+    value_or (span_type default_value) const noexcept
+    {
+      return has_value () ? span_type (m_data, extent_base::get_extent ()) : default_value;
+    }
+
+    /**
+     * Returns the first `count` elements. The alignment is preserved.
+     *
+     * The behavior is undefined if `count` is greater than `size ()`.
+     *
+     * @param count the number of elements.
+     * @return an `optional_span` of the first `count` elements, or an
+     *         `optional_span` with no value if `*this` has no value.
+     */
+    GCH_NODISCARD constexpr
+    optional_span<T, dynamic_extent, Alignment>
+    first (size_type count) const noexcept
+    {
+      return optional_span<T, dynamic_extent, Alignment> (m_data, count);
+    }
+
+    /**
+     * The type of the spans returned by `last` and `subspan`. Their first
+     * element may be any element of `*this`, so they only keep the alignment
+     * which holds for every element.
+     */
+    using element_span_type = optional_span<
+      T, dynamic_extent, detail::optional_span_element_alignment<T, Alignment>::value>;
+
+    /**
+     * Returns the last `count` elements. The alignment is reduced to that
+     * of an arbitrary element (see `element_span_type`).
+     *
+     * The behavior is undefined if `count` is greater than `size ()`.
+     *
+     * @param count the number of elements.
+     * @return an `optional_span` of the last `count` elements, or an
+     *         `optional_span` with no value if `*this` has no value.
+     */
+    GCH_NODISCARD constexpr
+    element_span_type
+    last (size_type count) const noexcept
+    {
+      return has_value () ? element_span_type (m_data + (size () - count), count)
+                          : element_span_type ();
+    }
+
+    /**
+     * Returns a subrange of the elements. The alignment is reduced to that
+     * of an arbitrary element (see `element_span_type`).
+     *
+     * The behavior is undefined if the subrange is not within the elements.
+     *
+     * @param offset the index of the first element of the subrange.
+     * @param count the number of elements, or `dynamic_extent` for the
+     *              rest of the elements.
+     * @return an `optional_span` of the subrange, or an `optional_span`
+     *         with no value if `*this` has no value.
+     */
+    GCH_NODISCARD constexpr
+    element_span_type
+    subspan (size_type offset, size_type count = dynamic_extent) const noexcept
+    {
+      return has_value ()
+           ? element_span_type (m_data + offset,
+                                count == dynamic_extent ? size () - offset : count)
+           : element_span_type ();
+    }
+
+    /**
+     * Removes the array reference.
+     */
+    GCH_CPP14_CONSTEXPR
+    void
+    reset (void) noexcept
+    {
+      *this = optional_span ();
+    }
+
+  private:
+    // A non-null pointer for containers with no allocation, so that they
+    // are distinguished from an `optional_span` with no value.
+    static
+    pointer
+    non_null_empty (void) noexcept
+    {
+      alignas (Alignment) static unsigned char sentinel;
+      return reinterpret_cast<pointer> (&sentinel);
+    }
+
+    pointer m_data;
+  };
+
+#if ! defined (__cpp_inline_variables) || __cpp_inline_variables < 201606L
+
+  template <typename T, std::size_t Extent, std::size_t Alignment>
+  constexpr
+  std::size_t
+  optional_span<T, Extent, Alignment>::extent;
+
+  template <typename T, std::size_t Extent, std::size_t Alignment>
+  constexpr
+  std::size_t
+  optional_span<T, Extent, Alignment>::alignment;
+
+#endif
+
+  /**
+   * An equality comparison function.
+   *
+   * @return whether `lhs` has no value.
+   */
+  template <typename T, std::size_t Extent, std::size_t Alignment>
+  GCH_NODISCARD constexpr
+  bool
+  operator== (const optional_span<T, Extent, Alignment>& lhs, nullopt_t) noexcept
+  {
+    return ! lhs.has_value ();
+  }
+
+  /**
+   * An equality comparison function.
+   *
+   * @return whether `rhs` has no value.
+   */
+  template <typename T, std::size_t Extent, std::size_t Alignment>
+  GCH_NODISCARD constexpr
+  bool
+  operator== (nullopt_t, const optional_span<T, Extent, Alignment>& rhs) noexcept
+  {
+    return ! rhs.has_value ();
+  }
+
+  /**
+   * An inequality comparison function.
+   *
+   * @return whether `lhs` has a value.
+   */
+  template <typename T, std::size_t Extent, std::size_t Alignment>
+  GCH_NODISCARD constexpr
+  bool
+  operator!= (const optional_span<T, Extent, Alignment>& lhs, nullopt_t) noexcept
+  {
+    return lhs.has_value ();
+  }
+
+  /**
+   * An inequality comparison function.
+   *
+   * @return whether `rhs` has a value.
+   */
+  template <typename T, std::size_t Extent, std::size_t Alignment>
+  GCH_NODISCARD constexpr
+  bool
+  operator!= (nullopt_t, const optional_span<T, Extent, Alignment>& rhs) noexcept
+  {
+    return rhs.has_value ();
+  }
+
+} // namespace gch
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    template <typename Span, typename Functor, typename ...Args>
+    using optional_span_invoke_result_t = typename maybe_invoke_wrap<
+      decltype (std::declval<Functor> () (std::declval<typename Span::span_type> (),
+                                          std::declval<Args> ()...))>::type;
+
+    template <typename Result, typename Span, typename Functor, typename ...Args>
+    GCH_CPP14_CONSTEXPR
+    void
+    maybe_invoke_optional_span (std::true_type, Span s, Functor&& f, Args&&... args)
+    {
+      if (s.has_value ())
+      {
+        std::forward<Functor> (f) (typename Span::span_type (s.get_pointer (), s.size ()),
+                                   std::forward<Args> (args)...);
+      }
+    }
+
+    template <typename Result, typename Span, typename Functor, typename ...Args>
+    constexpr
+    Result
+    maybe_invoke_optional_span (std::false_type, Span s, Functor&& f, Args&&... args)
+    {
+      return s.has_value ()
+           ? Result (std::forward<Functor> (f) (typename Span::span_type (s.get_pointer (), s.size ()),
+                                                std::forward<Args> (args)...))
+           : Result ();
+    }
+
+  }
+
+} // namespace gch
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * Invokes a functor with the array reference of an `optional_span`,
+   * if it has a value.
+   *
+   * The return type is mapped in the same way as for `optional_ref`:
+   * lvalue references are wrapped in `optional_ref`, default-constructible
+   * objects are returned directly (default-constructed if there is no
+   * value), and anything else results in `void`.
+   *
+   * @tparam T the element type of `s`.
+   * @tparam Extent the extent of `s`.
+   * @tparam Alignment the alignment of `s`.
+   * @tparam Functor a functor type invocable with `span_type` and `Args...`.
+   * @tparam Args the types of the additional arguments.
+   * @param s an `optional_span`.
+   * @param f the functor.
+   * @param args the additional arguments.
+   * @return the mapped result of the invocation.
+   */
+  template <typename T, std::size_t Extent, std::size_t Alignment,
+            typename Functor, typename ...Args>
+  GCH_CPP14_CONSTEXPR
+  detail::optional_span_invoke_result_t<optional_span<T, Extent, Alignment>, Functor, Args...>
+  maybe_invoke (optional_span<T, Extent, Alignment> s, Functor&& f, Args&&... args)
+  {
+    using result_type = detail::optional_span_invoke_result_t<
+      optional_span<T, Extent, Alignment>, Functor, Args...>;
+
+    return detail::maybe_invoke_optional_span<result_type> (
+      std::is_void<result_type> { }, s, std::forward<Functor> (f), std::forward<Args> (args)...);
+  }
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_OPTIONAL_REF_OPTIONAL_SPAN_HPP
@@ -0,0 +1,504 @@
+/** partition_by_type.hpp
+ * Defines `partition_by_type`, a batch counterpart to `maybe_cast`.
+ *
+ * A sequence of `optional_ref<Base>` is sorted into one bucket for each of a
+ * list of derived types in a single pass, so that each bucket may then be
+ * processed in its own loop without further casts or type tests.
+ *
+ * If every type is cast with a `cast_traits` specialization deriving from
+ * `kind_range_cast_traits`, with the same kind type and a combined range of
+ * at most 256 kinds, the kind of each element is read once and its bucket is
+ * looked up in a table, which is O(1) in the number of types. Otherwise each
+ * element is cast to each type in turn until one succeeds, which is O(N).
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_OPTIONAL_REF_PARTITION_BY_TYPE_HPP
+#define GCH_OPTIONAL_REF_PARTITION_BY_TYPE_HPP
+
+#include "core.hpp"
+#include "cast.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    template <typename T, typename Base>
+    using partition_bucket_value_t = decltype (maybe_cast<T> (std::declval<optional_ref<Base>> ()));
+
+    template <typename T, typename ...Ts>
+    struct partition_type_index;
+
+    template <typename T, typename ...Rest>
+    struct partition_type_index<T, T, Rest...>
+      : std::integral_constant<std::size_t, 0>
+    { };
+
+    template <typename T, typename U, typename ...Rest>
+    struct partition_type_index<T, U, Rest...>
+      : std::integral_constant<std::size_t, 1 + partition_type_index<T, Rest...>::value>
+    { };
+
+    // Tries each type in order, and stops at the first which matches.
+    template <std::size_t I, typename ...Ts>
+    struct partition_inserter
+    {
+      template <typename Buckets, typename Base>
+      static
+      bool
+      insert (Buckets&, optional_ref<Base>)
+      {
+        return false;
+      }
+    };
+
+    template <std::size_t I, typename T, typename ...Rest>
+    struct partition_inserter<I, T, Rest...>
+    {
+      template <typename Buckets, typename Base>
+      static
+      bool
+      insert (Buckets& buckets, optional_ref<Base> ref)
+      {
+        partition_bucket_value_t<T, Base> cast = maybe_cast<T> (ref);
+        if (cast.has_value ())
+        {
+          std::get<I> (buckets).push_back (cast);
+          return true;
+        }
+        return partition_inserter<I + 1, Rest...>::insert (buckets, ref);
+      }
+    };
+
+    // The range of kinds of `Traits` if it derives from `kind_range_cast_traits`.
+    template <typename Traits, typename Enable = void>
+    struct partition_kind_range
+    {
+      using kind_type = void;
+    };
+
+    template <typename Traits>
+    struct partition_kind_range<
+      Traits,
+      typename std::enable_if<
+        std::is_base_of<kind_range_cast_traits<typename Traits::kind_type,
+                                               Traits::first_kind,
+                                               Traits::last_kind>,
+                        Traits>::value>::type>
+    {
+      using kind_type     = typename Traits::kind_type;
+      using unsigned_type = typename cast_kind_unsigned<kind_type>::type;
+
+      static constexpr unsigned_type first = static_cast<unsigned_type> (Traits::first_kind);
+      static constexpr unsigned_type last  = static_cast<unsigned_type> (Traits::last_kind);
+    };
+
+    // The kind type by which `maybe_cast<T>` tests a `Base`, or `void` if it
+    // does not test a range of kinds.
+    template <typename Base, typename T,
+              typename Traits = cast_traits<typename std::remove_cv<T>::type>>
+    using partition_kind_t = typename std::conditional<
+      std::is_same<cast_tag<T, typename std::remove_cv<Base>::type>,
+                   traits_classof_cast_tag>::value,
+      typename partition_kind_range<Traits>::kind_type,
+      void>::type;
+
+    template <typename T, typename ...Ts>
+    struct partition_all_same
+      : std::true_type
+    { };
+
+    template <typename T, typename U, typename ...Rest>
+    struct partition_all_same<T, U, Rest...>
+      : std::integral_constant<bool,
+                               std::is_same<T, U>::value && partition_all_same<T, Rest...>::value>
+    { };
+
+    template <typename U>
+    constexpr
+    U
+    partition_kind_min (U u) noexcept
+    {
+      return u;
+    }
+
+    template <typename U, typename ...Us>
+    constexpr
+    U
+    partition_kind_min (U u, U v, Us... rest) noexcept
+    {
+      return partition_kind_min (u < v ? u : v, rest...);
+    }
+
+    template <typename U>
+    constexpr
+    U
+    partition_kind_max (U u) noexcept
+    {
+      return u;
+    }
+
+    template <typename U, typename ...Us>
+    constexpr
+    U
+    partition_kind_max (U u, U v, Us... rest) noexcept
+    {
+      return partition_kind_max (u < v ? v : u, rest...);
+    }
+
+    constexpr
+    bool
+    partition_all (void) noexcept
+    {
+      return true;
+    }
+
+    template <typename ...Bs>
+    constexpr
+    bool
+    partition_all (bool b, Bs... rest) noexcept
+    {
+      return b && partition_all (rest...);
+    }
+
+    // The index of the first of `Ts...` whose range of kinds contains `kind`,
+    // or `sizeof... (Ts)` if there is none.
+    template <typename ...Ts>
+    struct partition_kind_bucket
+    {
+      template <typename U>
+      static constexpr
+      unsigned char
+      of (U) noexcept
+      {
+        return 0;
+      }
+    };
+
+    template <typename T, typename ...Rest>
+    struct partition_kind_bucket<T, Rest...>
+    {
+      template <typename U>
+      static constexpr
+      unsigned char
+      of (U kind) noexcept
+      {
+        using range = partition_kind_range<cast_traits<typename std::remove_cv<T>::type>>;
+        return (range::first <= kind && kind <= range::last)
+               ? 0
+               : static_cast<unsigned char> (1 + partition_kind_bucket<Rest...>::of (kind));
+      }
+    };
+
+    // Maps each kind in the combined range of `Ts...` to the index of the first
+    // of `Ts...` whose range contains it, or to `sizeof... (Ts)` if there is
+    // none. It is usable if every type is tested by a range of the same kind
+    // type, and the combined range is small.
+    template <typename Base, typename Kind, bool SameKind, typename ...Ts>
+    struct partition_kind_table_impl
+    {
+      static constexpr bool usable = false;
+    };
+
+    template <typename Base, typename Kind, typename ...Ts>
+    struct partition_kind_table_impl<Base, Kind, true, Ts...>
+    {
+      using unsigned_type = typename cast_kind_unsigned<Kind>::type;
+
+      static constexpr unsigned_type first = partition_kind_min (
+        partition_kind_range<cast_traits<typename std::remove_cv<Ts>::type>>::first...);
+
+      static constexpr unsigned_type last = partition_kind_max (
+        partition_kind_range<cast_traits<typename std::remove_cv<Ts>::type>>::last...);
+
+      static constexpr std::size_t size_limit = 256;
+
+      static constexpr bool usable =
+            partition_all ((partition_kind_range<cast_traits<typename std::remove_cv<Ts>::type>>::first
+                        <=  partition_kind_range<cast_traits<typename std::remove_cv<Ts>::type>>::last)...)
+        &&  static_cast<std::size_t> (last - first) < size_limit;
+
+      static constexpr std::size_t size = usable ? static_cast<std::size_t> (last - first) + 1 : 1;
+
+      partition_kind_table_impl (void) noexcept
+      {
+        for (std::size_t i = 0; i < size; ++i)
+          buckets[i] = partition_kind_bucket<Ts...>::of (static_cast<unsigned_type> (first + i));
+      }
+
+      static
+      const partition_kind_table_impl&
+      get (void) noexcept
+      {
+        static const partition_kind_table_impl table;
+        return table;
+      }
+
+      unsigned char buckets[size];
+    };
+
+    template <typename Base, typename ...Ts>
+    struct partition_kind_table;
+
+    template <typename Base>
+    struct partition_kind_table<Base>
+      : partition_kind_table_impl<Base, void, false>
+    { };
+
+    template <typename Base, typename T, typename ...Rest>
+    struct partition_kind_table<Base, T, Rest...>
+      : partition_kind_table_impl<
+          Base,
+          partition_kind_t<Base, T>,
+              ! std::is_void<partition_kind_t<Base, T>>::value
+          &&  partition_all_same<partition_kind_t<Base, T>, partition_kind_t<Base, Rest>...>::value
+          &&  (sizeof... (Rest) < 255),
+          T, Rest...>
+    { };
+
+    template <typename Iterator>
+    using partition_base_t =
+      typename std::iterator_traits<Iterator>::value_type::value_type;
+
+  }
+
+} // namespace gch
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * The result of `partition_by_type`.
+   *
+   * Holds one bucket of `optional_ref`s for each of `Ts...`, and one for the
+   * elements which matched none of them. No bucket holds an empty
+   * `optional_ref`.
+   *
+   * An object may be reused with `partition` to avoid reallocating
+   * the buckets.
+   *
+   * @tparam Base the value type of the input `optional_ref`s.
+   * @tparam Ts the types to partition by.
+   */
+  template <typename Base, typename ...Ts>
+  class type_partition
+  {
+    using buckets_type = std::tuple<std::vector<detail::partition_bucket_value_t<Ts, Base>>...>;
+
+  public:
+    /**
+     * The type of the bucket for `T`.
+     *
+     * @tparam T one of `Ts...`.
+     */
+    template <typename T>
+    using bucket_type = std::vector<detail::partition_bucket_value_t<T, Base>>;
+
+    /**
+     * Clears the buckets and sorts the elements of `[first, last)` into them.
+     *
+     * Each element is placed into the bucket of the first of `Ts...` to which
+     * `maybe_cast` succeeds. Empty elements are dropped. See the description
+     * of partition_by_type.hpp for when this is O(1) per element.
+     *
+     * @tparam InputIt an input iterator to `optional_ref<Base>`.
+     * @param first the beginning of the input.
+     * @param last the end of the input.
+     */
+    template <typename InputIt>
+    void
+    partition (InputIt first, InputIt last)
+    {
+      clear ();
+      partition_impl (first, last, std::integral_constant<bool, kind_table::usable> { });
+    }
+
+    /**
+     * Gets the bucket for `T`.
+     *
+     * @tparam T one of `Ts...`.
+     * @return the `optional_ref`s whose referents are of type `T`.
+     */
+    template <typename T>
+    GCH_NODISCARD
+    const bucket_type<T>&
+    bucket (void) const noexcept
+    {
+      return std::get<detail::partition_type_index<T, Ts...>::value> (m_buckets);
+    }
+
+    /**
+     * Gets the elements which matched none of `Ts...`.
+     *
+     * @return the unmatched `optional_ref`s.
+     */
+    GCH_NODISCARD
+    const std::vector<optional_ref<Base>>&
+    unmatched (void) const noexcept
+    {
+      return m_unmatched;
+    }
+
+    /**
+     * Empties every bucket without releasing its storage.
+     */
+    void
+    clear (void) noexcept
+    {
+      clear_buckets (std::integral_constant<std::size_t, 0> { });
+      m_unmatched.clear ();
+    }
+
+  private:
+    using kind_table = detail::partition_kind_table<Base, Ts...>;
+
+    // Reads the kind of each element once and looks up its bucket.
+    template <typename InputIt>
+    void
+    partition_impl (InputIt first, InputIt last, std::true_type)
+    {
+      using unsigned_type = typename kind_table::unsigned_type;
+      using inserter_type = void (*) (buckets_type&, Base *);
+
+      static constexpr inserter_type inserters[] {
+        &insert_at<detail::partition_type_index<Ts, Ts...>::value, Ts>...
+      };
+
+      const auto& table = kind_table::get ();
+      for (; first != last; ++first)
+      {
+        optional_ref<Base> ref = *first;
+        if (! ref.has_value ())
+          continue;
+
+        std::size_t offset = static_cast<unsigned_type> (
+            static_cast<unsigned_type> (detail::get_cast_kind (*ref))
+          - static_cast<unsigned_type> (kind_table::first));
+        std::size_t index = offset < kind_table::size ? table.buckets[offset] : sizeof... (Ts);
+        if (index < sizeof... (Ts))
+          inserters[index] (m_buckets, ref.get_pointer ());
+        else
+          m_unmatched.push_back (ref);
+      }
+    }
+
+    // Tries `maybe_cast` to each type in order.
+    template <typename InputIt>
+    void
+    partition_impl (InputIt first, InputIt last, std::false_type)
+    {
+      for (; first != last; ++first)
+      {
+        optional_ref<Base> ref = *first;
+        if (ref.has_value ()
+            &&! detail::partition_inserter<0, Ts...>::insert (m_buckets, ref))
+        {
+          m_unmatched.push_back (ref);
+        }
+      }
+    }
+
+    template <std::size_t I, typename T>
+    static
+    void
+    insert_at (buckets_type& buckets, Base *ptr)
+    {
+      using value_type = detail::partition_bucket_value_t<T, Base>;
+      std::get<I> (buckets).push_back (
+        value_type { static_cast<typename value_type::pointer> (ptr) });
+    }
+
+    void
+    clear_buckets (std::integral_constant<std::size_t, sizeof... (Ts)>) noexcept
+    { }
+
+    template <std::size_t I>
+    void
+    clear_buckets (std::integral_constant<std::size_t, I>) noexcept
+    {
+      std::get<I> (m_buckets).clear ();
+      clear_buckets (std::integral_constant<std::size_t, I + 1> { });
+    }
+
+    buckets_type                    m_buckets;
+    std::vector<optional_ref<Base>> m_unmatched;
+  };
+
+  /**
+   * Sorts a sequence of `optional_ref`s into buckets by the dynamic type of
+   * their referents.
+   *
+   * Each element is placed into the bucket of the first of `Ts...` to which
+   * `maybe_cast` succeeds, so more derived types should be listed before
+   * their bases. Empty elements are dropped.
+   *
+   *     auto parts = gch::partition_by_type<circle, square> (shapes);
+   *     for (gch::optional_ref<circle> c : parts.bucket<circle> ())
+   *       draw (*c);
+   *
+   * @tparam Ts the types to partition by.
+   * @tparam InputIt an input iterator to `optional_ref<Base>`.
+   * @param first the beginning of the input.
+   * @param last the end of the input.
+   * @return a `type_partition` holding the buckets.
+   *
+   * @see gch::maybe_cast
+   */
+  template <typename ...Ts, typename InputIt>
+  GCH_NODISCARD
+  type_partition<detail::partition_base_t<InputIt>, Ts...>
+  partition_by_type (InputIt first, InputIt last)
+  {
+    static_assert (is_optional_ref<typename std::iterator_traits<InputIt>::value_type>::value,
+                   "partition_by_type expects a sequence of optional_ref.");
+
+    type_partition<detail::partition_base_t<InputIt>, Ts...> result;
+    result.partition (first, last);
+    return result;
+  }
+
+  /**
+   * Sorts a range of `optional_ref`s into buckets by the dynamic type of
+   * their referents.
+   *
+   * @tparam Ts the types to partition by.
+   * @tparam Range a range of `optional_ref<Base>`.
+   * @param range the input.
+   * @return a `type_partition` holding the buckets.
+   *
+   * @see gch::partition_by_type
+   */
+  template <typename ...Ts, typename Range>
+  GCH_NODISCARD
+  auto
+  partition_by_type (const Range& range)
+    -> decltype (partition_by_type<Ts...> (std::begin (range), std::end (range)))
+  {
+    return partition_by_type<Ts...> (std::begin (range), std::end (range));
+  }
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_OPTIONAL_REF_PARTITION_BY_TYPE_HPP
@@ -0,0 +1,467 @@
+/** ref_pool.hpp
+ * Defines `ref_pool`, a fixed-size lock-free pool of objects, and
+ * `ref_pool_cache`, a per-thread cache of its free slots.
+ *
+ * The slots are allocated once, when the pool is constructed. The free slots
+ * form a lock-free stack whose links are stored in the slots themselves. The
+ * head of the stack is tagged with a counter, so a slot which is acquired and
+ * released between the read and the update of the head (the ABA problem)
+ * does not corrupt it.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_OPTIONAL_REF_REF_POOL_HPP
+#define GCH_OPTIONAL_REF_REF_POOL_HPP
+
+#include "core.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  template <typename T>
+  class ref_pool;
+
+  template <typename T, std::size_t CacheSize>
+  class ref_pool_cache;
+
+} // namespace gch
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    // The index of no slot.
+    GCH_INLINE_VARIABLE constexpr
+    std::uint32_t
+    ref_pool_npos = UINT32_MAX;
+
+    // The size used to keep the head of the free list apart from the
+    // members which are only read.
+    GCH_INLINE_VARIABLE constexpr
+    std::size_t
+    ref_pool_cache_line = 64;
+
+    [[noreturn]] GCH_COLD GCH_NOINLINE inline
+    void
+    ref_pool_capacity_failure (void)
+    {
+#ifdef GCH_EXCEPTIONS
+      throw std::length_error ("gch::ref_pool capacity must be less than UINT32_MAX.");
+#else
+      std::fprintf (stderr, "[gch::ref_pool] The capacity must be less than UINT32_MAX.\n");
+      std::abort ();
+#endif
+    }
+
+    template <typename T>
+    struct ref_pool_slot
+    {
+      // The next free slot while this one is free. It is atomic because a
+      // thread popping the slot may read it after another thread has
+      // acquired the slot; the tag on the head makes that thread retry.
+      std::atomic<std::uint32_t> next;
+      alignas (T) unsigned char  data[sizeof (T)];
+
+      GCH_NODISCARD
+      T *
+      get_pointer (void) noexcept
+      {
+        return reinterpret_cast<T *> (data);
+      }
+    };
+
+    // Returns a slot to its pool unless dismissed. This releases the slot if
+    // the constructor of the object throws.
+    template <typename T>
+    class ref_pool_slot_guard
+    {
+    public:
+      ref_pool_slot_guard (ref_pool<T>& pool, std::uint32_t index) noexcept
+        : m_pool (pool),
+          m_index (index)
+      { }
+
+      ref_pool_slot_guard (const ref_pool_slot_guard&) = delete;
+      ref_pool_slot_guard& operator= (const ref_pool_slot_guard&) = delete;
+
+      ~ref_pool_slot_guard (void)
+      {
+        if (m_index != ref_pool_npos)
+          m_pool.push_chain (m_index, m_index);
+      }
+
+      void
+      dismiss (void) noexcept
+      {
+        m_index = ref_pool_npos;
+      }
+
+    private:
+      ref_pool<T>&  m_pool;
+      std::uint32_t m_index;
+    };
+
+  }
+
+} // namespace gch
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * A fixed-size pool of objects which may be used by multiple threads.
+   *
+   * Acquiring and releasing an object each take one compare-and-swap on
+   * the head of the free list, and never allocate. Use a `ref_pool_cache`
+   * in each thread to reduce contention on the head.
+   *
+   * The pool does not track which objects are in use, so every acquired
+   * object must be released before the pool is destroyed.
+   *
+   * @tparam T the type of the objects.
+   */
+  template <typename T>
+  class ref_pool
+  {
+    static_assert (! std::is_const<T>::value && ! std::is_reference<T>::value,
+                   "ref_pool expects a non-const object type.");
+
+    using slot_type = detail::ref_pool_slot<T>;
+
+  public:
+    using value_type = T;           /*!< The type of the objects   */
+    using size_type  = std::size_t; /*!< An unsigned integral type */
+
+    /**
+     * Constructor
+     *
+     * Allocates every slot of the pool.
+     *
+     * @param capacity the number of objects the pool holds. It must be
+     *                 less than `UINT32_MAX`.
+     * @throws std::length_error if `capacity` is not less than `UINT32_MAX`.
+     */
+    explicit
+    ref_pool (size_type capacity)
+      : m_slots (new slot_type[checked_capacity (capacity)]),
+        m_capacity (capacity)
+    {
+      for (size_type i = 0; i < capacity; ++i)
+      {
+        m_slots[i].next.store (i + 1 < capacity ? static_cast<std::uint32_t> (i + 1)
+                                                : detail::ref_pool_npos,
+                               std::memory_order_relaxed);
+      }
+      m_head.store (capacity == 0 ? detail::ref_pool_npos : 0, std::memory_order_relaxed);
+    }
+
+    ref_pool (const ref_pool&)            = delete;
+    ref_pool (ref_pool&&)                 = delete;
+    ref_pool& operator= (const ref_pool&) = delete;
+    ref_pool& operator= (ref_pool&&)      = delete;
+
+    /**
+     * Destructor
+     *
+     * Every acquired object must have been released.
+     */
+    ~ref_pool (void) = default;
+
+    /**
+     * Creates an object in a free slot.
+     *
+     * @tparam Args the types of the constructor arguments.
+     * @param args the constructor arguments.
+     * @return a reference to the new object, or an empty `optional_ref`
+     *         if every slot is in use.
+     */
+    template <typename ...Args>
+    optional_ref<T>
+    try_acquire (Args&&... args)
+      noexcept (std::is_nothrow_constructible<T, Args...>::value)
+    {
+      return construct (pop (), std::forward<Args> (args)...);
+    }
+
+    /**
+     * Destroys an object and frees its slot.
+     *
+     * @param obj an object acquired from this pool.
+     */
+    void
+    release (T& obj) noexcept
+    {
+      std::uint32_t index = destroy (obj);
+      push_chain (index, index);
+    }
+
+    /**
+     * Checks whether an object lives in this pool.
+     *
+     * @param obj an object.
+     * @return whether `obj` is in a slot of this pool.
+     */
+    GCH_NODISCARD
+    bool
+    owns (const T& obj) const noexcept
+    {
+      const unsigned char *p     = reinterpret_cast<const unsigned char *> (std::addressof (obj));
+      const unsigned char *begin = reinterpret_cast<const unsigned char *> (m_slots.get ());
+      const unsigned char *end   = reinterpret_cast<const unsigned char *> (m_slots.get ()
+                                                                            + m_capacity);
+      return begin <= p && p < end;
+    }
+
+    /**
+     * Returns the number of objects the pool holds.
+     *
+     * @return the number of slots.
+     */
+    GCH_NODISCARD
+    size_type
+    capacity (void) const noexcept
+    {
+      return m_capacity;
+    }
+
+  private:
+    friend class detail::ref_pool_slot_guard<T>;
+
+    template <typename, std::size_t>
+    friend class ref_pool_cache;
+
+    static
+    size_type
+    checked_capacity (size_type capacity)
+    {
+      if (capacity >= detail::ref_pool_npos)
+        detail::ref_pool_capacity_failure ();
+      return capacity;
+    }
+
+    // The low half of the head is the index of the first free slot, and the
+    // high half is a tag which changes with every update.
+    static constexpr
+    std::uint64_t
+    make_head (std::uint64_t old_head, std::uint32_t index) noexcept
+    {
+      return ((old_head >> 32) + 1) << 32 | index;
+    }
+
+    std::uint32_t
+    pop (void) noexcept
+    {
+      std::uint64_t head = m_head.load (std::memory_order_acquire);
+      for (;;)
+      {
+        std::uint32_t index = static_cast<std::uint32_t> (head);
+        if (index == detail::ref_pool_npos)
+          return index;
+
+        std::uint32_t next = m_slots[index].next.load (std::memory_order_relaxed);
+        if (m_head.compare_exchange_weak (head, make_head (head, next),
+                                          std::memory_order_acquire,
+                                          std::memory_order_acquire))
+        {
+          return index;
+        }
+      }
+    }
+
+    // Pushes slots which are already linked from `first` to `last`.
+    void
+    push_chain (std::uint32_t first, std::uint32_t last) noexcept
+    {
+      std::uint64_t head = m_head.load (std::memory_order_relaxed);
+      do
+      {
+        m_slots[last].next.store (static_cast<std::uint32_t> (head), std::memory_order_relaxed);
+      } while (! m_head.compare_exchange_weak (head, make_head (head, first),
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed));
+    }
+
+    template <typename ...Args>
+    optional_ref<T>
+    construct (std::uint32_t index, Args&&... args)
+      noexcept (std::is_nothrow_constructible<T, Args...>::value)
+    {
+      if (index == detail::ref_pool_npos)
+        return nullopt;
+
+      detail::ref_pool_slot_guard<T> guard (*this, index);
+      T *ptr = m_slots[index].get_pointer ();
+      ::new (static_cast<void *> (ptr)) T (std::forward<Args> (args)...);
+      guard.dismiss ();
+      return optional_ref<T> (ptr);
+    }
+
+    std::uint32_t
+    destroy (T& obj) noexcept
+    {
+      std::ptrdiff_t offset = reinterpret_cast<unsigned char *> (std::addressof (obj))
+                            - reinterpret_cast<unsigned char *> (m_slots.get ());
+      obj.~T ();
+      return static_cast<std::uint32_t> (static_cast<std::size_t> (offset) / sizeof (slot_type));
+    }
+
+    std::unique_ptr<slot_type[]> m_slots;
+    size_type                    m_capacity;
+
+    // Every acquisition and release writes the head, so it is kept off the
+    // cache line of the members above, which are read by every pop.
+    alignas (detail::ref_pool_cache_line) std::atomic<std::uint64_t> m_head;
+  };
+
+  /**
+   * A cache of free slots of a `ref_pool` for use by a single thread.
+   *
+   * The cache takes slots from the pool when it runs out and gives half of
+   * them back when it fills up, so most acquisitions and releases do not
+   * touch the shared free list. Objects may be released to a different cache
+   * (or to the pool itself) than the one they were acquired from.
+   *
+   * The cache returns its slots to the pool when it is destroyed.
+   *
+   * @tparam T the type of the objects.
+   * @tparam CacheSize the number of free slots the cache holds.
+   */
+  template <typename T, std::size_t CacheSize = 32>
+  class ref_pool_cache
+  {
+    static_assert (CacheSize >= 2, "The cache must hold at least two slots.");
+
+  public:
+    using value_type = T;           /*!< The type of the objects   */
+    using size_type  = std::size_t; /*!< An unsigned integral type */
+
+    /**
+     * Constructor
+     *
+     * @param pool the pool to cache.
+     */
+    explicit
+    ref_pool_cache (ref_pool<T>& pool) noexcept
+      : m_pool (pool)
+    { }
+
+    ref_pool_cache (const ref_pool_cache&)            = delete;
+    ref_pool_cache& operator= (const ref_pool_cache&) = delete;
+
+    /**
+     * Destructor
+     *
+     * Returns every cached slot to the pool.
+     */
+    ~ref_pool_cache (void)
+    {
+      flush (m_size);
+    }
+
+    /**
+     * Creates an object in a free slot.
+     *
+     * @tparam Args the types of the constructor arguments.
+     * @param args the constructor arguments.
+     * @return a reference to the new object, or an empty `optional_ref`
+     *         if every slot is in use.
+     */
+    template <typename ...Args>
+    optional_ref<T>
+    try_acquire (Args&&... args)
+      noexcept (std::is_nothrow_constructible<T, Args...>::value)
+    {
+      if (m_size == 0)
+        refill ();
+      if (m_size == 0)
+        return nullopt;
+      return m_pool.construct (m_indices[--m_size], std::forward<Args> (args)...);
+    }
+
+    /**
+     * Destroys an object and keeps its slot in the cache.
+     *
+     * @param obj an object acquired from the pool.
+     */
+    void
+    release (T& obj) noexcept
+    {
+      std::uint32_t index = m_pool.destroy (obj);
+      if (m_size == CacheSize)
+        flush (CacheSize / 2);
+      m_indices[m_size++] = index;
+    }
+
+    /**
+     * Returns the number of free slots in the cache.
+     *
+     * @return the number of cached slots.
+     */
+    GCH_NODISCARD
+    size_type
+    size (void) const noexcept
+    {
+      return m_size;
+    }
+
+  private:
+    void
+    refill (void) noexcept
+    {
+      while (m_size < CacheSize / 2)
+      {
+        std::uint32_t index = m_pool.pop ();
+        if (index == detail::ref_pool_npos)
+          return;
+        m_indices[m_size++] = index;
+      }
+    }
+
+    // Links the last `n` cached slots and pushes them with one update of the head.
+    void
+    flush (size_type n) noexcept
+    {
+      if (n == 0)
+        return;
+
+      size_type first = m_size - n;
+      for (size_type i = first; i + 1 < m_size; ++i)
+        m_pool.m_slots[m_indices[i]].next.store (m_indices[i + 1], std::memory_order_relaxed);
+      m_pool.push_chain (m_indices[first], m_indices[m_size - 1]);
+      m_size = first;
+    }
+
+    ref_pool<T>&  m_pool;
+    std::uint32_t m_indices[CacheSize];
+    size_type     m_size = 0;
+  };
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_OPTIONAL_REF_REF_POOL_HPP
@@ -0,0 +1,558 @@
+/** ref_queue.hpp
+ * Defines `ref_spsc_queue` and `ref_mpmc_queue`, bounded lock-free queues
+ * of references which pass `optional_ref` between threads.
+ *
+ * Each slot is a single atomic pointer, and a null pointer marks an empty
+ * slot. There is no separate flag or sequence number for each slot, so a
+ * queue of capacity `n` occupies `n` pointers.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_OPTIONAL_REF_REF_QUEUE_HPP
+#define GCH_OPTIONAL_REF_REF_QUEUE_HPP
+
+#include "core.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <thread>
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    // The size used to keep the indices of producers and consumers apart.
+    GCH_INLINE_VARIABLE constexpr
+    std::size_t
+    ref_queue_cache_line = 64;
+
+    inline
+    std::size_t
+    ref_queue_capacity (std::size_t requested) noexcept
+    {
+      std::size_t capacity = 1;
+      while (capacity < requested)
+        capacity *= 2;
+      return capacity;
+    }
+
+    // The slots own their array through a plain pointer so that the queues
+    // are standard-layout, and the offsets of their members may be checked.
+    template <typename T>
+    class ref_queue_slots
+    {
+    public:
+      explicit
+      ref_queue_slots (std::size_t requested)
+        : m_mask (ref_queue_capacity (requested) - 1),
+          m_slots (new std::atomic<T *>[m_mask + 1])
+      {
+        for (std::size_t i = 0; i <= m_mask; ++i)
+          m_slots[i].store (nullptr, std::memory_order_relaxed);
+      }
+
+      ref_queue_slots            (const ref_queue_slots&) = delete;
+      ref_queue_slots& operator= (const ref_queue_slots&) = delete;
+
+      ~ref_queue_slots (void)
+      {
+        delete[] m_slots;
+      }
+
+      GCH_NODISCARD
+      std::size_t
+      capacity (void) const noexcept
+      {
+        return m_mask + 1;
+      }
+
+      GCH_NODISCARD
+      std::atomic<T *>&
+      operator[] (std::size_t index) const noexcept
+      {
+        return m_slots[index & m_mask];
+      }
+
+    private:
+      std::size_t       m_mask;
+      std::atomic<T *> *m_slots;
+    };
+
+    // An index on its own cache line.
+    template <typename Index>
+    struct alignas (ref_queue_cache_line) ref_queue_index
+    {
+      Index value { 0 };
+    };
+
+    // Checks that each index of a queue and its slots are on separate cache
+    // lines. Called from the constructors, where the queues are complete.
+    template <std::size_t First, std::size_t Second, std::size_t Slots>
+    struct ref_queue_layout
+    {
+      static_assert (First % ref_queue_cache_line == 0 && Second % ref_queue_cache_line == 0,
+                     "The indices must start on a cache line.");
+      static_assert (Second - First >= ref_queue_cache_line,
+                     "The indices must be on separate cache lines.");
+      static_assert (Slots - Second >= ref_queue_cache_line,
+                     "The slots must not share a cache line with an index.");
+
+      static constexpr bool value = true;
+    };
+
+    // Waits for another thread to finish with a slot it has claimed. This
+    // only happens if that thread was suspended between claiming the slot
+    // and filling or emptying it.
+    inline
+    void
+    ref_queue_backoff (unsigned& spins) noexcept
+    {
+      if (++spins % 64 == 0)
+        std::this_thread::yield ();
+    }
+
+  }
+
+} // namespace gch
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * A bounded lock-free queue for one producer thread and one consumer thread.
+   *
+   * The producer and the consumer each keep their own index, and only
+   * communicate through the slots, so the two threads share no index.
+   *
+   * The capacity is rounded up to a power of two.
+   *
+   * @tparam T the value type of the references.
+   */
+  template <typename T>
+  class ref_spsc_queue
+  {
+  public:
+    using value_type = T;   /*!< The value type of the stored references */
+    using reference  = T&;  /*!< The reference type to be wrapped        */
+    using pointer    = T *; /*!< The pointer type to the value type      */
+
+    /**
+     * Constructor
+     *
+     * @param capacity the minimum number of references the queue holds.
+     */
+    explicit
+    ref_spsc_queue (std::size_t capacity)
+      : m_slots (capacity)
+    {
+      static_assert (detail::ref_queue_layout<offsetof (ref_spsc_queue, m_head),
+                                              offsetof (ref_spsc_queue, m_tail),
+                                              offsetof (ref_spsc_queue, m_slots)>::value,
+                     "The members of ref_spsc_queue must be on separate cache lines.");
+    }
+
+    ref_spsc_queue            (const ref_spsc_queue&) = delete;
+    ref_spsc_queue& operator= (const ref_spsc_queue&) = delete;
+
+    /**
+     * Returns the number of references the queue holds.
+     *
+     * @return the capacity.
+     */
+    GCH_NODISCARD
+    std::size_t
+    capacity (void) const noexcept
+    {
+      return m_slots.capacity ();
+    }
+
+    /**
+     * Pushes a reference. Only the producer thread may call this.
+     *
+     * @param ref a reference.
+     * @return whether there was room for `ref`.
+     */
+    bool
+    try_push (reference ref) noexcept
+    {
+      std::atomic<pointer>& slot = m_slots[m_head.value];
+      if (slot.load (std::memory_order_acquire) != nullptr)
+        return false;
+      slot.store (std::addressof (ref), std::memory_order_release);
+      ++m_head.value;
+      return true;
+    }
+
+    /**
+     * Pushes the referent of an `optional_ref`. Only the producer thread may
+     * call this.
+     *
+     * @param opt an `optional_ref`.
+     * @return whether `opt` had a value and there was room for it.
+     */
+    bool
+    try_push (optional_ref<T> opt) noexcept
+    {
+      return opt.has_value () && try_push (*opt);
+    }
+
+    /**
+     * Pushes up to `n` references. Only the producer thread may call this.
+     *
+     * The consumer empties slots in order, so when the last slot of the
+     * batch is empty, all of them are and only that one is checked.
+     *
+     * Pushing stops at the first empty `optional_ref`, which is not pushed.
+     *
+     * @tparam InputIt an input iterator to `optional_ref<T>`.
+     * @param first the first reference.
+     * @param n the number of references.
+     * @return the number of references pushed.
+     */
+    template <typename InputIt>
+    std::size_t
+    push_n (InputIt first, std::size_t n) noexcept
+    {
+      if (n > capacity ())
+        n = capacity ();
+      if (n == 0)
+        return 0;
+
+      std::size_t head = m_head.value;
+      if (m_slots[head + n - 1].load (std::memory_order_acquire) == nullptr)
+      {
+        std::size_t pushed = 0;
+        for (; pushed < n; ++pushed, ++first)
+        {
+          // A null pointer would mark the slot as empty, so stop instead.
+          pointer ptr = optional_ref<T> (*first).get_pointer ();
+          if (ptr == nullptr)
+            break;
+          m_slots[head + pushed].store (ptr, std::memory_order_release);
+        }
+        m_head.value = head + pushed;
+        return pushed;
+      }
+
+      std::size_t pushed = 0;
+      for (; pushed < n && try_push (optional_ref<T> (*first)); ++pushed, ++first)
+      { }
+      return pushed;
+    }
+
+    /**
+     * Pops a reference. Only the consumer thread may call this.
+     *
+     * @return the reference, or an empty `optional_ref` if the queue is empty.
+     */
+    optional_ref<T>
+    try_pop (void) noexcept
+    {
+      std::atomic<pointer>& slot = m_slots[m_tail.value];
+      pointer ptr = slot.load (std::memory_order_acquire);
+      if (ptr == nullptr)
+        return nullopt;
+      slot.store (nullptr, std::memory_order_release);
+      ++m_tail.value;
+      return optional_ref<T> (ptr);
+    }
+
+    /**
+     * Pops up to `n` references. Only the consumer thread may call this.
+     *
+     * @tparam OutputIt an output iterator to which `optional_ref<T>`
+     *                  may be assigned.
+     * @param out the destination.
+     * @param n the maximum number of references.
+     * @return the number of references popped.
+     */
+    template <typename OutputIt>
+    std::size_t
+    pop_n (OutputIt out, std::size_t n) noexcept
+    {
+      std::size_t popped = 0;
+      for (; popped < n; ++popped, ++out)
+      {
+        std::atomic<pointer>& slot = m_slots[m_tail.value + popped];
+        pointer ptr = slot.load (std::memory_order_acquire);
+        if (ptr == nullptr)
+          break;
+        slot.store (nullptr, std::memory_order_release);
+        *out = optional_ref<T> (ptr);
+      }
+      m_tail.value += popped;
+      return popped;
+    }
+
+  private:
+    detail::ref_queue_index<std::size_t> m_head;
+    detail::ref_queue_index<std::size_t> m_tail;
+    detail::ref_queue_slots<T>           m_slots;
+  };
+
+  /**
+   * A bounded lock-free queue for any number of producer and consumer threads.
+   *
+   * Producers and consumers claim positions by advancing a shared index, and
+   * then fill or empty the slot at that position. A claimed slot is only
+   * waited on if the thread which claimed it was suspended before it
+   * finished with the slot.
+   *
+   * Because slots carry no sequence numbers, the order of two references is
+   * only guaranteed between pushes which do not overlap in time with a push
+   * to the same slot one lap later. In practice this means a producer which
+   * is suspended for an entire lap of the queue may have its reference
+   * overtaken. Each reference is still popped exactly once.
+   *
+   * The capacity is rounded up to a power of two.
+   *
+   * @tparam T the value type of the references.
+   */
+  template <typename T>
+  class ref_mpmc_queue
+  {
+  public:
+    using value_type = T;   /*!< The value type of the stored references */
+    using reference  = T&;  /*!< The reference type to be wrapped        */
+    using pointer    = T *; /*!< The pointer type to the value type      */
+
+    /**
+     * Constructor
+     *
+     * @param capacity the minimum number of references the queue holds.
+     */
+    explicit
+    ref_mpmc_queue (std::size_t capacity)
+      : m_slots (capacity)
+    {
+      static_assert (detail::ref_queue_layout<offsetof (ref_mpmc_queue, m_tail),
+                                              offsetof (ref_mpmc_queue, m_head),
+                                              offsetof (ref_mpmc_queue, m_slots)>::value,
+                     "The members of ref_mpmc_queue must be on separate cache lines.");
+    }
+
+    ref_mpmc_queue            (const ref_mpmc_queue&) = delete;
+    ref_mpmc_queue& operator= (const ref_mpmc_queue&) = delete;
+
+    /**
+     * Returns the number of references the queue holds.
+     *
+     * @return the capacity.
+     */
+    GCH_NODISCARD
+    std::size_t
+    capacity (void) const noexcept
+    {
+      return m_slots.capacity ();
+    }
+
+    /**
+     * Pushes a reference.
+     *
+     * @param ref a reference.
+     * @return whether there was room for `ref`.
+     */
+    bool
+    try_push (reference ref) noexcept
+    {
+      std::size_t position;
+      if (claim_push (1, position) == 0)
+        return false;
+      fill (position, std::addressof (ref));
+      return true;
+    }
+
+    /**
+     * Pushes the referent of an `optional_ref`.
+     *
+     * @param opt an `optional_ref`.
+     * @return whether `opt` had a value and there was room for it.
+     */
+    bool
+    try_push (optional_ref<T> opt) noexcept
+    {
+      return opt.has_value () && try_push (*opt);
+    }
+
+    /**
+     * Pushes up to `n` references with a single update of the shared index.
+     *
+     * Pushing stops at the first empty `optional_ref`, which is not pushed.
+     * The references are counted before any slot is claimed, so the input
+     * must be a forward range.
+     *
+     * @tparam ForwardIt a forward iterator to `optional_ref<T>`.
+     * @param first the first reference.
+     * @param n the number of references.
+     * @return the number of references pushed.
+     */
+    template <typename ForwardIt>
+    std::size_t
+    push_n (ForwardIt first, std::size_t n) noexcept
+    {
+      // A claimed slot must be filled with a non-null pointer, or its
+      // consumer would wait for it forever.
+      ForwardIt it = first;
+      std::size_t valid = 0;
+      for (; valid < n && optional_ref<T> (*it).has_value (); ++valid, ++it)
+      { }
+
+      std::size_t position;
+      std::size_t claimed = claim_push (valid, position);
+      for (std::size_t i = 0; i < claimed; ++i, ++first)
+        fill (position + i, optional_ref<T> (*first).get_pointer ());
+      return claimed;
+    }
+
+    /**
+     * Pops a reference.
+     *
+     * @return the reference, or an empty `optional_ref` if the queue is empty.
+     */
+    optional_ref<T>
+    try_pop (void) noexcept
+    {
+      std::size_t position;
+      if (claim_pop (1, position) == 0)
+        return nullopt;
+      return optional_ref<T> (take (position));
+    }
+
+    /**
+     * Pops up to `n` references with a single update of the shared index.
+     *
+     * @tparam OutputIt an output iterator to which `optional_ref<T>`
+     *                  may be assigned.
+     * @param out the destination.
+     * @param n the maximum number of references.
+     * @return the number of references popped.
+     */
+    template <typename OutputIt>
+    std::size_t
+    pop_n (OutputIt out, std::size_t n) noexcept
+    {
+      std::size_t position;
+      std::size_t claimed = claim_pop (n, position);
+      for (std::size_t i = 0; i < claimed; ++i, ++out)
+        *out = optional_ref<T> (take (position + i));
+      return claimed;
+    }
+
+  private:
+    std::size_t
+    claim_push (std::size_t n, std::size_t& position) noexcept
+    {
+      std::size_t tail = m_tail.value.load (std::memory_order_relaxed);
+      for (;;)
+      {
+        std::size_t head = m_head.value.load (std::memory_order_acquire);
+        std::size_t used = tail - head;
+        if (used > capacity ())
+        {
+          // `tail` is older than `head`.
+          tail = m_tail.value.load (std::memory_order_relaxed);
+          continue;
+        }
+
+        std::size_t count = capacity () - used < n ? capacity () - used : n;
+        if (count == 0)
+          return 0;
+
+        if (m_tail.value.compare_exchange_weak (tail, tail + count,
+                                                std::memory_order_relaxed))
+        {
+          position = tail;
+          return count;
+        }
+      }
+    }
+
+    std::size_t
+    claim_pop (std::size_t n, std::size_t& position) noexcept
+    {
+      std::size_t head = m_head.value.load (std::memory_order_relaxed);
+      for (;;)
+      {
+        std::size_t tail = m_tail.value.load (std::memory_order_acquire);
+        std::size_t available = tail - head;
+        if (available > capacity ())
+        {
+          // `head` is older than `tail`.
+          head = m_head.value.load (std::memory_order_relaxed);
+          continue;
+        }
+
+        std::size_t count = available < n ? available : n;
+        if (count == 0)
+          return 0;
+
+        if (m_head.value.compare_exchange_weak (head, head + count,
+                                                std::memory_order_relaxed))
+        {
+          position = head;
+          return count;
+        }
+      }
+    }
+
+    void
+    fill (std::size_t position, pointer ptr) noexcept
+    {
+      std::atomic<pointer>& slot = m_slots[position];
+      unsigned spins = 0;
+      for (;;)
+      {
+        pointer expected = nullptr;
+        if (slot.load (std::memory_order_relaxed) == nullptr
+            &&  slot.compare_exchange_weak (expected, ptr,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed))
+        {
+          return;
+        }
+        detail::ref_queue_backoff (spins);
+      }
+    }
+
+    pointer
+    take (std::size_t position) noexcept
+    {
+      std::atomic<pointer>& slot = m_slots[position];
+      unsigned spins = 0;
+      for (;;)
+      {
+        if (slot.load (std::memory_order_relaxed) != nullptr)
+        {
+          pointer ptr = slot.exchange (nullptr, std::memory_order_acquire);
+          if (ptr != nullptr)
+            return ptr;
+        }
+        detail::ref_queue_backoff (spins);
+      }
+    }
+
+    detail::ref_queue_index<std::atomic<std::size_t>> m_tail;
+    detail::ref_queue_index<std::atomic<std::size_t>> m_head;
+    detail::ref_queue_slots<T>                        m_slots;
+  };
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_OPTIONAL_REF_REF_QUEUE_HPP
@@ -0,0 +1,414 @@
+/** static_ref_table.hpp
+ * Defines `static_ref_table`, a lookup table which is built at compile time
+ * with a perfect hash function, and whose lookups return `optional_cref`.
+ *
+ * The keys are split into buckets by their hash, and each bucket is given a
+ * seed which places all of its keys into free slots (hash and displace). A
+ * lookup costs one hash of the key, two array loads, and one comparison,
+ * and a table declared `static constexpr` costs nothing at startup. Each seed
+ * tried only touches the keys of its bucket, so building a table of N
+ * entries costs about O(N) operations of the constant evaluator.
+ *
+ * Building the table requires C++14 `constexpr`, so it is not defined
+ * in C++11.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_OPTIONAL_REF_STATIC_REF_TABLE_HPP
+#define GCH_OPTIONAL_REF_STATIC_REF_TABLE_HPP
+
+#include "core.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <type_traits>
+#include <utility>
+
+#if defined (__cpp_constexpr) && __cpp_constexpr >= 201304L && __cplusplus >= 201402L
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * A customization point for the hash and equality of the keys of
+   * a `static_ref_table`.
+   *
+   * Specializations must have `static constexpr` member functions
+   * `std::uint64_t hash (const Key&)` and `bool equal (const Key&, const Key&)`.
+   * The hash need not be perfect or well mixed, since the table mixes it.
+   * Integral and enumeration types and `const char *` (as NUL-terminated
+   * strings) are supported.
+   *
+   * @tparam Key the type of the keys.
+   */
+  template <typename Key, typename Enable = void>
+  struct static_key_traits;
+
+  template <typename Key>
+  struct static_key_traits<
+    Key, typename std::enable_if<std::is_integral<Key>::value || std::is_enum<Key>::value>::type>
+  {
+    static constexpr
+    std::uint64_t
+    hash (const Key& key) noexcept
+    {
+      return static_cast<std::uint64_t> (key);
+    }
+
+    static constexpr
+    bool
+    equal (const Key& lhs, const Key& rhs) noexcept
+    {
+      return lhs == rhs;
+    }
+  };
+
+  template <>
+  struct static_key_traits<const char *>
+  {
+    // FNV-1a
+    static constexpr
+    std::uint64_t
+    hash (const char *key) noexcept
+    {
+      std::uint64_t h = 0xCBF29CE484222325ULL;
+      for (; *key != '\0'; ++key)
+        h = (h ^ static_cast<unsigned char> (*key)) * 0x100000001B3ULL;
+      return h;
+    }
+
+    static constexpr
+    bool
+    equal (const char *lhs, const char *rhs) noexcept
+    {
+      for (; *lhs != '\0' && *lhs == *rhs; ++lhs, ++rhs)
+      { }
+      return *lhs == *rhs;
+    }
+  };
+
+  /**
+   * An entry of a `static_ref_table`.
+   *
+   * @tparam Key the type of the key.
+   * @tparam Value the type of the value.
+   */
+  template <typename Key, typename Value>
+  struct static_ref_table_entry
+  {
+    Key   key;   /*!< The key   */
+    Value value; /*!< The value */
+  };
+
+} // namespace gch
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    constexpr
+    std::size_t
+    static_ref_table_ceil2 (std::size_t n) noexcept
+    {
+      std::size_t p = 1;
+      while (p < n)
+        p *= 2;
+      return p;
+    }
+
+    // The finalizer of SplitMix64.
+    constexpr
+    std::uint64_t
+    static_ref_table_mix (std::uint64_t h) noexcept
+    {
+      h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+      return h ^ (h >> 31);
+    }
+
+    // Not constexpr, so that a failure to build the table at compile time
+    // is a compile error.
+    [[noreturn]] GCH_COLD inline
+    void
+    static_ref_table_failure (void) noexcept
+    {
+      std::abort ();
+    }
+
+  }
+
+} // namespace gch
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * A read-only table built with a perfect hash function.
+   *
+   * Use `make_static_ref_table` to create one. Declare it `static constexpr`
+   * so that it is built at compile time and the references returned by
+   * `find` refer to static storage:
+   *
+   *     static constexpr auto opcodes = gch::make_static_ref_table<int, descriptor> ({
+   *       { 0x01, { "nop",  1 } },
+   *       { 0x3C, { "cmp",  2 } },
+   *     });
+   *
+   *     if (gch::optional_cref<descriptor> d = opcodes.find (op))
+   *       ...
+   *
+   * Duplicate keys are a compile error.
+   *
+   * @tparam Key the type of the keys. See `static_key_traits`.
+   * @tparam Value the type of the values.
+   * @tparam N the number of entries.
+   */
+  template <typename Key, typename Value, std::size_t N>
+  class static_ref_table
+  {
+    static_assert (N > 0, "A static_ref_table must have at least one entry.");
+    static_assert (N < UINT32_MAX, "A static_ref_table has too many entries.");
+
+    using traits = static_key_traits<Key>;
+
+    // At most 80% of the slots are used, so that the last buckets find free
+    // slots after a few seeds.
+    static constexpr std::size_t slot_count   = detail::static_ref_table_ceil2 (N + N / 4);
+    static constexpr std::size_t bucket_count = detail::static_ref_table_ceil2 ((N + 1) / 2);
+
+    // The number of seeds tried for a bucket before giving up.
+    static constexpr std::uint32_t seed_limit = 1U << 16;
+
+  public:
+    using key_type   = Key;                                  /*!< The type of the keys    */
+    using value_type = Value;                                /*!< The type of the values  */
+    using entry_type = static_ref_table_entry<Key, Value>;   /*!< The type of the entries */
+    using size_type  = std::size_t;                          /*!< An unsigned integral type */
+
+    /**
+     * Constructor
+     *
+     * Builds the table. Prefer `make_static_ref_table`.
+     *
+     * @tparam Is the indices of the entries.
+     * @param entries the entries.
+     */
+    template <std::size_t ...Is>
+    constexpr
+    static_ref_table (const entry_type (&entries)[N], std::index_sequence<Is...>)
+      : m_entries { entries[Is]... },
+        m_seeds { },
+        m_slots { }
+    {
+      build ();
+    }
+
+    /**
+     * Finds the value for a key.
+     *
+     * @param key a key.
+     * @return a reference to the value, or an empty `optional_cref`
+     *         if there is no entry for `key`.
+     */
+    GCH_NODISCARD constexpr
+    optional_cref<Value>
+    find (const Key& key) const noexcept
+    {
+      std::uint64_t h = base_hash (key);
+      std::uint32_t index = m_slots[slot (h, m_seeds[h & (bucket_count - 1)])];
+      if (index != 0 && traits::equal (m_entries[index - 1].key, key))
+        return optional_cref<Value> (m_entries[index - 1].value);
+      return nullopt;
+    }
+
+    /**
+     * Checks whether there is an entry for a key.
+     *
+     * @param key a key.
+     * @return whether there is an entry for `key`.
+     */
+    GCH_NODISCARD constexpr
+    bool
+    contains (const Key& key) const noexcept
+    {
+      return find (key).has_value ();
+    }
+
+    /**
+     * Returns the number of entries.
+     *
+     * @return the number of entries.
+     */
+    GCH_NODISCARD constexpr
+    size_type
+    size (void) const noexcept
+    {
+      return N;
+    }
+
+    /**
+     * Returns a pointer to the first entry, in the order they were given.
+     *
+     * @return a pointer to the first entry.
+     */
+    GCH_NODISCARD constexpr
+    const entry_type *
+    begin (void) const noexcept
+    {
+      return m_entries;
+    }
+
+    /**
+     * Returns a pointer past the last entry.
+     *
+     * @return a pointer past the last entry.
+     */
+    GCH_NODISCARD constexpr
+    const entry_type *
+    end (void) const noexcept
+    {
+      return m_entries + N;
+    }
+
+  private:
+    static constexpr
+    std::uint64_t
+    base_hash (const Key& key) noexcept
+    {
+      return detail::static_ref_table_mix (traits::hash (key));
+    }
+
+    static constexpr
+    std::size_t
+    slot (std::uint64_t h, std::uint32_t seed) noexcept
+    {
+      return static_cast<std::size_t> (
+        detail::static_ref_table_mix (h ^ (seed * 0x9E3779B97F4A7C15ULL)) & (slot_count - 1));
+    }
+
+    constexpr
+    void
+    build (void)
+    {
+      // Sort the entries by bucket, so that each bucket's keys are contiguous.
+      std::uint64_t hashes[N] = { };
+      std::size_t bucket_starts[bucket_count + 1] = { };
+      for (std::size_t i = 0; i < N; ++i)
+      {
+        hashes[i] = base_hash (m_entries[i].key);
+        ++bucket_starts[(hashes[i] & (bucket_count - 1)) + 1];
+      }
+
+      std::size_t max_bucket_size = 0;
+      for (std::size_t b = 0; b < bucket_count; ++b)
+      {
+        if (bucket_starts[b + 1] > max_bucket_size)
+          max_bucket_size = bucket_starts[b + 1];
+        bucket_starts[b + 1] += bucket_starts[b];
+      }
+
+      std::size_t fill[bucket_count] = { };
+      std::uint32_t order[N] = { };
+      for (std::size_t i = 0; i < N; ++i)
+      {
+        std::size_t b = hashes[i] & (bucket_count - 1);
+        order[bucket_starts[b] + fill[b]++] = static_cast<std::uint32_t> (i);
+      }
+
+      // Equal keys have equal hashes, so duplicates are in the same bucket.
+      for (std::size_t b = 0; b < bucket_count; ++b)
+      {
+        for (std::size_t i = bucket_starts[b]; i < bucket_starts[b + 1]; ++i)
+        {
+          for (std::size_t j = bucket_starts[b]; j < i; ++j)
+          {
+            if (traits::equal (m_entries[order[i]].key, m_entries[order[j]].key))
+              detail::static_ref_table_failure ();
+          }
+        }
+      }
+
+      // Place the largest buckets first, while there are the most free slots.
+      for (std::size_t size = max_bucket_size; size > 0; --size)
+      {
+        for (std::size_t b = 0; b < bucket_count; ++b)
+        {
+          if (bucket_starts[b + 1] - bucket_starts[b] != size)
+            continue;
+
+          std::uint32_t seed = 0;
+          while (! try_place (hashes, order + bucket_starts[b], order + bucket_starts[b + 1], seed))
+          {
+            if (++seed == seed_limit)
+              detail::static_ref_table_failure ();
+          }
+          m_seeds[b] = seed;
+        }
+      }
+    }
+
+    // Places every key of a bucket with the seed, or nothing if any of them collide.
+    constexpr
+    bool
+    try_place (const std::uint64_t (&hashes)[N], const std::uint32_t *first,
+               const std::uint32_t *last, std::uint32_t seed)
+    {
+      for (const std::uint32_t *it = first; it != last; ++it)
+      {
+        std::size_t s = slot (hashes[*it], seed);
+        if (m_slots[s] != 0)
+        {
+          for (; first != it; ++first)
+            m_slots[slot (hashes[*first], seed)] = 0;
+          return false;
+        }
+        m_slots[s] = *it + 1;
+      }
+      return true;
+    }
+
+    entry_type    m_entries[N];
+    std::uint32_t m_seeds[bucket_count];
+
+    // The index of the entry in each slot, plus one, or zero if the slot is empty.
+    std::uint32_t m_slots[slot_count];
+  };
+
+  /**
+   * Builds a `static_ref_table`.
+   *
+   * @tparam Key the type of the keys.
+   * @tparam Value the type of the values.
+   * @tparam N the number of entries.
+   * @param entries the entries.
+   * @return the table.
+   */
+  template <typename Key, typename Value, std::size_t N>
+  GCH_NODISCARD constexpr
+  static_ref_table<Key, Value, N>
+  make_static_ref_table (const static_ref_table_entry<Key, Value> (&entries)[N])
+  {
+    return static_ref_table<Key, Value, N> (entries, std::make_index_sequence<N> { });
+  }
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif
+
+#endif // GCH_OPTIONAL_REF_STATIC_REF_TABLE_HPP
@@ -0,0 +1,402 @@
+/** swizzle.hpp
+ * Defines `swizzled_ref`, a position-independent encoding of an
+ * `optional_ref` into an array of objects.
+ *
+ * This is intended for writing object graphs to a binary image. Each
+ * `optional_ref` field is swizzled into an index relative to the start of
+ * the array which holds its referents, and unswizzled back into a pointer
+ * when the image is loaded, with empty references preserved. Decoding
+ * checks each index against the size of the array, so a truncated or
+ * corrupt image is detected rather than producing wild references.
+ *
+ * Types registered with `swizzle_traits` can be written to an image and
+ * restored from it with `swizzle_objects` and `unswizzle_objects`.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_OPTIONAL_REF_SWIZZLE_HPP
+#define GCH_OPTIONAL_REF_SWIZZLE_HPP
+
+#include "core.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * An `optional_ref` encoded as an index into an array of objects.
+   *
+   * The encoding is a 64-bit integer which is zero for an empty reference
+   * and one more than the index otherwise, so a zero-initialized image
+   * holds empty references. It is trivially copyable and does not depend on
+   * the size of pointers, but it is stored in the native byte order.
+   *
+   * @tparam T the value type of the encoded `optional_ref`.
+   */
+  template <typename T>
+  class swizzled_ref
+  {
+  public:
+    using value_type = T;             /*!< The value type of the encoded reference */
+    using index_type = std::uint64_t; /*!< The type of the encoded index           */
+
+    /**
+     * Constructor
+     *
+     * Constructs an empty `swizzled_ref`.
+     */
+    swizzled_ref (void) noexcept = default;
+
+    /**
+     * Constructor
+     *
+     * Constructs an empty `swizzled_ref`.
+     */
+    constexpr /* implicit */
+    swizzled_ref (nullopt_t) noexcept
+    { }
+
+    /**
+     * Encodes an `optional_ref`.
+     *
+     * The referent of `ref` must be an element of the array starting at `base`.
+     *
+     * @param ref an `optional_ref`.
+     * @param base a pointer to the first element of the array.
+     */
+    constexpr
+    swizzled_ref (optional_ref<T> ref, const T *base) noexcept
+      : m_encoded (ref.has_value ()
+                   ? static_cast<index_type> (ref.get_pointer () - base) + 1U
+                   : 0U)
+    { }
+
+    /**
+     * Checks if the encoded reference has a value.
+     *
+     * @return whether the encoded reference has a value.
+     */
+    GCH_NODISCARD constexpr
+    bool
+    has_value (void) const noexcept
+    {
+      return m_encoded != 0;
+    }
+
+    /**
+     * Returns the index of the referent.
+     *
+     * The behavior is undefined if the encoded reference has no value.
+     *
+     * @return the index of the referent.
+     */
+    GCH_NODISCARD constexpr
+    index_type
+    index (void) const noexcept
+    {
+      return m_encoded - 1U;
+    }
+
+    /**
+     * Returns the raw encoding.
+     *
+     * @return zero if empty, or one more than the index.
+     */
+    GCH_NODISCARD constexpr
+    index_type
+    encoded (void) const noexcept
+    {
+      return m_encoded;
+    }
+
+    /**
+     * Checks if the encoded reference may be decoded relative to an array.
+     *
+     * @param count the number of elements in the array.
+     * @return whether the encoded reference is empty or its index is less than `count`.
+     */
+    GCH_NODISCARD constexpr
+    bool
+    in_range (std::size_t count) const noexcept
+    {
+      return ! has_value () || index () < count;
+    }
+
+    /**
+     * Decodes the reference relative to an array.
+     *
+     * An index which is out of range decodes to an empty `optional_ref`. Use
+     * `in_range` to tell it apart from an empty reference.
+     *
+     * @param base a pointer to the first element of the array.
+     * @param count the number of elements in the array.
+     * @return an `optional_ref` to the referent, or an empty `optional_ref`.
+     */
+    GCH_NODISCARD constexpr
+    optional_ref<T>
+    unswizzle (T *base, std::size_t count) const noexcept
+    {
+      return (has_value () && index () < count) ? optional_ref<T> { base + index () }
+                                                 : optional_ref<T> { };
+    }
+
+  private:
+    index_type m_encoded = 0;
+  };
+
+  /**
+   * Encodes an `optional_ref` as an index relative to an array.
+   *
+   * @tparam T the value type of `ref`.
+   * @param ref an `optional_ref` to an element of the array starting at `base`, or empty.
+   * @param base a pointer to the first element of the array.
+   * @return the encoded reference.
+   */
+  template <typename T>
+  GCH_NODISCARD constexpr
+  swizzled_ref<T>
+  swizzle (optional_ref<T> ref, const T *base) noexcept
+  {
+    return swizzled_ref<T> { ref, base };
+  }
+
+  /**
+   * Decodes a `swizzled_ref` relative to an array.
+   *
+   * An index which is out of range decodes to an empty `optional_ref`.
+   *
+   * @tparam T the value type of `ref`.
+   * @param ref an encoded reference.
+   * @param base a pointer to the first element of the array.
+   * @param count the number of elements in the array.
+   * @return an `optional_ref` to the referent, or an empty `optional_ref`.
+   */
+  template <typename T>
+  GCH_NODISCARD constexpr
+  optional_ref<T>
+  unswizzle (swizzled_ref<T> ref, T *base, std::size_t count) noexcept
+  {
+    return ref.unswizzle (base, count);
+  }
+
+  /**
+   * Encodes a range of `optional_ref`s relative to an array.
+   *
+   * @tparam InputIt an input iterator to `optional_ref<T>`.
+   * @tparam OutputIt an output iterator to `swizzled_ref<T>`.
+   * @tparam T the value type of the references.
+   * @param first the beginning of the input range.
+   * @param last the end of the input range.
+   * @param base a pointer to the first element of the array.
+   * @param out the beginning of the output range.
+   * @return an iterator past the last output.
+   */
+  template <typename InputIt, typename OutputIt, typename T>
+  GCH_CPP14_CONSTEXPR
+  OutputIt
+  swizzle (InputIt first, InputIt last, const T *base, OutputIt out)
+  {
+    for (; first != last; ++first, static_cast<void> (++out))
+      *out = swizzled_ref<T> { *first, base };
+    return out;
+  }
+
+  /**
+   * Decodes a range of `swizzled_ref`s relative to an array in a single pass.
+   *
+   * Decoding stops at the first reference whose index is out of range.
+   *
+   * @tparam InputIt an input iterator to `swizzled_ref<T>`.
+   * @tparam OutputIt an output iterator to `optional_ref<T>`.
+   * @tparam T the value type of the references.
+   * @param first the beginning of the input range.
+   * @param last the end of the input range.
+   * @param base a pointer to the first element of the array.
+   * @param count the number of elements in the array.
+   * @param out the beginning of the output range.
+   * @return an iterator to the first reference which is out of range, or `last`.
+   */
+  template <typename InputIt, typename OutputIt, typename T>
+  GCH_CPP14_CONSTEXPR
+  InputIt
+  unswizzle (InputIt first, InputIt last, T *base, std::size_t count, OutputIt out)
+  {
+    for (; first != last; ++first, static_cast<void> (++out))
+    {
+      swizzled_ref<T> ref (*first);
+      if (! ref.in_range (count))
+        break;
+      *out = ref.unswizzle (base, count);
+    }
+    return first;
+  }
+
+  /**
+   * A customization point which registers a type for `swizzle_objects`
+   * and `unswizzle_objects`.
+   *
+   * Specializations must have a member type `image_type`, the trivially
+   * copyable type which an object is written as, and a static member
+   * function template `fields` which calls its argument with a pair of
+   * pointers to corresponding members of `T` and `image_type` for each
+   * field:
+   *
+   *     template <>
+   *     struct gch::swizzle_traits<node>
+   *     {
+   *       using image_type = node_image;
+   *
+   *       template <typename Fields>
+   *       static void
+   *       fields (Fields&& f)
+   *       {
+   *         f (&node::value, &node_image::value);
+   *         f (&node::next,  &node_image::next);
+   *       }
+   *     };
+   *
+   * A field of type `optional_ref<T>` is written as a `swizzled_ref<T>`
+   * relative to the array of objects being written, so it must refer to an
+   * element of that array or be empty. Other fields are assigned.
+   *
+   * @tparam T the type of the objects.
+   */
+  template <typename T>
+  struct swizzle_traits;
+
+} // namespace gch
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    template <typename T>
+    struct swizzle_writer
+    {
+      using image_type = typename swizzle_traits<T>::image_type;
+
+      void
+      operator() (optional_ref<T> T::*field, swizzled_ref<T> image_type::*image_field) const
+      {
+        image.*image_field = swizzled_ref<T> { object.*field, base };
+      }
+
+      template <typename M, typename N>
+      void
+      operator() (M T::*field, N image_type::*image_field) const
+      {
+        image.*image_field = object.*field;
+      }
+
+      const T&    object;
+      image_type& image;
+      const T    *base;
+    };
+
+    template <typename T>
+    struct swizzle_reader
+    {
+      using image_type = typename swizzle_traits<T>::image_type;
+
+      void
+      operator() (optional_ref<T> T::*field, swizzled_ref<T> image_type::*image_field)
+      {
+        const swizzled_ref<T>& ref = image.*image_field;
+        in_range = in_range && ref.in_range (count);
+        object.*field = ref.unswizzle (base, count);
+      }
+
+      template <typename M, typename N>
+      void
+      operator() (M T::*field, N image_type::*image_field)
+      {
+        object.*field = image.*image_field;
+      }
+
+      const image_type& image;
+      T&                object;
+      T                *base;
+      std::size_t       count;
+      bool              in_range;
+    };
+
+  }
+
+} // namespace gch
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * Writes an array of objects of a type registered with `swizzle_traits`
+   * to an image in a single pass.
+   *
+   * @tparam T the type of the objects.
+   * @param first a pointer to the first object.
+   * @param last a pointer past the last object.
+   * @param out a pointer to the first element of the image.
+   * @return a pointer past the last element written to the image.
+   */
+  template <typename T>
+  typename swizzle_traits<T>::image_type *
+  swizzle_objects (const T *first, const T *last, typename swizzle_traits<T>::image_type *out)
+  {
+    for (const T *it = first; it != last; ++it, static_cast<void> (++out))
+      swizzle_traits<T>::fields (detail::swizzle_writer<T> { *it, *out, first });
+    return out;
+  }
+
+  /**
+   * Restores an array of objects of a type registered with `swizzle_traits`
+   * from an image in a single pass, such as from a memory-mapped file.
+   *
+   * The objects must already exist, and the fields of each are assigned.
+   * Every reference is checked against the size of the image, and restoring
+   * stops at the first element of the image which holds a reference which is
+   * out of range. The fields of the object restored from it are unspecified.
+   *
+   * @tparam T the type of the objects.
+   * @param first a pointer to the first element of the image.
+   * @param last a pointer past the last element of the image.
+   * @param out a pointer to the first of `last - first` objects.
+   * @return a pointer to the first element of the image which holds a reference
+   *         which is out of range, or `last`.
+   */
+  template <typename T>
+  const typename swizzle_traits<T>::image_type *
+  unswizzle_objects (const typename swizzle_traits<T>::image_type *first,
+                     const typename swizzle_traits<T>::image_type *last,
+                     T *out)
+  {
+    std::size_t count = static_cast<std::size_t> (last - first);
+    for (T *it = out; first != last; ++first, static_cast<void> (++it))
+    {
+      detail::swizzle_reader<T> reader { *first, *it, out, count, true };
+      swizzle_traits<T>::fields (reader);
+      if (! reader.in_range)
+        break;
+    }
+    return first;
+  }
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_OPTIONAL_REF_SWIZZLE_HPP
@@ -0,0 +1,479 @@
+/** tracked_optional_ref.hpp
+ * Defines `tracked_optional_ref`, an `optional_ref` which is reset when its
+ * referent is destroyed, and `ref_trackable`, the base class of referents.
+ *
+ * Each `tracked_optional_ref` links itself into an intrusive list held by
+ * its referent, so there is no reference count and no allocation. The
+ * destructor of `ref_trackable` walks the list and empties every ref.
+ *
+ * Neither type is thread-safe. A referent and every ref to it must be used
+ * by one thread at a time.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_OPTIONAL_REF_TRACKED_OPTIONAL_REF_HPP
+#define GCH_OPTIONAL_REF_TRACKED_OPTIONAL_REF_HPP
+
+#include "core.hpp"
+
+#include <memory>
+#include <type_traits>
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  class ref_trackable;
+
+} // namespace gch
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    // A link in the list of refs to a `ref_trackable`. `m_pprev` points at
+    // the `m_next` of the previous link, or at the head of the list, so a
+    // link may unlink itself without knowing its referent.
+    class ref_tracker_link
+    {
+    public:
+      ref_tracker_link (void) noexcept = default;
+
+      ref_tracker_link (const ref_tracker_link&) = delete;
+      ref_tracker_link& operator= (const ref_tracker_link&) = delete;
+
+      ~ref_tracker_link (void) noexcept
+      {
+        unlink ();
+      }
+
+    protected:
+      void
+      link_front (ref_tracker_link *& head, const volatile void *ptr) noexcept
+      {
+        m_ptr   = ptr;
+        m_next  = head;
+        m_pprev = &head;
+        if (head != nullptr)
+          head->m_pprev = &m_next;
+        head = this;
+      }
+
+      void
+      link_after (const ref_tracker_link& other) noexcept
+      {
+        if (other.m_ptr == nullptr)
+          return;
+
+        m_ptr   = other.m_ptr;
+        m_next  = other.m_next;
+        m_pprev = &other.m_next;
+        if (m_next != nullptr)
+          m_next->m_pprev = &m_next;
+        other.m_next = this;
+      }
+
+      // Takes the place of `other` in its list, and leaves `other` empty.
+      void
+      replace (ref_tracker_link& other) noexcept
+      {
+        if (other.m_ptr == nullptr)
+          return;
+
+        m_ptr   = other.m_ptr;
+        m_next  = other.m_next;
+        m_pprev = other.m_pprev;
+        *m_pprev = this;
+        if (m_next != nullptr)
+          m_next->m_pprev = &m_next;
+
+        other.m_ptr   = nullptr;
+        other.m_next  = nullptr;
+        other.m_pprev = nullptr;
+      }
+
+      void
+      unlink (void) noexcept
+      {
+        if (m_ptr == nullptr)
+          return;
+
+        *m_pprev = m_next;
+        if (m_next != nullptr)
+          m_next->m_pprev = m_pprev;
+
+        m_ptr   = nullptr;
+        m_next  = nullptr;
+        m_pprev = nullptr;
+      }
+
+      const volatile void *m_ptr   = nullptr;
+
+    private:
+      friend class gch::ref_trackable;
+
+      // A copy links itself after its source, so these change even when
+      // the source is const.
+      mutable ref_tracker_link  *m_next  = nullptr;
+      mutable ref_tracker_link **m_pprev = nullptr;
+    };
+
+  }
+
+} // namespace gch
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  /**
+   * A base class for objects which may be referred to by `tracked_optional_ref`.
+   *
+   * Every `tracked_optional_ref` to the object is reset when the
+   * `ref_trackable` base is destroyed. The refs track the identity of the
+   * object, so copying or moving the object does not affect them.
+   */
+  class ref_trackable
+  {
+  protected:
+    ref_trackable (void) noexcept = default;
+
+    ref_trackable (const ref_trackable&) noexcept
+    { }
+
+    ref_trackable&
+    operator= (const ref_trackable&) noexcept
+    {
+      return *this;
+    }
+
+    ~ref_trackable (void) noexcept
+    {
+      reset_tracking_refs ();
+    }
+
+    /**
+     * Resets every `tracked_optional_ref` to `*this`.
+     *
+     * The refs are otherwise reset by the destructor of `ref_trackable`,
+     * which runs after the destructor of the derived class. A derived class
+     * may call this first if the refs must not observe it mid-destruction.
+     */
+    void
+    reset_tracking_refs (void) noexcept
+    {
+      detail::ref_tracker_link *link = m_trackers;
+      m_trackers = nullptr;
+      while (link != nullptr)
+      {
+        detail::ref_tracker_link *next = link->m_next;
+        link->m_ptr   = nullptr;
+        link->m_next  = nullptr;
+        link->m_pprev = nullptr;
+        link = next;
+      }
+    }
+
+  private:
+    template <typename T>
+    friend class tracked_optional_ref;
+
+    mutable detail::ref_tracker_link *m_trackers = nullptr;
+  };
+
+  /**
+   * An `optional_ref` which is reset when its referent is destroyed.
+   *
+   * Reading the ref is the same as reading an `optional_ref`. Constructing,
+   * copying, moving, and destroying it each take constant time.
+   *
+   * @tparam T the value type of the reference. It must derive from
+   *           `ref_trackable`.
+   */
+  template <typename T>
+  class tracked_optional_ref
+    : private detail::ref_tracker_link
+  {
+  public:
+    using value_type = T;   /*!< The value type of the stored reference */
+    using reference  = T&;  /*!< The reference type to be wrapped       */
+    using pointer    = T *; /*!< The pointer type to the value type     */
+
+    /**
+     * Default constructor
+     *
+     * Constructs an empty ref.
+     */
+    tracked_optional_ref (void) noexcept = default;
+
+    /**
+     * Constructor
+     *
+     * Constructs an empty ref.
+     */
+    GCH_IMPLICIT_CONVERSION
+    tracked_optional_ref (nullopt_t) noexcept
+    { }
+
+    /**
+     * Constructor
+     *
+     * Refers to `ref`, and links into its list of refs.
+     *
+     * @param ref a reference.
+     */
+    explicit
+    tracked_optional_ref (T& ref) noexcept
+    {
+      track (ref);
+    }
+
+    /**
+     * Constructor
+     *
+     * A deleted contructor for the case where `ref` is an rvalue reference.
+     */
+    tracked_optional_ref (const T&&) = delete;
+
+    /**
+     * Copy constructor
+     *
+     * Refers to the referent of `other`, if any.
+     *
+     * @param other a ref.
+     */
+    tracked_optional_ref (const tracked_optional_ref& other) noexcept
+      : detail::ref_tracker_link ()
+    {
+      link_after (other);
+    }
+
+    /**
+     * Move constructor
+     *
+     * Takes the place of `other`, which is left empty.
+     *
+     * @param other a ref.
+     */
+    tracked_optional_ref (tracked_optional_ref&& other) noexcept
+      : detail::ref_tracker_link ()
+    {
+      replace (other);
+    }
+
+    /**
+     * Copy assignment operator
+     *
+     * @param other a ref.
+     * @return `*this`.
+     */
+    tracked_optional_ref&
+    operator= (const tracked_optional_ref& other) noexcept
+    {
+      if (&other != this)
+      {
+        unlink ();
+        link_after (other);
+      }
+      return *this;
+    }
+
+    /**
+     * Move assignment operator
+     *
+     * @param other a ref, which is left empty.
+     * @return `*this`.
+     */
+    tracked_optional_ref&
+    operator= (tracked_optional_ref&& other) noexcept
+    {
+      if (&other != this)
+      {
+        unlink ();
+        replace (other);
+      }
+      return *this;
+    }
+
+    /**
+     * Assignment operator
+     *
+     * Empties the ref.
+     *
+     * @return `*this`.
+     */
+    tracked_optional_ref&
+    operator= (nullopt_t) noexcept
+    {
+      reset ();
+      return *this;
+    }
+
+    /**
+     * Destructor
+     *
+     * Unlinks from the list of refs of the referent.
+     */
+    ~tracked_optional_ref (void) noexcept = default;
+
+    /**
+     * Refers to `ref`.
+     *
+     * @param ref a reference.
+     * @return `ref`.
+     */
+    reference
+    emplace (T& ref) noexcept
+    {
+      unlink ();
+      track (ref);
+      return ref;
+    }
+
+    /**
+     * A deleted version for rvalue references.
+     */
+    reference
+    emplace (const T&&) = delete;
+
+    /**
+     * Empties the ref.
+     */
+    void
+    reset (void) noexcept
+    {
+      unlink ();
+    }
+
+    /**
+     * Checks whether the referent is still alive.
+     *
+     * @return whether `*this` contains a value.
+     */
+    GCH_NODISCARD
+    bool
+    has_value (void) const noexcept
+    {
+      return m_ptr != nullptr;
+    }
+
+    /**
+     * Checks whether the referent is still alive.
+     *
+     * @return whether `*this` contains a value.
+     */
+    GCH_NODISCARD explicit
+    operator bool (void) const noexcept
+    {
+      return has_value ();
+    }
+
+    /**
+     * Gets a pointer to the referent, or `nullptr` if it was destroyed.
+     *
+     * @return a pointer to the referent.
+     */
+    GCH_NODISCARD
+    pointer
+    get_pointer (void) const noexcept
+    {
+      return static_cast<pointer> (const_cast<void *> (m_ptr));
+    }
+
+    /**
+     * Gets the referent.
+     *
+     * @throws bad_optional_access when `*this` does not contain a value.
+     *
+     * @see gch::set_bad_optional_access_handler
+     *
+     * @return the referent.
+     */
+    GCH_NODISCARD
+    reference
+    value (void) const
+    {
+      if (! has_value ())
+        detail::bad_optional_access_failure ();
+      return *get_pointer ();
+    }
+
+    /**
+     * Gets the referent. This is undefined if there is none.
+     *
+     * @return the referent.
+     */
+    GCH_NODISCARD
+    reference
+    operator* (void) const noexcept
+    {
+      return *get_pointer ();
+    }
+
+    /**
+     * Gets a pointer to the referent. This is undefined if there is none.
+     *
+     * @return a pointer to the referent.
+     */
+    GCH_NODISCARD
+    pointer
+    operator-> (void) const noexcept
+    {
+      return get_pointer ();
+    }
+
+    /**
+     * Checks whether `*this` refers to `r`.
+     *
+     * @param r a reference.
+     * @return whether `*this` refers to `r`.
+     */
+    GCH_NODISCARD
+    bool
+    refers_to (const volatile T& r) const noexcept
+    {
+      return get_pointer () == std::addressof (r);
+    }
+
+    /**
+     * Converts to an untracked `optional_ref` to the current referent.
+     *
+     * @tparam U a value type where `T *` is implicitly convertible to `U *`.
+     * @return an `optional_ref`.
+     */
+    template <typename U,
+              typename std::enable_if<std::is_convertible<pointer, U *>::value>::type * = nullptr>
+    GCH_NODISCARD GCH_IMPLICIT_CONVERSION
+    operator optional_ref<U> (void) const noexcept
+    {
+      return optional_ref<U> (get_pointer ());
+    }
+
+  private:
+    void
+    track (T& ref) noexcept
+    {
+      static_assert (std::is_base_of<ref_trackable, T>::value,
+                     "The value type of tracked_optional_ref must derive from ref_trackable.");
+
+      const ref_trackable& trackable = ref;
+      link_front (trackable.m_trackers, std::addressof (ref));
+    }
+  };
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_OPTIONAL_REF_TRACKED_OPTIONAL_REF_HPP
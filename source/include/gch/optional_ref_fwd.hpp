@@ -0,0 +1,244 @@
+/** optional_ref_fwd.hpp
+ * Forward declarations and configuration macros for `optional_ref`.
+ *
+ * Copyright © 2019 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_OPTIONAL_REF_FWD_HPP
+#define GCH_OPTIONAL_REF_FWD_HPP
+
+#ifdef __clang__
+#  ifndef GCH_CLANG
+#    define GCH_CLANG
+#  endif
+#  if defined (__cplusplus) && __cplusplus >= 201703L
+#    ifndef GCH_CLANG_17
+#      define GCH_CLANG_17
+#    endif
+#  endif
+#endif
+
+#ifndef GCH_CPP14_CONSTEXPR
+#  if defined (__cpp_constexpr) && __cpp_constexpr >= 201304L
+#    define GCH_CPP14_CONSTEXPR constexpr
+#    ifndef GCH_HAS_CPP14_CONSTEXPR
+#      define GCH_HAS_CPP14_CONSTEXPR
+#    endif
+#  else
+#    define GCH_CPP14_CONSTEXPR
+#  endif
+#endif
+
+#ifndef GCH_CPP17_CONSTEXPR
+#  if defined (__cpp_constexpr) && __cpp_constexpr >= 201603L
+#    define GCH_CPP17_CONSTEXPR constexpr
+#    ifndef GCH_HAS_CPP17_CONSTEXPR
+#      define GCH_HAS_CPP17_CONSTEXPR
+#    endif
+#  else
+#    define GCH_CPP17_CONSTEXPR
+#  endif
+#endif
+
+#ifndef GCH_CPP20_CONSTEXPR
+#  if defined (__cpp_constexpr) && __cpp_constexpr >= 201907L
+#    define GCH_CPP20_CONSTEXPR constexpr
+#    ifndef GCH_HAS_CPP20_CONSTEXPR
+#      define GCH_HAS_CPP20_CONSTEXPR
+#    endif
+#  else
+#    define GCH_CPP20_CONSTEXPR
+#  endif
+#endif
+
+#ifndef GCH_CPP20_CONSTEVAL
+#  if defined (__cpp_consteval) && __cpp_consteval >= 201811L
+#    define GCH_CPP20_CONSTEVAL consteval
+#  else
+#    define GCH_CPP20_CONSTEVAL constexpr
+#  endif
+#endif
+
+#ifndef GCH_NODISCARD
+#  if defined (__has_cpp_attribute) && __has_cpp_attribute (nodiscard) >= 201603L
+#    if ! defined (__clang__) || defined (GCH_CLANG_17)
+#      define GCH_NODISCARD [[nodiscard]]
+#    else
+#      define GCH_NODISCARD
+#    endif
+#  else
+#    define GCH_NODISCARD
+#  endif
+#endif
+
+#ifndef GCH_COLD
+#  if defined (__GNUC__)
+#    define GCH_COLD __attribute__ ((cold))
+#  else
+#    define GCH_COLD
+#  endif
+#endif
+
+#ifndef GCH_NOINLINE
+#  if defined (__GNUC__)
+#    define GCH_NOINLINE __attribute__ ((noinline))
+#  elif defined (_MSC_VER)
+#    define GCH_NOINLINE __declspec (noinline)
+#  else
+#    define GCH_NOINLINE
+#  endif
+#endif
+
+#ifndef GCH_RETURNS_NONNULL
+#  if defined (__GNUC__)
+#    define GCH_RETURNS_NONNULL __attribute__ ((returns_nonnull))
+#  else
+#    define GCH_RETURNS_NONNULL
+#  endif
+#endif
+
+#ifndef GCH_PREFETCH
+#  if defined (__GNUC__)
+#    define GCH_PREFETCH(ADDR) __builtin_prefetch (ADDR)
+#  else
+#    define GCH_PREFETCH(ADDR) static_cast<void> (ADDR)
+#  endif
+#endif
+
+#ifndef GCH_INLINE_VARIABLE
+#  if defined (__cpp_inline_variables) && __cpp_inline_variables >= 201606L
+#    define GCH_INLINE_VARIABLE inline
+#  else
+#    define GCH_INLINE_VARIABLE
+#  endif
+#endif
+
+#ifndef GCH_IMPLICIT_CONVERSION
+#  if defined (__cpp_conditional_explicit) && __cpp_conditional_explicit >= 201806L
+#    define GCH_IMPLICIT_CONVERSION explicit (false)
+#  else
+#    define GCH_IMPLICIT_CONVERSION /* implicit */
+#  endif
+#endif
+
+#if defined (__cpp_deduction_guides) && __cpp_deduction_guides >= 201703L
+#  ifndef GCH_CTAD_SUPPORT
+#    define GCH_CTAD_SUPPORT
+#  endif
+#endif
+
+#if defined (__cpp_exceptions) && __cpp_exceptions >= 199711L
+#  ifndef GCH_EXCEPTIONS
+#    define GCH_EXCEPTIONS
+#  endif
+#endif
+
+#if defined (__cpp_impl_three_way_comparison) && __cpp_impl_three_way_comparison >= 201907L
+#  ifndef GCH_IMPL_THREE_WAY_COMPARISON
+#    define GCH_IMPL_THREE_WAY_COMPARISON
+#  endif
+#  if defined (__has_include) && __has_include (<compare>)
+#    include <compare>
+#    if defined (__cpp_lib_three_way_comparison) && __cpp_lib_three_way_comparison >= 201907L
+#      ifndef GCH_LIB_THREE_WAY_COMPARISON
+#        define GCH_LIB_THREE_WAY_COMPARISON
+#      endif
+#    endif
+#  endif
+#endif
+
+#if defined (__cpp_variable_templates) && __cpp_variable_templates >= 201304L
+#  ifndef GCH_VARIABLE_TEMPLATES
+#    define GCH_VARIABLE_TEMPLATES
+#  endif
+#endif
+
+#if defined (__cpp_noexcept_function_type) && __cpp_noexcept_function_type >= 201510L
+#  ifndef GCH_TYPESYSTEM_NOEXCEPT
+#    define GCH_TYPESYSTEM_NOEXCEPT
+#  endif
+#endif
+
+#if defined (__cpp_fold_expressions) && __cpp_fold_expressions >= 201603L
+#  ifndef GCH_FOLD_EXPRESSIONS
+#    define GCH_FOLD_EXPRESSIONS
+#  endif
+#endif
+
+#if defined (__cpp_concepts) && __cpp_concepts >= 201907L
+#  ifndef GCH_CONCEPTS
+#    define GCH_CONCEPTS
+#  endif
+#endif
+
+#if defined (__has_builtin)
+#  if __has_builtin (__builtin_is_constant_evaluated)
+#    ifndef GCH_BUILTIN_IS_CONSTANT_EVALUATED
+#      define GCH_BUILTIN_IS_CONSTANT_EVALUATED
+#    endif
+#  endif
+#elif (defined (__GNUC__) && __GNUC__ >= 9) || (defined (_MSC_VER) && _MSC_VER >= 1925)
+#  ifndef GCH_BUILTIN_IS_CONSTANT_EVALUATED
+#    define GCH_BUILTIN_IS_CONSTANT_EVALUATED
+#  endif
+#endif
+
+// Defined as `export` by the module interface unit (see source/modules/optional_ref.cppm).
+// Blocks of `gch::detail` are kept out of the namespace blocks marked with it.
+#ifndef GCH_OPTIONAL_REF_EXPORT
+#  define GCH_OPTIONAL_REF_EXPORT
+#endif
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+GCH_OPTIONAL_REF_EXPORT namespace gch
+{
+
+  struct nullopt_t;
+
+  template <typename ValueType>
+  class optional_ref;
+
+  /**
+   * A convenience alias for const references.
+   *
+   * @tparam T an unqualified value type.
+   */
+  template <typename T>
+  using optional_cref = optional_ref<const T>;
+
+  /**
+   * A utility type-trait for identifying `optional_ref`s.
+   *
+   * @tparam OptionalRef the type to be inspected.
+   */
+  template <typename OptionalRef>
+  struct is_optional_ref;
+
+#ifdef GCH_VARIABLE_TEMPLATES
+
+  /**
+   * An inline variable alias for `is_optional_ref`.
+   *
+   * @tparam OptionalRef the type to be inspected.
+   */
+  template <typename OptionalRef>
+  GCH_INLINE_VARIABLE constexpr
+  bool
+  is_optional_ref_v = is_optional_ref<OptionalRef>::value;
+
+#endif
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_OPTIONAL_REF_FWD_HPP
@@ -0,0 +1,80 @@
+/** optional_ref.cppm
+ * The module interface unit for gch::optional_ref.
+ *
+ * The definitions are shared with gch/optional_ref.hpp and its components.
+ * The public names in namespace `gch` are exported by defining
+ * `GCH_OPTIONAL_REF_EXPORT` before including the header in the module purview.
+ * The headers declare `gch::detail` outside of their exported blocks, so it is
+ * not visible to importers. The standard library headers are included in the
+ * global module fragment so that their include guards keep them out of the
+ * purview.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+module;
+
+#include <atomic>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined (__has_include) && __has_include (<any>)
+#  include <any>
+#endif
+
+#if defined (__has_include) && __has_include (<compare>)
+#  include <compare>
+#endif
+
+#if defined (__has_include) && __has_include (<optional>)
+#  include <optional>
+#endif
+
+#if defined (__has_include) && __has_include (<span>)
+#  include <span>
+#endif
+
+#if defined (__has_include) && __has_include (<variant>)
+#  include <variant>
+#endif
+
+export module gch.optional_ref;
+
+#define GCH_OPTIONAL_REF_EXPORT export
+#include "gch/optional_ref.hpp"
+#include "gch/optional_ref/any_optional_ref.hpp"
+#include "gch/optional_ref/by_address.hpp"
+#include "gch/optional_ref/cached_cast.hpp"
+#include "gch/optional_ref/engaged_ref.hpp"
+#include "gch/optional_ref/find_ref.hpp"
+#include "gch/optional_ref/generational_pool.hpp"
+#include "gch/optional_ref/identity_first.hpp"
+#include "gch/optional_ref/optional_function_ref.hpp"
+#include "gch/optional_ref/optional_index_ref.hpp"
+#include "gch/optional_ref/optional_span.hpp"
+#include "gch/optional_ref/partition_by_type.hpp"
+#include "gch/optional_ref/ref_pool.hpp"
+#include "gch/optional_ref/ref_queue.hpp"
+#include "gch/optional_ref/static_ref_table.hpp"
+#include "gch/optional_ref/swizzle.hpp"
+#include "gch/optional_ref/tracked_optional_ref.hpp"
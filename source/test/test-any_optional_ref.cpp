@@ -0,0 +1,110 @@
+/** test-any_optional_ref.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/optional_ref/any_optional_ref.hpp"
+
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+
+struct base
+{
+  int b = 1;
+};
+
+struct derived
+  : base
+{
+  int d = 2;
+};
+
+static_assert (sizeof (gch::any_optional_ref) == 2 * sizeof (void *),
+               "any_optional_ref should be two words.");
+
+static_assert (std::is_trivially_copyable<gch::any_optional_ref>::value,
+               "any_optional_ref should be trivially copyable.");
+
+static_assert (! std::is_constructible<gch::any_optional_ref, int&&>::value,
+               "any_optional_ref should not refer to temporaries.");
+
+static_assert (gch::any_optional_ref::token_of<int> () != gch::any_optional_ref::token_of<long> (),
+               "Different types should have different tokens.");
+
+static_assert (gch::any_optional_ref::token_of<int> ()
+               != gch::any_optional_ref::token_of<const int> (),
+               "Different qualifications should have different tokens.");
+
+int
+main (void)
+{
+  int i = 3;
+  const int ci = 4;
+  std::string s ("text");
+  derived d;
+
+  gch::any_optional_ref empty;
+  CHECK (! empty.has_value ());
+  CHECK (! empty);
+  CHECK (! empty.get<int> ());
+  CHECK (! empty.holds<int> ());
+  CHECK (empty.get_type_token () == nullptr);
+  CHECK (empty == gch::any_optional_ref (gch::nullopt));
+
+  gch::any_optional_ref ri (i);
+  CHECK (ri.has_value ());
+  CHECK (ri.get<int> ().refers_to (i));
+  CHECK (ri.get<const int> ().refers_to (i));
+  CHECK (ri.get<const volatile int> ().refers_to (i));
+  CHECK (! ri.get<long> ());
+  CHECK (! ri.get<unsigned> ());
+  CHECK (ri.get_type_token () == gch::any_optional_ref::token_of<int> ());
+
+  // Writes go to the referent.
+  *ri.get<int> () = 5;
+  CHECK (i == 5);
+
+  // A const referent may not be read as non-const.
+  gch::any_optional_ref rci (ci);
+  CHECK (! rci.get<int> ());
+  CHECK (rci.get<const int> ().refers_to (ci));
+
+  // Only the exact type matches, not its bases.
+  gch::any_optional_ref rd (d);
+  CHECK (rd.get<derived> ().refers_to (d));
+  CHECK (! rd.get<base> ());
+
+  // The same object as different types are different refs.
+  gch::any_optional_ref rb (static_cast<base&> (d));
+  CHECK (rb.get<base> ().refers_to (d));
+  CHECK (rb != rd);
+
+  // Converts from optional_ref.
+  gch::any_optional_ref rs = gch::optional_ref<std::string> (s);
+  CHECK (rs.get<std::string> ().refers_to (s));
+  gch::any_optional_ref rn = gch::optional_ref<std::string> ();
+  CHECK (! rn.has_value ());
+
+  // Copies refer to the same object, not to the ref.
+  gch::any_optional_ref copy (ri);
+  CHECK (copy == ri);
+  CHECK (copy.get<int> ().refers_to (i));
+
+  copy.reset ();
+  CHECK (! copy);
+  CHECK (copy != ri);
+
+  std::unordered_set<gch::any_optional_ref> set;
+  set.insert (ri);
+  set.insert (rs);
+  set.insert (gch::any_optional_ref (i));
+  CHECK (set.size () == 2);
+  CHECK (set.count (gch::any_optional_ref (s)) == 1);
+  CHECK (set.count (rd) == 0);
+
+  return 0;
+}
@@ -0,0 +1,45 @@
+/** test-bad_optional_access_handler.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+
+#include <cstdlib>
+
+#if defined (__has_cpp_attribute) && __has_cpp_attribute (noreturn) >= 200809L
+[[noreturn]]
+#endif
+static
+void
+handler (void)
+{
+  std::printf ("Handler correctly called.\n");
+  std::exit (EXIT_SUCCESS);
+}
+
+static
+void
+other_handler (void)
+{ }
+
+int
+main (void)
+{
+  CHECK (gch::get_bad_optional_access_handler () == nullptr);
+  CHECK (gch::set_bad_optional_access_handler (other_handler) == nullptr);
+  CHECK (gch::get_bad_optional_access_handler () == &other_handler);
+  CHECK (gch::set_bad_optional_access_handler (handler) == &other_handler);
+
+  int x = 1;
+  const gch::optional_ref<int> r { x };
+  CHECK (r.value () == 1);
+
+  const gch::optional_ref<int> n;
+  static_cast<void> (n.value ());
+
+  std::fprintf (stderr, "The bad access handler was not called.\n");
+  return 1;
+}
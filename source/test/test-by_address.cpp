@@ -0,0 +1,89 @@
+/** test-by_address.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/optional_ref/by_address.hpp"
+
+#include <cstdint>
+#include <vector>
+
+struct visitor
+{
+  void
+  operator() (int& x)
+  {
+    if (last != nullptr && &x < last)
+      ordered = false;
+    last = &x;
+    ++count;
+  }
+
+  const int   *last    = nullptr;
+  bool         ordered = true;
+  std::size_t  count   = 0;
+};
+
+int
+main (void)
+{
+  std::vector<int> values (1000);
+  for (std::size_t i = 0; i < values.size (); ++i)
+    values[i] = static_cast<int> (i);
+
+  // Refer to the values in a scrambled order, with some empty references.
+  std::vector<gch::optional_ref<int>> refs;
+  for (std::size_t i = 0; i < values.size (); ++i)
+  {
+    if (i % 7 == 0)
+      refs.emplace_back ();
+    refs.emplace_back (values[(i * 379) % values.size ()]);
+  }
+
+  const gch::optional_ref<int> *first = refs.data ();
+  const gch::optional_ref<int> *last  = refs.data () + refs.size ();
+
+  visitor v = gch::for_each_by_address (first, last, visitor { });
+  CHECK (v.ordered);
+  CHECK (v.count == values.size ());
+
+  // Scatter the results back into the original order.
+  std::vector<int> results (refs.size (), -1);
+  gch::for_each_by_address_indexed (first, last, [&results] (int& x, std::size_t i) {
+    results[i] = x;
+  });
+  for (std::size_t i = 0; i < refs.size (); ++i)
+    CHECK (refs[i].has_value () ? results[i] == *refs[i] : results[i] == -1);
+
+  // Grouping by page keeps the original order within each page.
+  std::vector<std::size_t> order = gch::address_order (first, last, gch::page_shift_4k);
+  CHECK (order.size () == values.size ());
+  for (std::size_t i = 1; i < order.size (); ++i)
+  {
+    std::uintptr_t prev = reinterpret_cast<std::uintptr_t> (refs[order[i - 1]].get_pointer ());
+    std::uintptr_t curr = reinterpret_cast<std::uintptr_t> (refs[order[i]].get_pointer ());
+    CHECK ((prev >> gch::page_shift_4k) <= (curr >> gch::page_shift_4k));
+    if ((prev >> gch::page_shift_4k) == (curr >> gch::page_shift_4k))
+      CHECK (order[i - 1] < order[i]);
+  }
+
+  // A shift of the whole address puts every reference in one page.
+  std::vector<std::size_t> one_page = gch::address_order (first, last, 64);
+  CHECK (one_page.size () == values.size ());
+  for (std::size_t i = 1; i < one_page.size (); ++i)
+    CHECK (one_page[i - 1] < one_page[i]);
+
+  std::vector<gch::optional_ref<int>> empty;
+  CHECK (gch::address_order (empty.data (), empty.data ()).empty ());
+
+#if defined (__cpp_lib_span) && __cpp_lib_span >= 202002L
+  visitor sv = gch::for_each_by_address (std::span<gch::optional_ref<int>> (refs), visitor { });
+  CHECK (sv.ordered);
+  CHECK (sv.count == values.size ());
+#endif
+
+  return 0;
+}
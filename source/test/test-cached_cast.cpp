@@ -0,0 +1,138 @@
+/** test-cached_cast.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/optional_ref/cached_cast.hpp"
+
+struct shape
+{
+  virtual ~shape (void) = default;
+  int s = 1;
+};
+
+struct named : virtual shape
+{
+  int n = 2;
+};
+
+struct colored : virtual shape
+{
+  int c = 3;
+};
+
+// A diamond through a virtual base.
+struct label : named, colored
+{
+  int l = 4;
+};
+
+struct plain : shape
+{
+  int p = 5;
+};
+
+struct mixin
+{
+  virtual ~mixin (void) = default;
+  int m = 6;
+};
+
+// `colored` is not at the start of the object.
+struct widget : mixin, colored
+{
+  int w = 7;
+};
+
+struct downcast_site { };
+struct crosscast_site { };
+
+// Casts through each cache with a given tag and compares the results with
+// `dynamic_cast`.
+template <typename T, typename Tag>
+struct cached_caster
+{
+  template <typename U>
+  auto
+  cast (U *p) const noexcept
+    -> decltype (gch::maybe_cast_cached<T, Tag> (gch::optional_ref<U> (p)))
+  {
+    return gch::maybe_cast_cached<T, Tag> (gch::optional_ref<U> (p));
+  }
+
+  template <typename U>
+  auto
+  cast_atomic (U *p) const noexcept
+    -> decltype (gch::maybe_cast_cached_atomic<T, Tag> (gch::optional_ref<U> (p)))
+  {
+    return gch::maybe_cast_cached_atomic<T, Tag> (gch::optional_ref<U> (p));
+  }
+
+  template <typename U>
+  int
+  check (U *p) const
+  {
+    T *expected = dynamic_cast<T *> (p);
+    const U *const_p = p;
+    CHECK (cast (p).get_pointer () == expected);
+    CHECK (cast (const_p).get_pointer () == expected);
+    CHECK (cast_atomic (p).get_pointer () == expected);
+    CHECK (cast_atomic (const_p).get_pointer () == expected);
+    return 0;
+  }
+
+  // Casts every object twice, so that the second cast hits the cache.
+  template <typename U>
+  int
+  check_all (U *const (&sources)[4]) const
+  {
+    for (int pass = 0; pass < 2; ++pass)
+    {
+      for (U *p : sources)
+      {
+        if (int result = check (p))
+          return result;
+      }
+    }
+    return 0;
+  }
+};
+
+int
+main (void)
+{
+  label  lb;
+  widget wd;
+  plain  pl;
+  label  lb2;
+
+  shape *shapes[4] = { &lb, &wd, &pl, &lb2 };
+  colored *colors[4] = { &lb, &wd, &lb2, &wd };
+
+  // Downcasts through a virtual base, including misses.
+  cached_caster<colored, downcast_site> down;
+  CHECK (down.check_all (shapes) == 0);
+
+  // Crosscasts, where the offset depends on the dynamic type.
+  cached_caster<named, crosscast_site> cross;
+  CHECK (cross.check_all (colors) == 0);
+
+  // The offsets point at the right subobject.
+  CHECK (gch::maybe_cast_cached<widget> (gch::optional_ref<colored> (wd))->w == 7);
+  CHECK (gch::maybe_cast_cached<colored> (gch::optional_ref<shape> (wd))->c == 3);
+  CHECK (gch::maybe_cast_cached<mixin> (gch::optional_ref<colored> (wd))->m == 6);
+
+  // An empty ref stays empty, and does not touch the cache.
+  CHECK (! gch::maybe_cast_cached<colored> (gch::optional_ref<shape> ()));
+  CHECK (! gch::maybe_cast_cached_atomic<colored> (gch::optional_ref<shape> ()));
+  CHECK (! gch::maybe_cast_cached<colored> (gch::optional_ref<const shape> ()));
+
+  // A cached failure stays a failure.
+  CHECK (! gch::maybe_cast_cached<colored> (gch::optional_ref<shape> (pl)));
+  CHECK (! gch::maybe_cast_cached<colored> (gch::optional_ref<shape> (pl)));
+
+  return 0;
+}
@@ -0,0 +1,218 @@
+/** test-classof-cast.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/optional_ref/cast.hpp"
+
+#include <type_traits>
+
+// These tests are built without RTTI, so every downcast must use `classof`.
+
+enum class node_kind : unsigned char
+{
+  circle,
+  square,
+  rectangle,
+  last_quad = rectangle,
+  text
+};
+
+struct node
+{
+  constexpr explicit
+  node (node_kind k) noexcept
+    : m_kind (k)
+  { }
+
+  constexpr
+  node_kind
+  kind (void) const noexcept
+  {
+    return m_kind;
+  }
+
+private:
+  node_kind m_kind;
+};
+
+struct circle
+  : node
+{
+  circle (void) noexcept
+    : node (node_kind::circle)
+  { }
+};
+
+struct quad
+  : node
+{
+  explicit
+  quad (node_kind k) noexcept
+    : node (k)
+  { }
+};
+
+struct square
+  : quad
+{
+  square (void) noexcept
+    : quad (node_kind::square)
+  { }
+};
+
+struct rectangle
+  : quad
+{
+  rectangle (void) noexcept
+    : quad (node_kind::rectangle)
+  { }
+};
+
+// Uses a member `classof` in place of a `cast_traits` specialization.
+struct text
+  : node
+{
+  text (void) noexcept
+    : node (node_kind::text)
+  { }
+
+  static constexpr
+  bool
+  classof (const node& n) noexcept
+  {
+    return n.kind () == node_kind::text;
+  }
+};
+
+namespace gch
+{
+
+  template <>
+  struct cast_traits<circle>
+    : kind_range_cast_traits<node_kind, node_kind::circle>
+  { };
+
+  template <>
+  struct cast_traits<quad>
+    : kind_range_cast_traits<node_kind, node_kind::square, node_kind::last_quad>
+  { };
+
+  template <>
+  struct cast_traits<square>
+    : kind_range_cast_traits<node_kind, node_kind::square>
+  { };
+
+}
+
+// A kind stored in a data member.
+struct event
+{
+  int kind;
+};
+
+struct key_event
+  : event
+{ };
+
+namespace gch
+{
+
+  template <>
+  struct cast_traits<key_event>
+    : kind_range_cast_traits<int, 10, 19>
+  { };
+
+}
+
+// A polymorphic mixin which also has a kind, so `cast_traits<circle>::classof`
+// accepts it even though `circle` does not derive from it.
+struct selectable
+{
+  selectable (void) = default;
+  selectable (const selectable&) = default;
+  selectable& operator= (const selectable&) = default;
+  virtual ~selectable (void) = default;
+
+  virtual
+  node_kind
+  kind (void) const noexcept = 0;
+};
+
+struct selectable_circle
+  : circle,
+    selectable
+{
+  node_kind
+  kind (void) const noexcept override
+  {
+    return node_kind::circle;
+  }
+};
+
+// A cross-cast never uses `classof`, since the result cannot be a `static_cast`.
+static_assert (std::is_same<gch::detail::cast_tag<circle, selectable>,
+                            gch::detail::dynamic_cast_tag>::value,
+               "A cross-cast should use dynamic_cast.");
+
+static_assert (std::is_same<gch::detail::cast_tag<const circle, const node>,
+                            gch::detail::traits_classof_cast_tag>::value,
+               "A downcast should use cast_traits.");
+
+int
+main (void)
+{
+  circle    c;
+  square    s;
+  rectangle r;
+  text      t;
+
+  gch::optional_ref<node> nc { c };
+  gch::optional_ref<node> ns { s };
+  gch::optional_ref<node> nr { r };
+  gch::optional_ref<node> nt { t };
+  gch::optional_ref<node> none;
+
+  CHECK (gch::maybe_cast<circle> (nc).refers_to (c));
+  CHECK (! gch::maybe_cast<circle> (ns).has_value ());
+  CHECK (! gch::maybe_cast<circle> (none).has_value ());
+
+  CHECK (gch::maybe_cast<quad> (ns).has_value ());
+  CHECK (gch::maybe_cast<quad> (nr).has_value ());
+  CHECK (! gch::maybe_cast<quad> (nc).has_value ());
+  CHECK (! gch::maybe_cast<quad> (nt).has_value ());
+
+  CHECK (gch::maybe_cast<square> (ns).refers_to (s));
+  CHECK (! gch::maybe_cast<square> (nr).has_value ());
+
+  CHECK (gch::maybe_cast<text> (nt).refers_to (t));
+  CHECK (! gch::maybe_cast<text> (nc).has_value ());
+
+  // Const sources, references, and pointers.
+  gch::optional_ref<const node> cnr { r };
+  gch::optional_ref<const quad> cq = gch::maybe_cast<quad> (cnr);
+  CHECK (cq.refers_to (r));
+  CHECK (gch::maybe_cast<square> (static_cast<node&> (s)).refers_to (s));
+  CHECK (gch::maybe_cast<square> (static_cast<const node *> (&s)).refers_to (s));
+  CHECK (! gch::maybe_cast<square> (static_cast<node *> (nullptr)).has_value ());
+
+  // Upcasts are implicit.
+  CHECK (gch::maybe_cast<node> (gch::optional_ref<square> { s }).refers_to (s));
+
+  key_event k;
+  k.kind = 12;
+  event other { 3 };
+  CHECK (gch::maybe_cast<key_event> (static_cast<event&> (k)).refers_to (k));
+  CHECK (! gch::maybe_cast<key_event> (other).has_value ());
+
+#if defined (__GXX_RTTI) || defined (_CPPRTTI)
+  selectable_circle sc;
+  gch::optional_ref<selectable> sel { sc };
+  CHECK (gch::maybe_cast<circle> (sel).refers_to (sc));
+#endif
+
+  return 0;
+}
@@ -0,0 +1,60 @@
+/** test-core.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "gch/optional_ref_fwd.hpp"
+
+// Only the forward declarations are needed to pass references around.
+static
+int
+forwarded (gch::optional_ref<int> r);
+
+#include "gch/optional_ref/core.hpp"
+
+#include <cstdio>
+
+#if defined (GCH_OPTIONAL_REF_MONADIC_HPP) \
+ || defined (GCH_OPTIONAL_REF_CAST_HPP)    \
+ || defined (GCH_OPTIONAL_REF_HASH_HPP)
+#  error "The core header should not include the optional components."
+#endif
+
+#define CHECK(EXPR)                                                           \
+if (! (EXPR))                                                                 \
+{                                                                             \
+  printf ("Check failed in file " __FILE__ " at line %i:\n" #EXPR, __LINE__); \
+  return 1;                                                                   \
+} (void)0
+
+static
+int
+forwarded (gch::optional_ref<int> r)
+{
+  return r.value_or (0);
+}
+
+int
+main (void)
+{
+  int x = 1;
+  int y = 2;
+  gch::optional_ref<int>  rx { x };
+  gch::optional_cref<int> ry { y };
+  gch::optional_ref<int>  rn = gch::nullopt;
+
+  static_assert (gch::is_optional_ref<gch::optional_cref<int>>::value, "");
+
+  CHECK (forwarded (rx) == 1);
+  CHECK (forwarded (rn) == 0);
+
+  CHECK (rx != ry);
+  CHECK (rx <  ry);
+  CHECK (rn == gch::nullopt);
+  CHECK (rx == 1);
+  CHECK (gch::as_const (rx).refers_to (x));
+
+  return 0;
+}
@@ -0,0 +1,110 @@
+/** test-engaged_ref.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/optional_ref/engaged_ref.hpp"
+
+struct base
+{
+  int x = 1;
+};
+
+struct derived
+  : base
+{
+  int
+  twice (void) const noexcept
+  {
+    return 2 * x;
+  }
+
+  base b;
+};
+
+struct not_default_constructible
+{
+  explicit
+  not_default_constructible (int v)
+    : value (v)
+  { }
+
+  int value;
+};
+
+static_assert (sizeof (gch::engaged_ref<int>) == sizeof (int *), "");
+static_assert (std::is_trivially_copyable<gch::engaged_ref<int>>::value, "");
+static_assert (! std::is_default_constructible<gch::engaged_ref<int>>::value, "");
+static_assert (! std::is_constructible<gch::engaged_ref<int>, int&&>::value, "");
+static_assert (! std::is_convertible<gch::optional_ref<int>, gch::engaged_ref<int>>::value, "");
+static_assert (std::is_convertible<gch::engaged_ref<int>, gch::optional_ref<const int>>::value,
+               "");
+static_assert (std::is_convertible<gch::engaged_ref<derived>, gch::engaged_ref<base>>::value, "");
+
+static
+int
+read (gch::engaged_ref<const int> r) noexcept
+{
+  return *r;
+}
+
+int
+main (void)
+{
+  int i = 3;
+  gch::optional_ref<int> opt { i };
+
+  gch::engaged_ref<int> e { opt };
+  CHECK (e.refers_to (i));
+  CHECK (e.has_value () && static_cast<bool> (e));
+  CHECK (&e.get () == &i && e.get_pointer () == &i && &e.value () == &i);
+  CHECK (read (e) == 3);
+
+  gch::optional_ref<const int> back = e;
+  CHECK (back.refers_to (i));
+
+  bool engaged = false;
+  if (auto r = gch::engaged (opt))
+  {
+    engaged = true;
+    CHECK (read (*r) == 3);
+  }
+  CHECK (engaged);
+
+  gch::optional_ref<int> none;
+  CHECK (! gch::engaged (none));
+
+  derived d;
+  gch::engaged_ref<derived> ed { d };
+  gch::engaged_ref<base> eb = ed;
+  CHECK (eb->x == 1);
+
+  CHECK (gch::maybe_invoke (ed, &derived::twice) == 2);
+  gch::engaged_ref<base> member = gch::maybe_invoke (ed, &derived::b);
+  CHECK (member.refers_to (d.b));
+  gch::engaged_ref<int> field = gch::maybe_invoke (eb, [] (base& b) noexcept -> int& { return b.x; });
+  CHECK (field.refers_to (d.x));
+  CHECK (gch::maybe_invoke (e, [] (int& v, int k) noexcept { return not_default_constructible { v + k }; },
+                            4).value == 7);
+  gch::maybe_invoke (e, [] (int& v) noexcept { ++v; });
+  CHECK (i == 4);
+
+#ifdef GCH_EXCEPTIONS
+  bool caught = false;
+  try
+  {
+    gch::engaged_ref<int> bad { none };
+    static_cast<void> (bad);
+  }
+  catch (const gch::bad_optional_access&)
+  {
+    caught = true;
+  }
+  CHECK (caught);
+#endif
+
+  return 0;
+}
@@ -0,0 +1,355 @@
+/** test-find_ref.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/optional_ref/find_ref.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+struct point
+{
+  int x;
+  int y;
+};
+
+// A minimal open-addressing table with linear probing.
+class flat_table
+{
+public:
+  explicit
+  flat_table (std::size_t capacity)
+    : m_keys (capacity, -1),
+      m_values (capacity)
+  { }
+
+  void
+  insert (int key, int value)
+  {
+    std::size_t i = home (key);
+    while (m_keys[i] != -1 && m_keys[i] != key)
+      i = (i + 1) % m_keys.size ();
+    m_keys[i]   = key;
+    m_values[i] = value;
+  }
+
+  std::size_t
+  home (int key) const noexcept
+  {
+    return static_cast<std::size_t> (key) % m_keys.size ();
+  }
+
+  const int *
+  slot_keys (std::size_t i) const noexcept
+  {
+    return m_keys.data () + i;
+  }
+
+  gch::optional_ref<int>
+  probe (int key, std::size_t i) noexcept
+  {
+    for (; m_keys[i] != -1; i = (i + 1) % m_keys.size ())
+    {
+      if (m_keys[i] == key)
+        return gch::optional_ref<int> (m_values[i]);
+    }
+    return gch::nullopt;
+  }
+
+private:
+  std::vector<int> m_keys;
+  std::vector<int> m_values;
+};
+
+namespace gch
+{
+
+  template <>
+  struct find_ref_batch_traits<flat_table>
+  {
+    using probe_type = std::size_t;
+
+    static
+    probe_type
+    start (flat_table& t, int key) noexcept
+    {
+      std::size_t i = t.home (key);
+      GCH_PREFETCH (t.slot_keys (i));
+      return i;
+    }
+
+    static
+    void
+    advance (flat_table&, probe_type&) noexcept
+    { }
+
+    static
+    optional_ref<int>
+    resolve (flat_table& t, int key, probe_type& i) noexcept
+    {
+      return t.probe (key, i);
+    }
+  };
+
+}
+
+#if defined (__cpp_lib_string_view) && __cpp_lib_string_view >= 201606L
+
+struct string_hash
+{
+  using is_transparent = void;
+
+  std::size_t
+  operator() (std::string_view s) const noexcept
+  {
+    return std::hash<std::string_view> { } (s);
+  }
+};
+
+#endif
+
+static constexpr int primes[] { 2, 3, 5, 7 };
+
+static_assert (gch::at_ref (primes, 2) == 5, "at_ref should be usable in constant expressions.");
+static_assert (! gch::at_ref (primes, 4), "at_ref should check the bounds.");
+
+static
+int
+test_maps (void)
+{
+  std::map<int, point> m;
+  m[1] = point { 1, 2 };
+
+  gch::optional_ref<point> p = gch::find_ref (m, 1);
+  CHECK (p.refers_to (m[1]));
+  CHECK (! gch::find_ref (m, 2));
+
+  const std::map<int, point>& cm = m;
+  gch::optional_cref<point> cp = gch::find_ref (cm, 1);
+  CHECK (cp.refers_to (m[1]));
+
+  // Composes with the monadic operators.
+  CHECK ((gch::find_ref (m, 1) >>= &point::y).refers_to (m[1].y));
+  CHECK (! (gch::find_ref (m, 2) >>= &point::y));
+
+  std::unordered_map<std::string, int> um;
+  um["a"] = 3;
+  CHECK (gch::find_ref (um, std::string ("a")) == 3);
+  CHECK (! gch::find_ref (um, std::string ("b")));
+
+  // Modifying through the ref modifies the element.
+  *gch::find_ref (um, std::string ("a")) = 4;
+  CHECK (um["a"] == 4);
+
+  return 0;
+}
+
+static
+int
+test_sets (void)
+{
+  std::set<int> s { 1, 2, 3 };
+  gch::optional_cref<int> r = gch::find_ref (s, 2);
+  CHECK (r.refers_to (*s.find (2)));
+  CHECK (! gch::find_ref (s, 4));
+  return 0;
+}
+
+#if __cplusplus >= 201402L
+
+static
+int
+test_transparent (void)
+{
+  // The key is compared as a `const char *` without building a `std::string`.
+  std::map<std::string, int, std::less<>> m;
+  m["alpha"] = 1;
+  m["beta"]  = 2;
+
+  CHECK (gch::find_ref (m, "beta") == 2);
+  CHECK (! gch::find_ref (m, "gamma"));
+
+  std::set<std::string, std::less<>> s { "alpha" };
+  CHECK (gch::find_ref (s, "alpha").has_value ());
+  CHECK (! gch::find_ref (s, "beta"));
+  return 0;
+}
+
+#endif
+
+static
+int
+test_sequences (void)
+{
+  std::vector<int> v { 4, 5, 6 };
+  CHECK (gch::at_ref (v, 0).refers_to (v[0]));
+  CHECK (gch::at_ref (v, 2).refers_to (v[2]));
+  CHECK (! gch::at_ref (v, 3));
+
+  const std::vector<int>& cv = v;
+  gch::optional_cref<int> cr = gch::at_ref (cv, 1);
+  CHECK (cr.refers_to (v[1]));
+
+  std::array<int, 2> a { { 7, 8 } };
+  CHECK (gch::at_ref (a, 1).refers_to (a[1]));
+  CHECK (! gch::at_ref (a, 2));
+
+  int c[3] = { 1, 2, 3 };
+  CHECK (gch::at_ref (c, 0).refers_to (c[0]));
+  CHECK (! gch::at_ref (c, 3));
+
+  std::string str ("xy");
+  CHECK (gch::at_ref (str, 1) == 'y');
+  CHECK (! gch::at_ref (str, 2));
+  return 0;
+}
+
+static
+int
+test_batch (void)
+{
+  // More keys than a group, and not a multiple of the group size.
+  std::vector<int> keys;
+  for (int i = 0; i < 45; ++i)
+    keys.push_back (i * 7);
+
+  std::unordered_map<int, int> m;
+  flat_table t (64);
+  for (int i = 0; i < 100; i += 2)
+  {
+    m[i] = i + 1;
+    t.insert (i, i + 1);
+  }
+
+  std::vector<gch::optional_ref<int>> out (keys.size ());
+  gch::find_ref_batch (m, keys.data (), keys.size (), out.data ());
+  for (std::size_t i = 0; i < keys.size (); ++i)
+    CHECK (out[i].get_pointer () == gch::find_ref (m, keys[i]).get_pointer ());
+
+  const std::unordered_map<int, int>& cm = m;
+  std::vector<gch::optional_cref<int>> const_out (keys.size ());
+  gch::find_ref_batch<4> (cm, keys.data (), keys.size (), const_out.data ());
+  for (std::size_t i = 0; i < keys.size (); ++i)
+    CHECK (const_out[i].get_pointer () == gch::find_ref (cm, keys[i]).get_pointer ());
+
+  std::fill (out.begin (), out.end (), gch::nullopt);
+  gch::find_ref_batch (t, keys.data (), keys.size (), out.data ());
+  for (std::size_t i = 0; i < keys.size (); ++i)
+  {
+    int k = keys[i];
+    bool expected = k < 100 && k / 2 * 2 == k;
+    CHECK (out[i].has_value () == expected);
+    CHECK (! expected || *out[i] == k + 1);
+  }
+
+  std::unordered_set<std::string> s { "a", "b" };
+  std::string skeys[] = { "a", "c", "b" };
+  gch::optional_cref<std::string> sout[3];
+  gch::find_ref_batch (s, skeys, 3, sout);
+  CHECK (sout[0].refers_to (*s.find ("a")));
+  CHECK (! sout[1]);
+  CHECK (sout[2].refers_to (*s.find ("b")));
+
+#if defined (__cpp_lib_string_view) && __cpp_lib_string_view >= 201606L
+  // A transparent hash finds `std::string` keys from `std::string_view`s
+  // without converting them.
+  std::unordered_map<std::string, int, string_hash, std::equal_to<>> sm;
+  sm["alpha"] = 1;
+  sm["beta"]  = 2;
+
+  std::string_view views[] = { "beta", "gamma", "alpha" };
+  gch::optional_ref<int> view_out[3];
+  gch::find_ref_batch (sm, views, 3, view_out);
+  CHECK (view_out[0].refers_to (sm[std::string ("beta")]));
+  CHECK (! view_out[1]);
+  CHECK (view_out[2].refers_to (sm[std::string ("alpha")]));
+#endif
+
+#if defined (__cpp_lib_span) && __cpp_lib_span >= 202002L
+  std::vector<gch::optional_ref<int>> span_out (keys.size ());
+  gch::find_ref_batch (m, std::span<const int> (keys),
+                       std::span<gch::optional_ref<int>> (span_out));
+  for (std::size_t i = 0; i < keys.size (); ++i)
+    CHECK (span_out[i].get_pointer () == gch::find_ref (m, keys[i]).get_pointer ());
+#endif
+
+  return 0;
+}
+
+#if defined (__cpp_lib_variant) && __cpp_lib_variant >= 201606L
+
+static
+int
+test_variant (void)
+{
+  std::variant<int, std::string> v (std::string ("text"));
+  CHECK (gch::get_if_ref<std::string> (v).refers_to (std::get<std::string> (v)));
+  CHECK (gch::get_if_ref<1> (v).refers_to (std::get<1> (v)));
+  CHECK (! gch::get_if_ref<int> (v));
+  CHECK (! gch::get_if_ref<0> (v));
+
+  const std::variant<int, std::string>& cv = v;
+  gch::optional_cref<std::string> cr = gch::get_if_ref<std::string> (cv);
+  CHECK (cr.refers_to (std::get<1> (v)));
+
+  v = 3;
+  CHECK (gch::get_if_ref<int> (v) == 3);
+  CHECK (! gch::get_if_ref<std::string> (v));
+  return 0;
+}
+
+#endif
+
+#if defined (__cpp_lib_any) && __cpp_lib_any >= 201606L
+
+static
+int
+test_any (void)
+{
+  std::any a (point { 1, 2 });
+  CHECK (gch::any_ref<point> (a).refers_to (*std::any_cast<point> (&a)));
+  CHECK (! gch::any_ref<int> (a));
+
+  const std::any& ca = a;
+  gch::optional_cref<point> cr = gch::any_ref<point> (ca);
+  CHECK (cr.refers_to (*std::any_cast<point> (&a)));
+
+  CHECK ((gch::any_ref<point> (a) >>= &point::x) == 1);
+
+  std::any empty;
+  CHECK (! gch::any_ref<point> (empty));
+  return 0;
+}
+
+#endif
+
+int
+main (void)
+{
+  CHECK (test_maps () == 0);
+  CHECK (test_sets () == 0);
+#if __cplusplus >= 201402L
+  CHECK (test_transparent () == 0);
+#endif
+  CHECK (test_sequences () == 0);
+  CHECK (test_batch () == 0);
+#if defined (__cpp_lib_variant) && __cpp_lib_variant >= 201606L
+  CHECK (test_variant () == 0);
+#endif
+#if defined (__cpp_lib_any) && __cpp_lib_any >= 201606L
+  CHECK (test_any () == 0);
+#endif
+  return 0;
+}
@@ -0,0 +1,125 @@
+/** test-generational_pool.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/optional_ref/generational_pool.hpp"
+
+struct counted
+{
+  explicit counted (int v) noexcept
+    : value (v)
+  {
+    ++count;
+  }
+
+  ~counted (void)
+  {
+    --count;
+  }
+
+  counted (const counted&)            = delete;
+  counted& operator= (const counted&) = delete;
+
+  int value;
+
+  static int count;
+};
+
+int counted::count = 0;
+
+static
+int
+dangling_access (gch::checked_optional_ref<counted> r)
+{
+#ifdef GCH_EXCEPTIONS
+  try
+  {
+    static_cast<void> (r.value ());
+  }
+  catch (const gch::dangling_optional_ref_access&)
+  {
+    return 0;
+  }
+  catch (...)
+  {
+    return 2;
+  }
+  return 1;
+#else
+  return r.is_dangling () ? 0 : 1;
+#endif
+}
+
+int
+main (void)
+{
+  {
+    gch::generational_pool<counted> pool;
+    CHECK (pool.empty ());
+
+    gch::checked_optional_ref<counted> a = pool.emplace (1);
+    gch::checked_optional_ref<counted> b = pool.emplace (2);
+    CHECK (pool.size () == 2);
+    CHECK (counted::count == 2);
+    CHECK (a.has_value () && a->value == 1);
+    CHECK (b.value ().value == 2);
+    CHECK (a != b);
+
+    gch::checked_optional_ref<const counted> ca = a;
+    CHECK (ca.has_value () && ca->value == 1);
+
+    gch::optional_ref<counted> unchecked = a;
+    CHECK (unchecked.refers_to (*a));
+
+    CHECK (pool.erase (a));
+    CHECK (! pool.erase (a));
+    CHECK (counted::count == 1);
+    CHECK (! a.has_value ());
+    CHECK (a.is_dangling ());
+    CHECK (! ca.has_value ());
+    CHECK (! gch::optional_ref<counted> (a).has_value ());
+
+    // The slot is reused, but the old references stay invalid.
+    gch::checked_optional_ref<counted> c = pool.emplace (3);
+    CHECK (pool.capacity () == 2);
+    CHECK (c.has_value ());
+    CHECK (! a.has_value ());
+    CHECK (a != c);
+
+    int ret = dangling_access (a);
+    CHECK (ret == 0);
+
+    counted fallback { 4 };
+    CHECK (a.value_or (fallback).value == 4);
+    CHECK (c.value_or (fallback).value == 3);
+
+    gch::checked_optional_ref<counted> n;
+    CHECK (! n.has_value ());
+    CHECK (! n.is_dangling ());
+    CHECK (n.get_pointer () == nullptr);
+    CHECK (n == gch::checked_optional_ref<counted> (gch::nullopt));
+
+    c.reset ();
+    CHECK (! c.has_value ());
+    CHECK (! c.is_dangling ());
+
+    pool.clear ();
+    CHECK (pool.empty ());
+    CHECK (! b.has_value ());
+    CHECK (counted::count == 1);
+  }
+  CHECK (counted::count == 0);
+
+  {
+    gch::generational_pool<counted> pool;
+    static_cast<void> (pool.emplace (5));
+    static_cast<void> (pool.emplace (6));
+  }
+  CHECK (counted::count == 0);
+
+  return 0;
+}
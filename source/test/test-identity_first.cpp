@@ -0,0 +1,156 @@
+/** test-identity_first.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/optional_ref/identity_first.hpp"
+
+#include <limits>
+#include <set>
+#include <unordered_set>
+
+struct counted
+{
+  int value;
+};
+
+static int comparisons = 0;
+
+static
+bool
+operator== (const counted& lhs, const counted& rhs) noexcept
+{
+  ++comparisons;
+  return lhs.value == rhs.value;
+}
+
+static
+bool
+operator< (const counted& lhs, const counted& rhs) noexcept
+{
+  ++comparisons;
+  return lhs.value < rhs.value;
+}
+
+#ifdef GCH_LIB_THREE_WAY_COMPARISON
+
+static
+std::strong_ordering
+operator<=> (const counted& lhs, const counted& rhs) noexcept
+{
+  ++comparisons;
+  return lhs.value <=> rhs.value;
+}
+
+#endif
+
+struct counted_hash
+{
+  std::size_t
+  operator() (const counted& c) const noexcept
+  {
+    return static_cast<std::size_t> (c.value);
+  }
+};
+
+struct final_hash final
+{
+  std::size_t
+  operator() (const counted& c) const noexcept
+  {
+    return static_cast<std::size_t> (c.value) * 31U;
+  }
+};
+
+int
+main (void)
+{
+  counted a { 1 };
+  counted b { 1 };
+  counted c { 2 };
+
+  gch::optional_ref<counted> ra { a };
+  gch::optional_ref<counted> rb { b };
+  gch::optional_ref<counted> rc { c };
+  gch::optional_ref<counted> n;
+
+  gch::identity_first_equal eq;
+  CHECK (eq (ra, ra));
+  CHECK (comparisons == 0);
+  CHECK (eq (n, n));
+  CHECK (! eq (ra, n));
+  CHECK (! eq (n, ra));
+  CHECK (comparisons == 0);
+  CHECK (eq (ra, rb));
+  CHECK (! eq (ra, rc));
+  CHECK (comparisons == 2);
+  CHECK (eq (ra, gch::optional_ref<const counted> { a }));
+
+  comparisons = 0;
+  gch::identity_first_less lt;
+  CHECK (! lt (ra, ra));
+  CHECK (comparisons == 0);
+  CHECK (lt (n, ra));
+  CHECK (! lt (ra, n));
+  CHECK (lt (ra, rc));
+  CHECK (! lt (rc, ra));
+  CHECK (comparisons == 2);
+
+#ifdef GCH_LIB_THREE_WAY_COMPARISON
+  comparisons = 0;
+  gch::identity_first_three_way cmp;
+  CHECK (cmp (ra, ra) == 0);
+  CHECK (comparisons == 0);
+  CHECK (cmp (ra, rc) < 0);
+  CHECK (cmp (n, ra) < 0);
+  CHECK (comparisons == 1);
+
+  // Aliases of NaN are equivalent.
+  double nan = std::numeric_limits<double>::quiet_NaN ();
+  gch::optional_ref<double> rnan { nan };
+  CHECK (cmp (rnan, rnan) == 0);
+  CHECK (! (rnan <=> rnan == 0));
+#endif
+
+  // Aliases of NaN are equal, unlike with operator==.
+  double d = std::numeric_limits<double>::quiet_NaN ();
+  gch::optional_ref<double> rd { d };
+  CHECK (eq (rd, rd));
+  CHECK (! (rd == rd));
+
+  // Container use.
+  std::unordered_set<gch::optional_ref<counted>,
+                     gch::identity_first_hash<counted_hash>,
+                     gch::identity_first_equal> dedup { ra, ra, rb, rc, n, n };
+  CHECK (dedup.size () == 3);
+
+  // A final hasher.
+  gch::identity_first_hash<final_hash> fh;
+  CHECK (fh (ra) == 31U);
+  CHECK (fh (n) == 0U);
+
+  // The default hashes the referent with std::hash.
+  int i1 = 5;
+  int i2 = 5;
+  gch::identity_first_hash<> ih;
+  CHECK (ih (gch::optional_ref<int> { i1 }) == ih (gch::optional_ref<const int> { i2 }));
+  CHECK (ih (gch::optional_ref<int> { i1 }) == std::hash<int> { } (5));
+
+#if defined (__cpp_lib_generic_unordered_lookup) && __cpp_lib_generic_unordered_lookup >= 201811L
+  // Heterogeneous lookup, with a key of another value type.
+  std::unordered_set<gch::optional_ref<int>,
+                     gch::identity_first_hash<>,
+                     gch::identity_first_equal> ints { gch::optional_ref<int> { i1 } };
+  CHECK (ints.find (gch::optional_ref<const int> { i2 }) != ints.end ());
+  CHECK (ints.contains (gch::optional_ref<const int> { i1 }));
+#endif
+
+  std::set<gch::optional_ref<counted>, gch::identity_first_less> ordered { rc, ra, rb, n };
+  CHECK (ordered.size () == 3);
+  CHECK (! ordered.begin ()->has_value ());
+
+  return 0;
+}
@@ -0,0 +1,136 @@
+/** test-maybe_invoke_all.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/optional_ref.hpp"
+
+struct sum
+{
+  int
+  operator() (int a, long b, int c) const noexcept
+  {
+    return a + static_cast<int> (b) + c;
+  }
+};
+
+struct pick_first
+{
+  int&
+  operator() (int& a, int&) const noexcept
+  {
+    return a;
+  }
+};
+
+struct twice
+{
+  constexpr
+  int
+  operator() (int x) const noexcept
+  {
+    return 2 * x;
+  }
+};
+
+struct no_default
+{
+  explicit
+  no_default (int) noexcept
+  { }
+};
+
+struct make_no_default
+{
+  no_default
+  operator() (int&) const noexcept
+  {
+    return no_default { 0 };
+  }
+};
+
+struct add
+{
+  constexpr
+  int
+  operator() (const int& x, const int& y) const noexcept
+  {
+    return x + y;
+  }
+};
+
+static constexpr int four = 4;
+static constexpr int five = 5;
+
+#ifdef GCH_HAS_CPP14_CONSTEXPR
+
+static_assert (gch::maybe_invoke_all (add { }, gch::optional_ref<const int> { four },
+                                      gch::optional_ref<const int> { five }) == 9, "");
+static_assert (gch::maybe_invoke_all (add { }, gch::optional_ref<const int> { four },
+                                      gch::optional_ref<const int> { }) == 0, "");
+static_assert (gch::maybe_invoke_any (twice { }, gch::optional_ref<const int> { },
+                                      gch::optional_ref<const int> { five }) == 10, "");
+
+#endif
+
+static_assert (std::is_same<gch::maybe_invoke_all_result_t<sum, int, long, int>, int>::value, "");
+static_assert (std::is_same<gch::maybe_invoke_all_result_t<pick_first, int, int>,
+                            gch::optional_ref<int>>::value, "");
+static_assert (std::is_same<gch::maybe_invoke_any_result_t<twice, int, const int, long>,
+                            int>::value, "");
+
+template <typename Functor, typename T, typename Enable = void>
+struct has_all_result
+  : std::false_type
+{ };
+
+template <typename Functor, typename T>
+struct has_all_result<Functor, T,
+                      decltype (static_cast<void> (gch::maybe_invoke_all_result_t<Functor, T> { }))>
+  : std::true_type
+{ };
+
+static_assert (! has_all_result<make_no_default, int>::value, "");
+static_assert (! has_all_result<sum, int>::value, "");
+
+int
+main (void)
+{
+  int  a = 1;
+  long b = 2;
+  int  c = 3;
+
+  gch::optional_ref<int>  ra { a };
+  gch::optional_ref<long> rb { b };
+  gch::optional_ref<int>  rc { c };
+  gch::optional_ref<int>  none;
+
+  CHECK (gch::maybe_invoke_all (sum { }, ra, rb, rc) == 6);
+  CHECK (gch::maybe_invoke_all (sum { }, ra, rb, none) == 0);
+  static_assert (noexcept (gch::maybe_invoke_all (sum { }, ra, rb, rc)), "");
+
+  CHECK (gch::maybe_invoke_all (pick_first { }, ra, rc).refers_to (a));
+  CHECK (! gch::maybe_invoke_all (pick_first { }, none, rc).has_value ());
+
+  int calls = 0;
+  auto count = [&calls] (int&, int&) noexcept { ++calls; };
+  gch::maybe_invoke_all (count, ra, rc);
+  gch::maybe_invoke_all (count, none, rc);
+  CHECK (calls == 1);
+
+  CHECK (gch::maybe_invoke_any (twice { }, none, rc, ra) == 6);
+  CHECK (gch::maybe_invoke_any (twice { }, ra, rc) == 2);
+  CHECK (gch::maybe_invoke_any (twice { }, none, gch::optional_ref<const int> { }) == 0);
+
+  int seen = 0;
+  auto record = [&seen] (int& x) noexcept { seen = x; };
+  gch::maybe_invoke_any (record, none, rc);
+  CHECK (seen == 3);
+  gch::maybe_invoke_any (record, none);
+  CHECK (seen == 3);
+
+  return 0;
+}
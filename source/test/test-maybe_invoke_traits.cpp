@@ -0,0 +1,147 @@
+/** test-maybe_invoke_traits.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+
+struct test_struct
+{
+  int
+  f (void) const noexcept
+  {
+    return 1;
+  }
+
+  int&
+  g (int)
+  {
+    return m;
+  }
+
+  void
+  h (void) { }
+
+  int m = 2;
+};
+
+struct no_default
+{
+  explicit no_default (int) { }
+};
+
+struct value_functor
+{
+  int
+  operator() (test_struct& s) const noexcept
+  {
+    return s.m;
+  }
+};
+
+struct ref_functor
+{
+  const int&
+  operator() (const test_struct& s, int) const noexcept
+  {
+    return s.m;
+  }
+};
+
+struct throwing_functor
+{
+  int
+  operator() (test_struct&) const;
+};
+
+struct rvalue_functor
+{
+  int&&
+  operator() (test_struct&) const;
+};
+
+struct no_default_functor
+{
+  no_default
+  operator() (test_struct&) const;
+};
+
+using opt  = gch::optional_ref<test_struct>;
+using copt = gch::optional_ref<const test_struct>;
+
+// Result mapping.
+static_assert (std::is_same<gch::maybe_invoke_result_t<opt, value_functor>, int>::value, "");
+static_assert (std::is_same<gch::maybe_invoke_result_t<opt, ref_functor, int>,
+                       gch::optional_ref<const int>>::value, "");
+static_assert (std::is_same<gch::maybe_invoke_result_t<opt, rvalue_functor>, void>::value, "");
+static_assert (std::is_same<gch::maybe_invoke_result_t<opt, int (test_struct::*) (void) const noexcept>,
+                       int>::value, "");
+static_assert (std::is_same<gch::maybe_invoke_result_t<opt, int& (test_struct::*) (int), long>,
+                       gch::optional_ref<int>>::value, "");
+static_assert (std::is_same<gch::maybe_invoke_result_t<opt, void (test_struct::*) (void)>,
+                       void>::value, "");
+static_assert (std::is_same<gch::maybe_invoke_result_t<opt, int test_struct::*>,
+                       gch::optional_ref<int>>::value, "");
+static_assert (std::is_same<gch::maybe_invoke_result_t<copt, int test_struct::*>,
+                       gch::optional_ref<const int>>::value, "");
+
+// Invocability.
+static_assert (  gch::is_maybe_invocable<opt,  value_functor>::value, "");
+static_assert (! gch::is_maybe_invocable<copt, value_functor>::value, "");
+static_assert (! gch::is_maybe_invocable<opt,  value_functor, int>::value, "");
+static_assert (! gch::is_maybe_invocable<opt,  no_default_functor>::value, "");
+static_assert (! gch::is_maybe_invocable<copt, void (test_struct::*) (void)>::value, "");
+static_assert (! gch::is_maybe_invocable<opt,  int test_struct::*, int>::value, "");
+static_assert (  gch::is_maybe_invocable<copt, ref_functor, int>::value, "");
+
+// Nothrow.
+static_assert (  gch::is_nothrow_maybe_invocable<opt, value_functor>::value, "");
+static_assert (! gch::is_nothrow_maybe_invocable<opt, throwing_functor>::value, "");
+static_assert (! gch::is_nothrow_maybe_invocable<opt, no_default_functor>::value, "");
+static_assert (  gch::is_nothrow_maybe_invocable<opt, int test_struct::*>::value, "");
+#ifdef GCH_TYPESYSTEM_NOEXCEPT
+static_assert (  gch::is_nothrow_maybe_invocable<opt,
+                   int (test_struct::*) (void) const noexcept>::value, "");
+#endif
+
+// cvref-qualified optionals are treated the same as the unqualified type.
+static_assert (std::is_same<gch::maybe_invoke_result_t<opt&,        value_functor>, int>::value, "");
+static_assert (std::is_same<gch::maybe_invoke_result_t<const opt&,  value_functor>, int>::value, "");
+static_assert (std::is_same<gch::maybe_invoke_result_t<opt&&,       value_functor>, int>::value, "");
+static_assert (std::is_same<gch::maybe_invoke_result_t<const opt&&, value_functor>, int>::value, "");
+static_assert (gch::is_maybe_invocable<opt&,        value_functor>::value, "");
+static_assert (gch::is_maybe_invocable<const opt&,  value_functor>::value, "");
+static_assert (gch::is_maybe_invocable<opt&&,       value_functor>::value, "");
+static_assert (gch::is_maybe_invocable<const opt&&, value_functor>::value, "");
+static_assert (gch::is_nothrow_maybe_invocable<opt&,        value_functor>::value, "");
+static_assert (gch::is_nothrow_maybe_invocable<const opt&,  value_functor>::value, "");
+static_assert (gch::is_nothrow_maybe_invocable<opt&&,       value_functor>::value, "");
+static_assert (gch::is_nothrow_maybe_invocable<const opt&&, value_functor>::value, "");
+
+int
+main (void)
+{
+  test_struct ts;
+  opt o { ts };
+  opt n;
+
+  static_assert (noexcept (gch::maybe_invoke (o, value_functor { })), "");
+  static_assert (! noexcept (gch::maybe_invoke (o, throwing_functor { })), "");
+
+  CHECK (gch::maybe_invoke (o, value_functor { }) == 2);
+  CHECK (gch::maybe_invoke (n, value_functor { }) == 0);
+
+  CHECK (gch::maybe_invoke (o, ref_functor { }, 0).refers_to (ts.m));
+  CHECK (! gch::maybe_invoke (n, ref_functor { }, 0).has_value ());
+
+  CHECK (gch::maybe_invoke (o, &test_struct::g, 3).refers_to (ts.m));
+  CHECK (gch::maybe_invoke (o, &test_struct::m).refers_to (ts.m));
+  CHECK (! gch::maybe_invoke (n, &test_struct::m).has_value ());
+
+  gch::maybe_invoke (o, &test_struct::h);
+  gch::maybe_invoke (n, &test_struct::h);
+
+  return 0;
+}
@@ -0,0 +1,127 @@
+/** test-monadic-members.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/optional_ref.hpp"
+
+struct node
+{
+  int   value;
+  node *next;
+};
+
+struct get_next
+{
+  constexpr
+  gch::optional_ref<const node>
+  operator() (const node& n) const noexcept
+  {
+    return n.next;
+  }
+};
+
+struct get_value
+{
+  constexpr
+  const int&
+  operator() (const node& n) const noexcept
+  {
+    return n.value;
+  }
+};
+
+struct double_value
+{
+  constexpr
+  int
+  operator() (const node& n) const noexcept
+  {
+    return 2 * n.value;
+  }
+};
+
+static constexpr node tail { 2, nullptr };
+
+struct get_tail
+{
+  constexpr
+  const node&
+  operator() (void) const noexcept
+  {
+    return tail;
+  }
+};
+
+static_assert (gch::optional_ref<const node> { tail }.transform (get_value { }).refers_to (
+                 tail.value), "");
+static_assert (! gch::optional_ref<const node> { }.and_then (get_next { }).has_value (), "");
+static_assert (gch::optional_ref<const node> { }.or_else (get_tail { }).refers_to (tail), "");
+static_assert (&gch::optional_ref<const node> { }.value_or_else (get_tail { }) == &tail, "");
+static_assert (*gch::optional_ref<const node> { tail }.transform (double_value { }) == 4, "");
+static_assert (gch::optional_ref<const node> { }.transform (double_value { }).value_or (-1) == -1,
+               "");
+
+int
+main (void)
+{
+  node second { 2, nullptr };
+  node first  { 1, &second };
+
+  gch::optional_ref<const node> r { first };
+  gch::optional_ref<const node> none;
+
+  CHECK (r.and_then (get_next { }).refers_to (second));
+  CHECK (! r.and_then (get_next { }).and_then (get_next { }).has_value ());
+  CHECK (! none.and_then (get_next { }).has_value ());
+
+  CHECK (r.transform (get_value { }).refers_to (first.value));
+  CHECK (! none.transform (get_value { }).has_value ());
+
+  CHECK (none.or_else ([&second] (void) noexcept { return &second; }).refers_to (second));
+  CHECK (r.or_else ([] (void) noexcept { return gch::nullopt; }).refers_to (first));
+
+  int calls = 0;
+  auto fallback = [&calls, &second] (void) noexcept -> const node& {
+    ++calls;
+    return second;
+  };
+  CHECK (&r.value_or_else (fallback) == &first);
+  CHECK (calls == 0);
+  CHECK (&none.value_or_else (fallback) == &second);
+  CHECK (calls == 1);
+
+  gch::optional_ref<int> ri { first.next->value };
+  gch::optional_ref<int> ni;
+  auto seven = [] (void) noexcept { return 7; };
+  CHECK (ri.value_or_else (seven) == 2);
+  CHECK (ni.value_or_else (seven) == 7);
+  static_assert (std::is_same<decltype (ni.value_or_else (seven)), int>::value, "");
+
+  // Object results are wrapped lazily, and the function is only invoked on access.
+  auto lazy = r.transform (double_value { });
+  static_assert (std::is_same<decltype (lazy)::value_type, int>::value, "");
+  CHECK (lazy.has_value () && *lazy == 2 && lazy.value () == 2);
+  CHECK (! none.transform (double_value { }).has_value ());
+  CHECK (none.transform (double_value { }).value_or (5) == 5);
+
+  int transforms = 0;
+  auto counted = r.transform ([&transforms] (const node& n) noexcept {
+    ++transforms;
+    return n.value + 1;
+  });
+  CHECK (transforms == 0);
+  CHECK (counted.value_or (0) == 2);
+  CHECK (transforms == 1);
+
+#if defined (__cpp_lib_optional) && __cpp_lib_optional >= 201606L
+  std::optional<int> doubled = gch::transform (r, double_value { });
+  CHECK (doubled.has_value () && *doubled == 2);
+  CHECK (! gch::transform (none, double_value { }).has_value ());
+#endif
+
+  return 0;
+}
@@ -0,0 +1,108 @@
+/** test-optional_function_ref.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/optional_ref/optional_function_ref.hpp"
+
+static
+int
+twice (int x)
+{
+  return 2 * x;
+}
+
+struct accumulator
+{
+  int
+  operator() (int x)
+  {
+    return total += x;
+  }
+
+  int total = 0;
+};
+
+struct selector
+{
+  int&
+  operator() (bool first) noexcept
+  {
+    return first ? a : b;
+  }
+
+  int a = 1;
+  int b = 2;
+};
+
+using int_ref = gch::optional_function_ref<int (int)>;
+
+static_assert (sizeof (int_ref) == 2 * sizeof (void *), "");
+static_assert (std::is_trivially_copyable<int_ref>::value, "");
+static_assert (! std::is_constructible<int_ref, accumulator&&>::value, "");
+static_assert (! std::is_constructible<int_ref, void (*) (void)>::value, "");
+static_assert (std::is_constructible<gch::optional_function_ref<long (short)>, int (*) (int)>::value,
+               "");
+
+int
+main (void)
+{
+  int_ref f { twice };
+  int_ref g { &twice };
+  CHECK (f.has_value () && f (3) == 6);
+  CHECK (g (4) == 8);
+  CHECK (f.value (5) == 10);
+
+  accumulator acc;
+  int_ref h { acc };
+  h (2);
+  h (3);
+  CHECK (acc.total == 5);
+
+  int_ref n;
+  CHECK (! n.has_value ());
+  CHECK (n == gch::nullopt);
+  CHECK (gch::nullopt != f);
+  CHECK (n.invoke_or (-1, 3) == -1);
+  CHECK (f.invoke_or (-1, 3) == 6);
+
+  int (*null_fn) (int) = nullptr;
+  CHECK (! int_ref { null_fn }.has_value ());
+  CHECK (! int_ref { nullptr }.has_value ());
+
+  gch::optional_ref<accumulator> acc_ref { acc };
+  int_ref from_ref { acc_ref };
+  CHECK (from_ref (1) == 6);
+  CHECK (! int_ref { gch::optional_ref<accumulator> { } }.has_value ());
+
+  CHECK (gch::maybe_invoke (f, 7) == 14);
+  CHECK (gch::maybe_invoke (n, 7) == 0);
+
+  selector sel;
+  gch::optional_function_ref<int& (bool)> s { sel };
+  CHECK (gch::maybe_invoke (s, true).refers_to (sel.a));
+  CHECK (! gch::maybe_invoke (gch::optional_function_ref<int& (bool)> { }, true).has_value ());
+
+  int calls = 0;
+  auto bump = [&calls] (void) { ++calls; };
+  gch::optional_function_ref<void (void)> v { bump };
+  gch::maybe_invoke (v);
+  gch::maybe_invoke (gch::optional_function_ref<void (void)> { });
+  CHECK (calls == 1);
+
+#ifdef GCH_TYPESYSTEM_NOEXCEPT
+  gch::optional_function_ref<int& (bool) noexcept> ns { sel };
+  static_assert (noexcept (ns (true)), "");
+  static_assert (! std::is_constructible<gch::optional_function_ref<int (int) noexcept>,
+                                         accumulator&>::value, "");
+  CHECK (&ns (false) == &sel.b);
+#endif
+
+  h.reset ();
+  CHECK (! h.has_value ());
+
+  return 0;
+}
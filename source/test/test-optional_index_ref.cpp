@@ -0,0 +1,88 @@
+/** test-optional_index_ref.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/optional_ref/optional_index_ref.hpp"
+
+#include <vector>
+
+struct test_struct
+{
+  int
+  get (void) const noexcept
+  {
+    return m;
+  }
+
+  int m;
+};
+
+using index_ref  = gch::optional_index_ref<std::vector<test_struct>>;
+using cindex_ref = gch::optional_index_ref<const std::vector<test_struct>>;
+
+static_assert (sizeof (index_ref) == sizeof (std::uint32_t), "");
+static_assert (sizeof (gch::optional_index_ref<std::vector<int>, std::uint16_t>) == 2, "");
+static_assert (std::is_same<index_ref::value_type, test_struct>::value, "");
+static_assert (std::is_same<cindex_ref::value_type, const test_struct>::value, "");
+static_assert (std::is_trivially_copyable<index_ref>::value, "");
+
+int
+main (void)
+{
+  std::vector<test_struct> v { { 1 }, { 2 } };
+
+  index_ref r { 1 };
+  index_ref n;
+  CHECK (r.has_value () && r.has_value (v));
+  CHECK (! n.has_value () && ! n.has_value (v));
+  CHECK (n == gch::nullopt);
+  CHECK (gch::nullopt != r);
+  CHECK (r.value (v).m == 2);
+
+  // References stay valid through reallocation.
+  for (int i = 0; i < 100; ++i)
+    v.push_back ({ i });
+  CHECK (r.value (v).m == 2);
+  CHECK (r.get (v).refers_to (v[1]));
+  CHECK (! n.get (v).has_value ());
+
+  test_struct fallback { 7 };
+  CHECK (r.value_or (v, fallback).m == 2);
+  CHECK (n.value_or (v, fallback).m == 7);
+
+  // Indices past the end are treated as empty.
+  index_ref far { 500 };
+  CHECK (far.has_value ());
+  CHECK (! far.has_value (v));
+  CHECK (far.get_pointer (v) == nullptr);
+
+  CHECK (gch::maybe_invoke (r, v, &test_struct::get) == 2);
+  CHECK (gch::maybe_invoke (n, v, &test_struct::get) == 0);
+  CHECK (gch::maybe_invoke (r, v, &test_struct::m).refers_to (v[1].m));
+
+  const std::vector<test_struct>& cv = v;
+  cindex_ref cr = r;
+  CHECK (cr.value (cv).m == 2);
+  CHECK (cr == r);
+
+  // Empty references are ordered first.
+  CHECK (n < r);
+  CHECK (r < far);
+  CHECK (! (r < r));
+  CHECK (r <= r && r >= r);
+  CHECK (far > n);
+
+  std::hash<index_ref> h;
+  CHECK (h (r) == h (index_ref { 1 }));
+
+  r.reset ();
+  CHECK (r == n);
+  r.emplace (0);
+  CHECK (r.value (v).m == 1);
+
+  return 0;
+}
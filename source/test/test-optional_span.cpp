@@ -0,0 +1,141 @@
+/** test-optional_span.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/optional_ref/optional_span.hpp"
+
+#include <vector>
+
+static_assert (std::is_trivially_copyable<gch::optional_span<int>>::value, "");
+static_assert (sizeof (gch::optional_span<int>) == 2 * sizeof (void *), "");
+static_assert (sizeof (gch::optional_span<int, 4>) == sizeof (void *), "");
+static_assert (gch::optional_span<int>::extent == gch::dynamic_extent, "");
+static_assert (gch::optional_span<float, 8, 32>::alignment == 32, "");
+
+// Over-aligned spans are only constructed explicitly from unchecked sources.
+static_assert (std::is_convertible<float (&)[8], gch::optional_span<float, 8>>::value, "");
+static_assert (! std::is_convertible<float (&)[8], gch::optional_span<float, 8, 32>>::value, "");
+static_assert (std::is_constructible<gch::optional_span<float, 8, 32>, float (&)[8]>::value, "");
+static_assert (! std::is_convertible<std::vector<float>&,
+                                     gch::optional_span<float, gch::dynamic_extent, 32>>::value,
+               "");
+
+// A 16-byte element with an alignment of 4.
+struct quad
+{
+  float v[4];
+};
+
+static_assert (gch::optional_span<float, 8, 32>::element_span_type::alignment == alignof (float),
+               "");
+static_assert (gch::optional_span<quad, gch::dynamic_extent, 64>::element_span_type::alignment
+               == 16, "");
+static_assert (gch::optional_span<quad>::element_span_type::alignment == alignof (quad), "");
+
+// The size of a span with a static extent is checked against the extent.
+static constexpr int four[4] = { 1, 2, 3, 4 };
+static_assert (gch::optional_span<const int, 4> (four, 4).size () == 4, "");
+static_assert (! gch::optional_span<const int, 4> (nullptr, 0).has_value (), "");
+
+struct sum_functor
+{
+  int
+  operator() (gch::optional_span<const int>::span_type s, int init) const noexcept
+  {
+    for (int x : s)
+      init += x;
+    return init;
+  }
+};
+
+struct front_functor
+{
+  const int&
+  operator() (gch::optional_span<const int>::span_type s) const noexcept
+  {
+    return s[0];
+  }
+};
+
+int
+main (void)
+{
+  int arr[4] = { 1, 2, 3, 4 };
+
+  gch::optional_span<int> s { arr };
+  gch::optional_span<int> n;
+  CHECK (s.has_value () && s.size () == 4);
+  CHECK (! n.has_value () && n.size () == 0 && n.empty ());
+  CHECK (n == gch::nullopt);
+  CHECK (gch::nullopt != s);
+  CHECK (s[2] == 3);
+  CHECK (s.size_bytes () == sizeof (arr));
+
+  int total = 0;
+  for (int x : s)
+    total += x;
+  CHECK (total == 10);
+
+  CHECK (s.value ().size () == 4);
+  CHECK (n.value_or (s.value ()).size () == 4);
+
+  gch::optional_span<const int> cs = s;
+  CHECK (gch::maybe_invoke (cs, sum_functor { }, 5) == 15);
+  CHECK (gch::maybe_invoke (gch::optional_span<const int> { }, sum_functor { }, 5) == 0);
+  CHECK (gch::maybe_invoke (cs, front_functor { }).refers_to (arr[0]));
+  CHECK (! gch::maybe_invoke (gch::optional_span<const int> { }, front_functor { }).has_value ());
+
+  gch::optional_span<int> sub = s.subspan (1, 2);
+  CHECK (sub.size () == 2 && sub[0] == 2);
+  CHECK (s.subspan (1).size () == 3);
+  CHECK (s.first (2).size () == 2);
+  CHECK (s.last (1)[0] == 4);
+  CHECK (! n.subspan (0).has_value ());
+  CHECK (! n.first (0).has_value ());
+
+  // An empty container still has a value.
+  std::vector<int> empty_vec;
+  gch::optional_span<int> e { empty_vec };
+  CHECK (e.has_value () && e.empty ());
+
+  std::vector<int> v { 5, 6 };
+  gch::optional_span<const int> vs { v };
+  CHECK (vs.size () == 2 && vs[1] == 6);
+
+  // Static extent and alignment.
+  alignas (32) float aligned[8] = { };
+  gch::optional_span<float, 8, 32> fixed { aligned };
+  gch::optional_span<float, gch::dynamic_extent, 16> weaker = fixed;
+  CHECK (weaker.size () == 8);
+  CHECK (fixed.first (4).size () == 4);
+  static_assert (decltype (fixed.first (4))::alignment == 32, "");
+  CHECK (fixed.last (3).get_pointer () == aligned + 5);
+  CHECK (fixed.subspan (2, 4).get_pointer () == aligned + 2);
+  static_assert (decltype (fixed.last (3))::alignment == alignof (float), "");
+
+  alignas (64) quad quads[4] = { };
+  gch::optional_span<quad, gch::dynamic_extent, 64> wide (quads, 4);
+  gch::optional_span<quad, gch::dynamic_extent, 16> tail = wide.subspan (1);
+  CHECK (tail.size () == 3 && tail.get_pointer () == quads + 1);
+
+  gch::optional_span<float, 8> unbound;
+  CHECK (unbound.size () == 0);
+
+  s.reset ();
+  CHECK (! s.has_value ());
+
+#if defined (__cpp_lib_span) && __cpp_lib_span >= 202002L
+  std::span<int> std_span = gch::optional_span<int> { arr };
+  CHECK (std_span.size () == 4);
+  std::span<int> empty_span = n;
+  CHECK (empty_span.empty ());
+  gch::optional_span<int> from_std { std_span };
+  CHECK (from_std.size () == 4);
+#endif
+
+  return 0;
+}
@@ -0,0 +1,190 @@
+/** test-partition_by_type.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/optional_ref/partition_by_type.hpp"
+
+#include <vector>
+
+enum class shape_kind : unsigned char
+{
+  circle,
+  square,
+  triangle,
+  line
+};
+
+struct shape
+{
+  explicit
+  shape (shape_kind k) noexcept
+    : kind (k)
+  { }
+
+  shape_kind kind;
+};
+
+struct circle
+  : shape
+{
+  circle (void) noexcept
+    : shape (shape_kind::circle)
+  { }
+
+  int radius = 1;
+};
+
+struct square
+  : shape
+{
+  square (void) noexcept
+    : shape (shape_kind::square)
+  { }
+
+  int side = 2;
+};
+
+struct polygon
+  : shape
+{
+  using shape::shape;
+};
+
+struct triangle
+  : polygon
+{
+  triangle (void) noexcept
+    : polygon (shape_kind::triangle)
+  { }
+};
+
+struct line
+  : shape
+{
+  line (void) noexcept
+    : shape (shape_kind::line)
+  { }
+
+  static
+  bool
+  classof (const shape& s) noexcept
+  {
+    return s.kind == shape_kind::line;
+  }
+};
+
+namespace gch
+{
+
+  template <>
+  struct cast_traits<circle>
+    : kind_range_cast_traits<shape_kind, shape_kind::circle>
+  { };
+
+  template <>
+  struct cast_traits<square>
+    : kind_range_cast_traits<shape_kind, shape_kind::square>
+  { };
+
+  template <>
+  struct cast_traits<polygon>
+    : kind_range_cast_traits<shape_kind, shape_kind::square, shape_kind::triangle>
+  { };
+
+}
+
+// Types tested by ranges of kinds are looked up in a table. Anything else is
+// cast to each type in turn.
+static_assert (gch::detail::partition_kind_table<shape, circle, square>::usable, "");
+static_assert (gch::detail::partition_kind_table<const shape, square, polygon>::usable, "");
+static_assert (! gch::detail::partition_kind_table<shape, circle, shape>::usable, "");
+static_assert (! gch::detail::partition_kind_table<shape, circle, line>::usable, "");
+static_assert (! gch::detail::partition_kind_table<shape>::usable, "");
+
+static_assert (std::is_same<gch::type_partition<shape, circle>::bucket_type<circle>,
+                            std::vector<gch::optional_ref<circle>>>::value, "");
+static_assert (std::is_same<gch::type_partition<const shape, circle>::bucket_type<circle>,
+                            std::vector<gch::optional_ref<const circle>>>::value, "");
+
+int
+main (void)
+{
+  circle   c0;
+  circle   c1;
+  square   s0;
+  triangle t0;
+
+  using ref = gch::optional_ref<shape>;
+  std::vector<ref> shapes { ref { c0 }, ref { s0 }, ref { }, ref { t0 }, ref { c1 }, ref { } };
+
+  auto parts = gch::partition_by_type<circle, square> (shapes);
+  CHECK (parts.bucket<circle> ().size () == 2);
+  CHECK (parts.bucket<circle> ()[0].refers_to (c0));
+  CHECK (parts.bucket<circle> ()[1].refers_to (c1));
+  CHECK (parts.bucket<square> ().size () == 1);
+  CHECK (parts.bucket<square> ()[0]->side == 2);
+  CHECK (parts.unmatched ().size () == 1);
+  CHECK (parts.unmatched ()[0].refers_to (t0));
+
+  int total = 0;
+  for (gch::optional_ref<circle> c : parts.bucket<circle> ())
+    total += c->radius;
+  CHECK (total == 2);
+
+  // Reuse the buckets.
+  parts.partition (shapes.begin (), shapes.begin () + 2);
+  CHECK (parts.bucket<circle> ().size () == 1);
+  CHECK (parts.bucket<square> ().size () == 1);
+  CHECK (parts.unmatched ().empty ());
+
+  parts.clear ();
+  CHECK (parts.bucket<circle> ().empty () && parts.unmatched ().empty ());
+
+  // Const referents.
+  using cref = gch::optional_ref<const shape>;
+  const std::vector<cref> const_shapes { cref { c0 }, cref { t0 } };
+  auto const_parts = gch::partition_by_type<square, circle> (const_shapes.begin (),
+                                                             const_shapes.end ());
+  CHECK (const_parts.bucket<circle> ().size () == 1);
+  CHECK (const_parts.bucket<square> ().empty ());
+  CHECK (const_parts.unmatched ().size () == 1);
+
+  // The first matching type wins. Upcasts always succeed.
+  auto upcast_parts = gch::partition_by_type<circle, shape> (shapes);
+  CHECK (upcast_parts.bucket<circle> ().size () == 2);
+  CHECK (upcast_parts.bucket<shape> ().size () == 2);
+  CHECK (upcast_parts.unmatched ().empty ());
+
+  // Overlapping ranges. The first matching type wins, and kinds outside
+  // every range are unmatched.
+  line l0;
+  std::vector<ref> mixed { ref { s0 }, ref { l0 }, ref { t0 }, ref { c0 } };
+  auto range_parts = gch::partition_by_type<square, polygon> (mixed);
+  CHECK (range_parts.bucket<square> ().size () == 1);
+  CHECK (range_parts.bucket<square> ()[0].refers_to (s0));
+  CHECK (range_parts.bucket<polygon> ().size () == 1);
+  CHECK (range_parts.bucket<polygon> ()[0].refers_to (t0));
+  CHECK (range_parts.unmatched ().size () == 2);
+  CHECK (range_parts.unmatched ()[0].refers_to (l0));
+
+  auto polygon_parts = gch::partition_by_type<polygon, square> (mixed);
+  CHECK (polygon_parts.bucket<polygon> ().size () == 2);
+  CHECK (polygon_parts.bucket<square> ().empty ());
+
+  // A type without a range of kinds falls back to casting.
+  auto line_parts = gch::partition_by_type<circle, line> (mixed);
+  CHECK (line_parts.bucket<circle> ().size () == 1);
+  CHECK (line_parts.bucket<line> ().size () == 1);
+  CHECK (line_parts.bucket<line> ()[0].refers_to (l0));
+  CHECK (line_parts.unmatched ().size () == 2);
+
+  // No types at all.
+  auto none = gch::partition_by_type<> (shapes);
+  CHECK (none.unmatched ().size () == 4);
+
+  return 0;
+}
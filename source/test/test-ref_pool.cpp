@@ -0,0 +1,143 @@
+/** test-ref_pool.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/optional_ref/ref_pool.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+struct counted
+{
+  explicit
+  counted (int v) noexcept
+    : value (v)
+  {
+    ++live;
+  }
+
+  ~counted (void)
+  {
+    --live;
+  }
+
+  counted (const counted&) = delete;
+  counted& operator= (const counted&) = delete;
+
+  int value;
+
+  static int live;
+};
+
+int counted::live = 0;
+
+#ifdef GCH_EXCEPTIONS
+
+struct throwing
+{
+  explicit
+  throwing (bool should_throw)
+  {
+    if (should_throw)
+      throw 1;
+  }
+};
+
+#endif
+
+int
+main (void)
+{
+  {
+    gch::ref_pool<counted> pool (3);
+    CHECK (pool.capacity () == 3);
+
+    gch::optional_ref<counted> a = pool.try_acquire (1);
+    gch::optional_ref<counted> b = pool.try_acquire (2);
+    gch::optional_ref<counted> c = pool.try_acquire (3);
+    CHECK (a.has_value () && b.has_value () && c.has_value ());
+    CHECK (a->value == 1 && b->value == 2 && c->value == 3);
+    CHECK (counted::live == 3);
+    CHECK (! pool.try_acquire (4).has_value ());
+    CHECK (pool.owns (*b));
+
+    counted outside (0);
+    CHECK (! pool.owns (outside));
+
+    // The most recently released slot is reused first.
+    pool.release (*b);
+    CHECK (counted::live == 3);
+    gch::optional_ref<counted> d = pool.try_acquire (5);
+    CHECK (d.get_pointer () == b.get_pointer () && d->value == 5);
+
+    pool.release (*a);
+    pool.release (*c);
+    pool.release (*d);
+    CHECK (counted::live == 1);
+  }
+
+  {
+    gch::ref_pool<counted> pool (40);
+    std::vector<gch::optional_ref<counted>> objects;
+    {
+      gch::ref_pool_cache<counted, 8> cache (pool);
+      for (int i = 0; i < 40; ++i)
+        objects.push_back (cache.try_acquire (i));
+      CHECK (objects.back ().has_value () && objects.back ()->value == 39);
+      CHECK (! cache.try_acquire (40).has_value ());
+      CHECK (cache.size () == 0);
+
+      // Releasing past the size of the cache flushes half of it to the pool.
+      for (int i = 0; i < 9; ++i)
+        cache.release (*objects[static_cast<std::size_t> (i)]);
+      CHECK (cache.size () == 5);
+      CHECK (pool.try_acquire (100).has_value ());
+      CHECK (counted::live == 32);
+    }
+
+    // The destructor of the cache returned its slots.
+    gch::ref_pool_cache<counted> other (pool);
+    int acquired = 0;
+    while (other.try_acquire (0))
+      ++acquired;
+    CHECK (acquired == 8);
+  }
+
+  gch::ref_pool<int> empty (0);
+  CHECK (! empty.try_acquire (0).has_value ());
+
+#ifdef GCH_EXCEPTIONS
+  // A slot is freed again if the constructor throws.
+  gch::ref_pool<throwing> pool (1);
+  bool caught = false;
+  try
+  {
+    (void)pool.try_acquire (true);
+  }
+  catch (int)
+  {
+    caught = true;
+  }
+  CHECK (caught);
+  CHECK (pool.try_acquire (false).has_value ());
+
+  // A capacity whose indices do not fit is rejected before allocating.
+  bool rejected = false;
+  try
+  {
+    gch::ref_pool<int> huge (gch::ref_pool<int>::size_type { UINT32_MAX });
+  }
+  catch (const std::length_error&)
+  {
+    rejected = true;
+  }
+  CHECK (rejected);
+#endif
+
+  return 0;
+}
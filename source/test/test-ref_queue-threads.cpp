@@ -0,0 +1,152 @@
+/** test-ref_queue-threads.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/optional_ref/ref_queue.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// The number of values pushed by each producer. The queues are much smaller,
+// so the producers and consumers wrap around them many times.
+static constexpr std::size_t per_producer = 20000;
+
+// Pushes `values[first, first + count)`, alternating between single pushes
+// and batches, until all of them have been pushed.
+template <typename Queue>
+static
+void
+produce (Queue& q, std::vector<int>& values, std::size_t first, std::size_t count)
+{
+  std::vector<gch::optional_ref<int>> batch;
+  std::size_t next = first;
+  std::size_t last = first + count;
+  while (next < last)
+  {
+    if ((next / 7) % 2 == 0)
+    {
+      if (q.try_push (values[next]))
+        ++next;
+      else
+        std::this_thread::yield ();
+      continue;
+    }
+
+    batch.clear ();
+    for (std::size_t i = next; i < last && batch.size () < 5; ++i)
+      batch.emplace_back (values[i]);
+
+    std::size_t pushed = q.push_n (batch.begin (), batch.size ());
+    if (pushed == 0)
+      std::this_thread::yield ();
+    next += pushed;
+  }
+}
+
+// Pops until `remaining` reaches zero, and counts each value in `seen`.
+template <typename Queue>
+static
+void
+consume (Queue& q, std::vector<int>& values, std::vector<std::atomic<int>>& seen,
+         std::atomic<int>& remaining, std::vector<int> *order)
+{
+  gch::optional_ref<int> out[3];
+  bool batch = false;
+  while (remaining.load (std::memory_order_relaxed) > 0)
+  {
+    std::size_t popped;
+    if (batch)
+      popped = q.pop_n (out, 3);
+    else
+    {
+      out[0] = q.try_pop ();
+      popped = out[0].has_value () ? 1 : 0;
+    }
+    batch = ! batch;
+
+    if (popped == 0)
+    {
+      std::this_thread::yield ();
+      continue;
+    }
+
+    for (std::size_t i = 0; i < popped; ++i)
+    {
+      std::size_t index = static_cast<std::size_t> (out[i].get_pointer () - values.data ());
+      seen[index].fetch_add (1, std::memory_order_relaxed);
+      if (order != nullptr)
+        order->push_back (*out[i]);
+    }
+    remaining.fetch_sub (static_cast<int> (popped), std::memory_order_relaxed);
+  }
+}
+
+template <typename Queue>
+static
+int
+test_threads (std::size_t producers, std::size_t consumers, bool check_order)
+{
+  std::size_t total = producers * per_producer;
+  std::vector<int> values (total);
+  for (std::size_t i = 0; i < total; ++i)
+    values[i] = static_cast<int> (i);
+
+  std::vector<std::atomic<int>> seen (values.size ());
+  for (std::atomic<int>& s : seen)
+    s.store (0, std::memory_order_relaxed);
+
+  std::atomic<int> remaining (static_cast<int> (total));
+  std::vector<int> order;
+
+  Queue q (8);
+  std::vector<std::thread> threads;
+  for (std::size_t p = 0; p < producers; ++p)
+  {
+    threads.emplace_back (produce<Queue>, std::ref (q), std::ref (values),
+                          p * per_producer, per_producer);
+  }
+  for (std::size_t c = 0; c < consumers; ++c)
+  {
+    threads.emplace_back (consume<Queue>, std::ref (q), std::ref (values), std::ref (seen),
+                          std::ref (remaining), check_order ? &order : nullptr);
+  }
+  for (std::thread& t : threads)
+    t.join ();
+
+  // Every value is popped exactly once.
+  bool exactly_once = true;
+  for (const std::atomic<int>& s : seen)
+    exactly_once = exactly_once && s.load (std::memory_order_relaxed) == 1;
+  CHECK (exactly_once);
+  CHECK (! q.try_pop ().has_value ());
+
+  if (check_order)
+  {
+    bool in_order = order.size () == values.size ();
+    for (std::size_t i = 0; in_order && i < order.size (); ++i)
+      in_order = order[i] == static_cast<int> (i);
+    CHECK (in_order);
+  }
+  return 0;
+}
+
+int
+main (void)
+{
+  if (int result = test_threads<gch::ref_spsc_queue<int>> (1, 1, true))
+    return result;
+  if (int result = test_threads<gch::ref_mpmc_queue<int>> (2, 2, false))
+    return result;
+  if (int result = test_threads<gch::ref_mpmc_queue<int>> (1, 3, false))
+    return result;
+  if (int result = test_threads<gch::ref_mpmc_queue<int>> (3, 1, false))
+    return result;
+  return 0;
+}
@@ -0,0 +1,99 @@
+/** test-ref_queue.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/optional_ref/ref_queue.hpp"
+
+#include <vector>
+
+template <typename Queue>
+static
+int
+test_queue (void)
+{
+  int values[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+
+  Queue q (3);
+  CHECK (q.capacity () == 4);
+  CHECK (! q.try_pop ().has_value ());
+
+  CHECK (q.try_push (values[0]));
+  CHECK (q.try_push (gch::optional_ref<int> { values[1] }));
+  CHECK (! q.try_push (gch::optional_ref<int> { }));
+  CHECK (q.try_push (values[2]));
+  CHECK (q.try_push (values[3]));
+  CHECK (! q.try_push (values[4]));
+
+  CHECK (q.try_pop ().refers_to (values[0]));
+  CHECK (q.try_pop ().refers_to (values[1]));
+  CHECK (q.try_push (values[4]));
+
+  // The batches wrap around the end of the slots.
+  std::vector<gch::optional_ref<int>> out (8);
+  CHECK (q.pop_n (out.begin (), 8) == 3);
+  CHECK (out[0].refers_to (values[2]));
+  CHECK (out[1].refers_to (values[3]));
+  CHECK (out[2].refers_to (values[4]));
+  CHECK (q.pop_n (out.begin (), 8) == 0);
+
+  std::vector<gch::optional_ref<int>> in;
+  for (int& v : values)
+    in.emplace_back (v);
+
+  CHECK (q.push_n (in.begin (), 3) == 3);
+  CHECK (q.push_n (in.begin () + 3, 3) == 1);
+  CHECK (q.push_n (in.begin (), 1) == 0);
+
+  CHECK (q.try_pop ().refers_to (values[0]));
+  CHECK (q.push_n (in.begin () + 4, 0) == 0);
+  CHECK (q.push_n (in.begin () + 4, 4) == 1);
+  CHECK (q.pop_n (out.begin (), 2) == 2);
+  CHECK (out[0].refers_to (values[1]) && out[1].refers_to (values[2]));
+  CHECK (q.try_pop ().refers_to (values[3]));
+  CHECK (q.try_pop ().refers_to (values[4]));
+  CHECK (! q.try_pop ().has_value ());
+
+  // Pushing stops at an empty ref, which would otherwise mark its slot as
+  // never filled.
+  std::vector<gch::optional_ref<int>> gappy { in[0], gch::optional_ref<int> (), in[1] };
+  CHECK (q.push_n (gappy.begin (), 3) == 1);
+  CHECK (q.push_n (gappy.begin () + 1, 2) == 0);
+  CHECK (q.push_n (gappy.begin () + 2, 1) == 1);
+  CHECK (q.pop_n (out.begin (), 8) == 2);
+  CHECK (out[0].refers_to (values[0]) && out[1].refers_to (values[1]));
+  CHECK (! q.try_pop ().has_value ());
+
+  // Many laps.
+  bool ordered = true;
+  for (int lap = 0; lap < 100; ++lap)
+  {
+    int first = lap % 5;
+    CHECK (q.push_n (in.begin () + first, 3) == 3);
+    for (int i = 0; i < 3; ++i)
+      ordered = ordered && q.try_pop ().refers_to (values[first + i]);
+  }
+  CHECK (ordered);
+  return 0;
+}
+
+int
+main (void)
+{
+  if (int result = test_queue<gch::ref_spsc_queue<int>> ())
+    return result;
+  if (int result = test_queue<gch::ref_mpmc_queue<int>> ())
+    return result;
+
+  gch::ref_spsc_queue<const int> cq (0);
+  const int x = 1;
+  CHECK (cq.capacity () == 1);
+  CHECK (cq.try_push (x));
+  CHECK (! cq.try_push (x));
+  CHECK (cq.try_pop ().refers_to (x));
+
+  return 0;
+}
@@ -0,0 +1,128 @@
+/** test-static_ref_table.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/optional_ref/static_ref_table.hpp"
+
+#if defined (__cpp_constexpr) && __cpp_constexpr >= 201304L && __cplusplus >= 201402L
+
+struct descriptor
+{
+  const char *mnemonic;
+  int         operands;
+};
+
+enum class color
+{
+  red,
+  green,
+  blue
+};
+
+template <std::size_t N>
+constexpr
+gch::static_ref_table<unsigned, unsigned, N>
+make_squares (void)
+{
+  gch::static_ref_table_entry<unsigned, unsigned> entries[N] { };
+  for (unsigned i = 0; i < N; ++i)
+    entries[i] = { i * 7919U, i * i };
+  return gch::static_ref_table<unsigned, unsigned, N> (entries, std::make_index_sequence<N> { });
+}
+
+template <std::size_t N>
+bool
+check_squares (const gch::static_ref_table<unsigned, unsigned, N>& table)
+{
+  bool all_found = true;
+  for (unsigned i = 0; i < N; ++i)
+  {
+    gch::optional_cref<unsigned> v = table.find (i * 7919U);
+    all_found = all_found && v.has_value () && *v == i * i;
+  }
+  return all_found;
+}
+
+int
+main (void)
+{
+  static constexpr auto opcodes = gch::make_static_ref_table<int, descriptor> ({
+    { 0x01, { "nop", 0 } },
+    { 0x3C, { "cmp", 2 } },
+    { 0x74, { "je",  1 } },
+    { 0x90, { "xchg", 2 } },
+    { 0xC3, { "ret", 0 } },
+  });
+
+  static_assert (opcodes.size () == 5, "failed");
+  static_assert (opcodes.find (0x3C).has_value (), "failed");
+  static_assert (opcodes.find (0x3C)->operands == 2, "failed");
+  static_assert (opcodes.find (0x74).refers_to (opcodes.begin ()[2].value), "failed");
+  static_assert (! opcodes.find (0x02).has_value (), "failed");
+  static_assert (! opcodes.contains (-1), "failed");
+
+  static constexpr auto handlers = gch::make_static_ref_table<const char *, int> ({
+    { "open",  1 },
+    { "close", 2 },
+    { "read",  3 },
+    { "write", 4 },
+    { "seek",  5 },
+    { "stat",  6 },
+    { "",      7 },
+  });
+
+  static_assert (*handlers.find ("read") == 3, "failed");
+  static_assert (*handlers.find ("") == 7, "failed");
+  static_assert (! handlers.contains ("rea"), "failed");
+  static_assert (! handlers.contains ("reads"), "failed");
+
+  static constexpr auto colors = gch::make_static_ref_table<color, const char *> ({
+    { color::red,  "red"  },
+    { color::blue, "blue" },
+  });
+
+  static_assert (colors.contains (color::red), "failed");
+  static_assert (! colors.contains (color::green), "failed");
+
+  static constexpr auto single = gch::make_static_ref_table<long, long> ({ { 42, 7 } });
+  static_assert (*single.find (42) == 7, "failed");
+  static_assert (! single.contains (0), "failed");
+
+  // Every key of a larger table is found, and nothing else is.
+  static constexpr auto big = make_squares<200> ();
+  CHECK (check_squares (big));
+  CHECK (! big.contains (1));
+
+  // Tables of a few hundred keys, including a power of two, build within
+  // the default limits of the constant evaluator.
+  static constexpr auto pow2 = make_squares<512> ();
+  CHECK (check_squares (pow2));
+  CHECK (! pow2.contains (1));
+
+  static constexpr auto odd = make_squares<700> ();
+  CHECK (check_squares (odd));
+
+  // The lookups also work at run time with run-time keys.
+  volatile int op = 0xC3;
+  int key = op;
+  CHECK (opcodes.find (key)->operands == 0);
+
+  const char *name = "write";
+  CHECK (handlers.find (name).refers_to (handlers.begin ()[3].value));
+
+  return 0;
+}
+
+#else
+
+int
+main (void)
+{
+  return 0;
+}
+
+#endif
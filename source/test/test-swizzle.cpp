@@ -0,0 +1,132 @@
+/** test-swizzle.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/optional_ref/swizzle.hpp"
+
+#include <cstring>
+#include <vector>
+
+struct node
+{
+  int                     value;
+  gch::optional_ref<node> next;
+};
+
+struct node_image
+{
+  int                     value;
+  gch::swizzled_ref<node> next;
+};
+
+namespace gch
+{
+
+  template <>
+  struct swizzle_traits<node>
+  {
+    using image_type = node_image;
+
+    template <typename Fields>
+    static
+    void
+    fields (Fields&& f)
+    {
+      f (&node::value, &node_image::value);
+      f (&node::next,  &node_image::next);
+    }
+  };
+
+}
+
+static_assert (std::is_trivially_copyable<gch::swizzled_ref<node>>::value, "");
+static_assert (sizeof (gch::swizzled_ref<node>) == sizeof (std::uint64_t), "");
+
+int
+main (void)
+{
+  std::vector<node> graph (4);
+  for (std::size_t i = 0; i < graph.size (); ++i)
+    graph[i].value = static_cast<int> (i);
+
+  graph[0].next.emplace (graph[2]);
+  graph[2].next.emplace (graph[1]);
+  graph[1].next.emplace (graph[0]);
+
+  // Write the image.
+  std::vector<node_image> image;
+  for (const node& n : graph)
+    image.push_back ({ n.value, gch::swizzle (n.next, graph.data ()) });
+
+  CHECK (image[0].next.index () == 2);
+  CHECK (! image[3].next.has_value ());
+  CHECK (image[3].next.encoded () == 0);
+
+  std::vector<unsigned char> bytes (image.size () * sizeof (node_image));
+  std::memcpy (bytes.data (), image.data (), bytes.size ());
+
+  // Restore the graph from the image in one pass.
+  std::vector<node_image> loaded (image.size ());
+  std::memcpy (loaded.data (), bytes.data (), bytes.size ());
+
+  std::vector<node> restored (loaded.size ());
+  for (std::size_t i = 0; i < loaded.size (); ++i)
+  {
+    restored[i].value = loaded[i].value;
+    restored[i].next  = gch::unswizzle (loaded[i].next, restored.data (), restored.size ());
+  }
+
+  CHECK (restored[0].next.refers_to (restored[2]));
+  CHECK (restored[2].next.refers_to (restored[1]));
+  CHECK (restored[1].next->next->value == 2);
+  CHECK (! restored[3].next.has_value ());
+
+  // Range overloads.
+  std::vector<gch::optional_ref<node>> refs {
+    gch::optional_ref<node> { graph[3] }, gch::nullopt, gch::optional_ref<node> { graph[0] } };
+  std::vector<gch::swizzled_ref<node>> encoded (refs.size ());
+  gch::swizzle (refs.begin (), refs.end (), graph.data (), encoded.begin ());
+  CHECK (encoded[0].index () == 3);
+  CHECK (! encoded[1].has_value ());
+
+  std::vector<gch::optional_ref<node>> decoded (encoded.size ());
+  CHECK (gch::unswizzle (encoded.begin (), encoded.end (), restored.data (), restored.size (),
+                         decoded.begin ()) == encoded.end ());
+  CHECK (decoded[0].refers_to (restored[3]));
+  CHECK (! decoded[1].has_value ());
+  CHECK (decoded[2].refers_to (restored[0]));
+
+  // Indices past the end of the array are rejected.
+  CHECK (encoded[0].in_range (4));
+  CHECK (! encoded[0].in_range (3));
+  CHECK (encoded[1].in_range (0));
+  CHECK (! gch::unswizzle (encoded[0], restored.data (), 3).has_value ());
+  CHECK (gch::unswizzle (encoded.begin (), encoded.end (), restored.data (), 3,
+                         decoded.begin ()) == encoded.begin ());
+
+  // Registered types are written and restored in one pass.
+  std::vector<node_image> objects_image (graph.size ());
+  CHECK (gch::swizzle_objects (graph.data (), graph.data () + graph.size (),
+                               objects_image.data ()) == objects_image.data () + graph.size ());
+  CHECK (objects_image[0].value == 0);
+  CHECK (objects_image[2].next.index () == 1);
+
+  std::vector<node> objects (objects_image.size ());
+  const node_image *objects_last = objects_image.data () + objects_image.size ();
+  CHECK (gch::unswizzle_objects (objects_image.data (), objects_last, objects.data ())
+         == objects_last);
+  CHECK (objects[0].next.refers_to (objects[2]));
+  CHECK (objects[1].next->next->next->value == 1);
+  CHECK (objects[2].value == 2);
+  CHECK (! objects[3].next.has_value ());
+
+  // A truncated image is detected.
+  CHECK (gch::unswizzle_objects (objects_image.data (), objects_image.data () + 2,
+                                 objects.data ()) == objects_image.data ());
+
+  return 0;
+}
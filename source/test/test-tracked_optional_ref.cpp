@@ -0,0 +1,130 @@
+/** test-tracked_optional_ref.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/optional_ref/tracked_optional_ref.hpp"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+struct widget
+  : gch::ref_trackable
+{
+  explicit
+  widget (int v) noexcept
+    : value (v)
+  { }
+
+  int value;
+};
+
+// Resets the refs before the members are destroyed.
+struct eager_widget
+  : gch::ref_trackable
+{
+  ~eager_widget (void)
+  {
+    reset_tracking_refs ();
+  }
+};
+
+int
+main (void)
+{
+  gch::tracked_optional_ref<widget> a;
+  gch::tracked_optional_ref<widget> b;
+  gch::tracked_optional_ref<const widget> c;
+  CHECK (! a.has_value () && ! a);
+  CHECK (a.get_pointer () == nullptr);
+
+  {
+    widget w { 7 };
+    a.emplace (w);
+    b = a;
+    c = gch::tracked_optional_ref<const widget> { w };
+    gch::tracked_optional_ref<widget> d { w };
+
+    CHECK (a.refers_to (w) && b.refers_to (w) && c.refers_to (w) && d.refers_to (w));
+    CHECK (a->value == 7 && (*b).value == 7 && c.value ().value == 7);
+
+    // Moving leaves the source empty and keeps the target linked.
+    gch::tracked_optional_ref<widget> e { std::move (d) };
+    CHECK (! d.has_value () && e.refers_to (w));
+
+    gch::optional_ref<const widget> plain = b;
+    CHECK (plain.refers_to (w));
+
+    // A ref destroyed before its referent unlinks itself.
+    {
+      gch::tracked_optional_ref<widget> temp { a };
+      CHECK (temp.refers_to (w));
+    }
+
+    // Copies and moves of the referent do not affect its refs.
+    widget copy = w;
+    CHECK (a.refers_to (w));
+    copy = w;
+    CHECK (a.refers_to (w));
+
+    b.reset ();
+    CHECK (! b.has_value ());
+  }
+
+  CHECK (! a.has_value () && ! b.has_value () && ! c.has_value ());
+
+  // Many refs, destroyed in various orders, including by vector reallocation.
+  {
+    std::unique_ptr<widget> w (new widget { 1 });
+    std::vector<gch::tracked_optional_ref<widget>> refs;
+    for (int i = 0; i < 100; ++i)
+      refs.emplace_back (*w);
+    refs.erase (refs.begin () + 10, refs.begin () + 20);
+    refs.pop_back ();
+
+    gch::tracked_optional_ref<widget> last { refs.back () };
+    last = refs.front ();
+    gch::tracked_optional_ref<widget>& self = last;
+    last = self;
+
+    bool all = true;
+    for (const auto& r : refs)
+      all = all && r.refers_to (*w);
+    CHECK (all);
+
+    w.reset ();
+    bool none = ! last.has_value ();
+    for (const auto& r : refs)
+      none = none && ! r.has_value ();
+    CHECK (none);
+  }
+
+  {
+    gch::tracked_optional_ref<eager_widget> r;
+    {
+      eager_widget w;
+      r.emplace (w);
+    }
+    CHECK (! r.has_value ());
+  }
+
+  // Reassigning to another referent moves the ref between lists.
+  {
+    widget x { 1 };
+    gch::tracked_optional_ref<widget> r;
+    {
+      widget y { 2 };
+      r.emplace (y);
+      r.emplace (x);
+    }
+    CHECK (r.refers_to (x));
+    r = gch::nullopt;
+    CHECK (! r.has_value ());
+  }
+
+  return 0;
+}